@@ -0,0 +1,124 @@
+// Per-note cost of parsing and writing meta.txt.
+//
+//   NoteMetaBench [notes]
+//
+// Times NoteMeta::parse/format against the previous implementation
+// (istringstream + getline into an unordered_map, stoll/stoi in try/catch;
+// ostringstream for writing), reproduced below, over `notes` distinct files.
+
+#include "model/NoteMeta.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+NoteSummary oldParse(const std::string& meta) {
+  std::unordered_map<std::string, std::string> m;
+  std::istringstream ss(meta);
+  std::string line;
+  while (std::getline(ss, line)) {
+    if (line.empty()) continue;
+    const auto pos = line.find('=');
+    if (pos == std::string::npos) continue;
+    m[line.substr(0, pos)] = line.substr(pos + 1);
+  }
+  auto getI64 = [&](const char* key) -> int64_t {
+    auto it = m.find(key);
+    if (it == m.end() || it->second.empty()) return 0;
+    try { return std::stoll(it->second); } catch (...) { return 0; }
+  };
+  auto getI = [&](const char* key) -> int {
+    auto it = m.find(key);
+    if (it == m.end() || it->second.empty()) return 0;
+    try { return std::stoi(it->second); } catch (...) { return 0; }
+  };
+  NoteSummary out;
+  out.scheduledAtUtcMs = getI64("scheduledAtUtcMs");
+  out.importance = getI("importance");
+  out.contentMode = static_cast<NoteContentMode>(getI("contentMode"));
+  out.autoHideEnabled = getI("autoHideEnabled") != 0;
+  out.autoHideSeconds = getI("autoHideSeconds");
+  out.firedAtUtcMs = getI64("firedAtUtcMs");
+  out.hasFired = out.firedAtUtcMs != 0;
+  out.dismissedAtUtcMs = getI64("dismissedAtUtcMs");
+  out.dismissed = out.dismissedAtUtcMs != 0;
+  out.createdAtUtcMs = getI64("createdAtUtcMs");
+  out.updatedAtUtcMs = getI64("updatedAtUtcMs");
+  return out;
+}
+
+std::string oldFormat(const NoteSummary& n) {
+  std::ostringstream ss;
+  ss << "scheduledAtUtcMs=" << n.scheduledAtUtcMs << "\n";
+  ss << "importance=" << n.importance << "\n";
+  ss << "contentMode=" << static_cast<int>(n.contentMode) << "\n";
+  ss << "autoHideEnabled=" << (n.autoHideEnabled ? 1 : 0) << "\n";
+  ss << "autoHideSeconds=" << n.autoHideSeconds << "\n";
+  ss << "firedAtUtcMs=" << (n.hasFired ? n.firedAtUtcMs : 0) << "\n";
+  ss << "dismissedAtUtcMs=" << (n.dismissed ? n.dismissedAtUtcMs : 0) << "\n";
+  ss << "createdAtUtcMs=" << n.createdAtUtcMs << "\n";
+  ss << "updatedAtUtcMs=" << n.updatedAtUtcMs << "\n";
+  return ss.str();
+}
+
+template <class Fn>
+double nsPerNote(size_t notes, Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  fn();
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / static_cast<double>(notes);
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  const size_t notes = argc > 1 ? static_cast<size_t>(std::max(1, std::atoi(argv[1]))) : 100000;
+
+  std::mt19937_64 rng(42);
+  const int64_t base = 1767225600000; // 2026-01-01
+  std::vector<NoteSummary> summaries(notes);
+  std::vector<std::string> files(notes);
+  for (size_t i = 0; i < notes; ++i) {
+    NoteSummary& n = summaries[i];
+    n.scheduledAtUtcMs = base + static_cast<int64_t>(rng() % (365ull * 86400000));
+    n.importance = static_cast<int>(rng() % 3);
+    n.autoHideEnabled = rng() % 2 != 0;
+    n.autoHideSeconds = n.autoHideEnabled ? 30 : 0;
+    n.hasFired = rng() % 2 != 0;
+    n.firedAtUtcMs = n.hasFired ? n.scheduledAtUtcMs : 0;
+    n.createdAtUtcMs = base - static_cast<int64_t>(rng() % 86400000);
+    n.updatedAtUtcMs = n.createdAtUtcMs + 1000;
+    files[i] = oldFormat(n);
+  }
+
+  volatile int64_t sink = 0;
+  NoteSummary parsed;
+  const double parseNew = nsPerNote(notes, [&] {
+    for (const auto& f : files) {
+      NoteMeta::parse(f, parsed);
+      sink = sink + parsed.scheduledAtUtcMs;
+    }
+  });
+  const double parseOld = nsPerNote(notes, [&] {
+    for (const auto& f : files) sink = sink + oldParse(f).scheduledAtUtcMs;
+  });
+  char buf[NoteMeta::kMaxSize];
+  const double formatNew = nsPerNote(notes, [&] {
+    for (const auto& n : summaries) sink = sink + static_cast<int64_t>(NoteMeta::format(n, buf));
+  });
+  const double formatOld = nsPerNote(notes, [&] {
+    for (const auto& n : summaries) sink = sink + static_cast<int64_t>(oldFormat(n).size());
+  });
+
+  std::printf("%zu notes, ns per note\n", notes);
+  std::printf("%-8s %10s %10s %8s\n", "", "previous", "NoteMeta", "speedup");
+  std::printf("%-8s %10.0f %10.0f %7.1fx\n", "parse", parseOld, parseNew, parseOld / parseNew);
+  std::printf("%-8s %10.0f %10.0f %7.1fx\n", "format", formatOld, formatNew, formatOld / formatNew);
+  return 0;
+}
@@ -0,0 +1,426 @@
+// NoteRepository latency over synthetic corpora, reported as JSON.
+//
+//   RepoBench [--notes 1k,10k,100k,1m] [--backend dir|log] [--sync perwrite|grouped|off]
+//             [--dir path] [--seed n] [--out file.json] [--keep]
+//
+// For every corpus size a fresh data folder (default: <temp>/AlertCalendarBench/<n>)
+// is filled with generated notes: titles of 1..9 words in Russian and English, RTF
+// bodies of lognormal size (median ~1.5 KB) of which ~5% embed PNG pictures drawn
+// from a shared pool, reminders within a year either way of now at working hours on
+// 15-minute slots, importance 70/20/10, and past reminders mostly fired already.
+// Then each operation is timed call by call:
+//
+//   upsert          every note while the corpus is written
+//   getById         random notes, content included
+//   listForDate     random days of the schedule range
+//   monthMeta       calendar months, cold (after invalidateMonthMeta) and cached
+//   listDue         the reminder check (limit 50)
+//   markFiredBurst  bursts of 10 due reminders fired in one Batch
+//   openSnapshot    close() + open() restoring the index snapshot (the log
+//                   backend keeps none and replays notes.log either way)
+//   openRescan      the same with index.snap deleted (full store scan)
+//
+// and reported as count, mean and p50/p90/p99/max in microseconds. Builds against
+// the portable core, so it runs on Linux as well as on Windows.
+
+#include "app/AppPaths.h"
+#include "core/Civil.h"
+#include "core/FileIo.h"
+#include "core/TimeUtils.h"
+#include "model/NoteRepository.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr int64_t kMinuteMs = 60'000;
+constexpr int64_t kDayMs = 86'400'000;
+
+struct Options {
+  std::vector<size_t> sizes{ 1000, 10000 };
+  NoteStorageKind backend = NoteStorageKind::Directory;
+  FileIo::SyncMode sync = FileIo::SyncMode::Grouped;
+  fs::path dir = fs::temp_directory_path() / "AlertCalendarBench";
+  uint64_t seed = 42;
+  std::string out; // empty: stdout
+  bool keep = false;
+};
+
+// "10k" -> 10000, "1m" -> 1000000.
+bool parseCount(std::string_view s, size_t& out) {
+  if (s.empty()) return false;
+  size_t scale = 1;
+  const char last = s.back();
+  if (last == 'k' || last == 'K') scale = 1000;
+  if (last == 'm' || last == 'M') scale = 1000000;
+  if (scale != 1) s.remove_suffix(1);
+  char* end = nullptr;
+  const std::string digits(s);
+  const unsigned long long v = std::strtoull(digits.c_str(), &end, 10);
+  if (digits.empty() || *end != '\0' || v == 0) return false;
+  out = static_cast<size_t>(v) * scale;
+  return true;
+}
+
+bool parseOptions(int argc, char** argv, Options& o) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (arg == "--keep") {
+      o.keep = true;
+      continue;
+    }
+    if (!value) return false;
+    ++i;
+    if (arg == "--notes") {
+      o.sizes.clear();
+      std::string_view list = value;
+      while (!list.empty()) {
+        const size_t comma = list.find(',');
+        size_t n = 0;
+        if (!parseCount(list.substr(0, comma), n)) return false;
+        o.sizes.push_back(n);
+        list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+      }
+      if (o.sizes.empty()) return false;
+    } else if (arg == "--backend") {
+      if (std::strcmp(value, "dir") == 0) o.backend = NoteStorageKind::Directory;
+      else if (std::strcmp(value, "log") == 0) o.backend = NoteStorageKind::Log;
+      else return false;
+    } else if (arg == "--sync") {
+      if (std::strcmp(value, "perwrite") == 0) o.sync = FileIo::SyncMode::PerWrite;
+      else if (std::strcmp(value, "grouped") == 0) o.sync = FileIo::SyncMode::Grouped;
+      else if (std::strcmp(value, "off") == 0) o.sync = FileIo::SyncMode::Off;
+      else return false;
+    } else if (arg == "--dir") {
+      o.dir = value;
+    } else if (arg == "--seed") {
+      o.seed = std::strtoull(value, nullptr, 10);
+    } else if (arg == "--out") {
+      o.out = value;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ---- corpus generator ----
+
+constexpr const wchar_t* kWords[] = {
+  L"встреча", L"позвонить", L"отчёт", L"врач", L"оплатить", L"счёт", L"проект", L"день",
+  L"рождения", L"купить", L"продукты", L"забрать", L"документы", L"созвон", L"команда",
+  L"план", L"неделя", L"квартал", L"ремонт", L"машины", L"записаться", L"билеты", L"поезд",
+  L"meeting", L"review", L"deadline", L"release", L"backup", L"server", L"invoice", L"call",
+  L"sync", L"draft", L"budget", L"report", L"demo", L"sprint", L"retro", L"standup",
+};
+constexpr size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+constexpr std::wstring_view kRtfHeader =
+  L"{\\rtf1\\ansi\\ansicpg1251\\deff0\\nouicompat{\\fonttbl{\\f0\\fnil\\fcharset204 Segoe UI;}}"
+  L"\\viewkind4\\uc1\\pard\\sa200\\sl276\\slmult1\\f0\\fs22\\lang1049 ";
+
+class CorpusGenerator {
+public:
+  CorpusGenerator(uint64_t seed, int64_t nowUtcMs) : m_rng(seed), m_now(nowUtcMs) {
+    // A small pool, so the same picture shows up in several notes as it does when
+    // a screenshot is pasted around (blobs are deduplicated by content).
+    for (int i = 0; i < 24; ++i) {
+      m_pictures.push_back(pictureGroup(2048 + static_cast<size_t>(m_rng() % (60 * 1024))));
+    }
+  }
+
+  Note next() {
+    Note n;
+    n.id = noteId();
+    n.title = title();
+    n.scheduledAtUtcMs = schedule();
+    const uint64_t imp = m_rng() % 100;
+    n.importance = imp < 70 ? 0 : imp < 90 ? 1 : 2;
+    n.contentMode = NoteContentMode::VisualRtf;
+    n.contentRtf = body();
+    n.autoHideEnabled = m_rng() % 10 < 3;
+    n.autoHideSeconds = n.autoHideEnabled ? 30 : 0;
+    if (n.scheduledAtUtcMs < m_now && m_rng() % 100 < 90) {
+      n.hasFired = true;
+      n.firedAtUtcMs = n.scheduledAtUtcMs + static_cast<int64_t>(m_rng() % 5000);
+      if (m_rng() % 2 == 0) {
+        n.dismissed = true;
+        n.dismissedAtUtcMs = n.firedAtUtcMs + static_cast<int64_t>(m_rng() % (10 * kMinuteMs));
+      }
+    }
+    return n;
+  }
+
+  int64_t firstDay() const { return m_now - 365 * kDayMs; }
+  int64_t lastDay() const { return m_now + 365 * kDayMs; }
+
+private:
+  std::wstring noteId() {
+    wchar_t buf[40];
+    const uint64_t hi = m_rng();
+    const uint64_t lo = m_rng();
+    std::swprintf(buf, 40, L"%08X-%04X-%04X-%04X-%012llX", static_cast<unsigned>(hi >> 32),
+                  static_cast<unsigned>((hi >> 16) & 0xFFFF), static_cast<unsigned>(0x4000 | (hi & 0x0FFF)),
+                  static_cast<unsigned>(0x8000 | ((lo >> 48) & 0x3FFF)),
+                  static_cast<unsigned long long>(lo & 0xFFFFFFFFFFFFull));
+    return buf;
+  }
+
+  std::wstring words(size_t count) {
+    std::wstring s;
+    for (size_t i = 0; i < count; ++i) {
+      if (i) s += L' ';
+      s += kWords[m_rng() % kWordCount];
+    }
+    return s;
+  }
+
+  // Mostly 2..5 words.
+  std::wstring title() {
+    return words(1 + static_cast<size_t>(std::min<uint64_t>(m_rng() % 4 + m_rng() % 6, 8)));
+  }
+
+  // Working hours, weekdays more often than weekends, on 15-minute slots.
+  int64_t schedule() {
+    int32_t day = static_cast<int32_t>(m_now / kDayMs) - 365 + static_cast<int32_t>(m_rng() % 731);
+    if (Civil::weekdayMonday0(day) >= 5 && m_rng() % 3 != 0) day -= 2;
+    const Civil::Date date = Civil::fromDays(day);
+    std::normal_distribution<double> hour(12.5, 3.0);
+    const int slot = std::clamp(static_cast<int>(hour(m_rng) * 4), 7 * 4, 21 * 4);
+    return TimeUtils::localMidnightToUnixMsUtc(date.year, date.month, date.day) + slot * 15 * kMinuteMs;
+  }
+
+  // RTF with Cyrillic as \uN? escapes, like RichEdit writes it.
+  std::wstring body() {
+    std::lognormal_distribution<double> size(std::log(1500.0), 1.0);
+    const size_t target = std::clamp<size_t>(static_cast<size_t>(size(m_rng)), 80, 256 * 1024);
+    std::wstring rtf(kRtfHeader);
+    const bool picture = m_rng() % 100 < 5;
+    size_t pictureAt = picture ? target / 2 : std::numeric_limits<size_t>::max();
+    wchar_t esc[16];
+    while (rtf.size() < target) {
+      if (rtf.size() >= pictureAt) {
+        rtf += m_pictures[m_rng() % m_pictures.size()];
+        pictureAt = std::numeric_limits<size_t>::max();
+      }
+      for (const wchar_t c : words(4 + m_rng() % 12)) {
+        if (c < 0x80) {
+          rtf += c;
+        } else {
+          std::swprintf(esc, 16, L"\\u%d?", static_cast<int>(c));
+          rtf += esc;
+        }
+      }
+      rtf += m_rng() % 3 == 0 ? L"\\par\r\n" : L". ";
+    }
+    rtf += L"\\par\r\n}\r\n";
+    return rtf;
+  }
+
+  std::wstring pictureGroup(size_t bytes) {
+    static constexpr wchar_t kHex[] = L"0123456789abcdef";
+    std::wstring g = L"{\\pict{\\*\\picprop}\\wmetafile8\\picw3200\\pich2400\\picwgoal1800\\pichgoal1350 \\pngblip\r\n";
+    // PNG signature, then noise (incompressible like real picture data).
+    const unsigned char sig[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    for (size_t i = 0; i < bytes; ++i) {
+      const unsigned b = i < sizeof(sig) ? sig[i] : static_cast<unsigned>(m_rng() & 0xFF);
+      g += kHex[b >> 4];
+      g += kHex[b & 15];
+      if (i % 64 == 63) g += L"\r\n";
+    }
+    g += L"}";
+    return g;
+  }
+
+  std::mt19937_64 m_rng;
+  int64_t m_now;
+  std::vector<std::wstring> m_pictures;
+};
+
+// ---- timing ----
+
+class Samples {
+public:
+  template <class Fn>
+  void time(Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    m_us.push_back(elapsed.count());
+  }
+
+  void writeJson(std::FILE* f, const char* name, bool last) {
+    std::sort(m_us.begin(), m_us.end());
+    double sum = 0;
+    for (const double v : m_us) sum += v;
+    const size_t n = m_us.size();
+    std::fprintf(f, "        \"%s\": { \"count\": %zu, \"meanUs\": %.1f, \"p50Us\": %.1f, \"p90Us\": %.1f, "
+                    "\"p99Us\": %.1f, \"maxUs\": %.1f }%s\n",
+                 name, n, n ? sum / n : 0.0, pct(0.50), pct(0.90), pct(0.99), n ? m_us.back() : 0.0, last ? "" : ",");
+  }
+
+private:
+  // Nearest rank.
+  double pct(double p) const {
+    if (m_us.empty()) return 0;
+    const size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(m_us.size())));
+    return m_us[std::clamp<size_t>(rank, 1, m_us.size()) - 1];
+  }
+
+  std::vector<double> m_us;
+};
+
+uint64_t diskBytes(const fs::path& dir) {
+  uint64_t total = 0;
+  std::error_code ec;
+  for (fs::recursive_directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+    if (it->is_regular_file(ec)) total += it->file_size(ec);
+  }
+  return total;
+}
+
+bool fail(const char* what, const std::wstring& error) {
+  std::fprintf(stderr, "%s failed: %ls\n", what, error.c_str());
+  return false;
+}
+
+bool runCorpus(const Options& o, size_t notes, std::FILE* out, bool lastCorpus) {
+  const fs::path dir = o.dir / std::to_string(notes);
+  std::error_code ec;
+  fs::remove_all(dir, ec);
+  AppPaths::setAppDataDir(dir);
+  FileIo::setSyncPolicy(o.sync, 1000);
+
+  std::wstring error;
+  if (!NoteRepository::open(o.backend, &error)) return fail("open", error);
+
+  const int64_t now = TimeUtils::unixMsNowUtc();
+  CorpusGenerator gen(o.seed + notes, now);
+  std::mt19937_64 rng(o.seed);
+  std::map<std::string, Samples> ops;
+
+  std::vector<std::wstring> ids;
+  ids.reserve(notes);
+  uint64_t contentChars = 0;
+  for (size_t i = 0; i < notes; ++i) {
+    Note n = gen.next();
+    contentChars += n.contentRtf.size();
+    ids.push_back(n.id);
+    bool ok = false;
+    ops["upsert"].time([&] { ok = NoteRepository::upsert(std::move(n), &error); });
+    if (!ok) return fail("upsert", error);
+    if (i % 10000 == 9999) std::fprintf(stderr, "%zu: %zu notes written\n", notes, i + 1);
+  }
+  FileIo::flushPending();
+
+  const size_t probes = std::min<size_t>(notes, 2000);
+  for (size_t i = 0; i < probes; ++i) {
+    const std::wstring& id = ids[rng() % ids.size()];
+    ops["getById"].time([&] { (void)NoteRepository::getById(id); });
+  }
+
+  for (size_t i = 0; i < probes; ++i) {
+    const int64_t at = gen.firstDay() + static_cast<int64_t>(rng() % (gen.lastDay() - gen.firstDay()));
+    const Civil::Date day = TimeUtils::localDate(at);
+    ops["listForDate"].time([&] { (void)NoteRepository::listForDate(day); });
+  }
+
+  const Civil::Date today = TimeUtils::localDate(now);
+  for (int round = 0; round < 10; ++round) {
+    NoteRepository::invalidateMonthMeta();
+    for (int m = -12; m <= 12; ++m) {
+      const Civil::Date month = Civil::addMonths({ today.year, today.month, 1 }, m);
+      ops["monthMetaCold"].time([&] { (void)NoteRepository::monthMeta(month.year, month.month); });
+    }
+  }
+  // The current month again, as the calendar asks after every save.
+  for (size_t i = 0; i < probes; ++i) {
+    ops["monthMetaCached"].time([&] { (void)NoteRepository::monthMeta(today.year, today.month); });
+  }
+
+  for (int i = 0; i < 500; ++i) {
+    ops["listDue"].time([&] { (void)NoteRepository::listDue(now + i * kMinuteMs, 50); });
+  }
+
+  const auto due = NoteRepository::listDue(now, std::numeric_limits<int>::max());
+  for (size_t at = 0; at + 10 <= due.size() && at < 1000; at += 10) {
+    bool ok = false;
+    ops["markFiredBurst"].time([&] {
+      NoteRepository::Batch batch;
+      for (size_t k = at; k < at + 10; ++k) batch.markFired(due[k].id, now);
+      ok = batch.commit(&error);
+    });
+    if (!ok) return fail("markFired", error);
+  }
+
+  // The first close() writes the snapshot the reopens restore.
+  const int reopens = notes >= 100000 ? 3 : 10;
+  for (int i = 0; i < reopens; ++i) {
+    NoteRepository::close();
+    bool ok = false;
+    ops["openSnapshot"].time([&] { ok = NoteRepository::open(o.backend, &error); });
+    if (!ok) return fail("open", error);
+  }
+  for (int i = 0; i < reopens; ++i) {
+    NoteRepository::close();
+    fs::remove(AppPaths::indexSnapshotPath(), ec);
+    bool ok = false;
+    ops["openRescan"].time([&] { ok = NoteRepository::open(o.backend, &error); });
+    if (!ok) return fail("open", error);
+  }
+  NoteRepository::close();
+
+  std::fprintf(out, "    {\n      \"notes\": %zu,\n      \"contentMiB\": %.1f,\n      \"diskMiB\": %.1f,\n", notes,
+               static_cast<double>(contentChars) / (1024.0 * 1024.0),
+               static_cast<double>(diskBytes(dir)) / (1024.0 * 1024.0));
+  std::fprintf(out, "      \"ops\": {\n");
+  size_t k = 0;
+  for (auto& [name, samples] : ops) {
+    samples.writeJson(out, name.c_str(), ++k == ops.size());
+  }
+  std::fprintf(out, "      }\n    }%s\n", lastCorpus ? "" : ",");
+
+  if (!o.keep) fs::remove_all(dir, ec);
+  return true;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  Options o;
+  if (!parseOptions(argc, argv, o)) {
+    std::fprintf(stderr, "usage: RepoBench [--notes 1k,10k,100k,1m] [--backend dir|log] "
+                         "[--sync perwrite|grouped|off] [--dir path] [--seed n] [--out file.json] [--keep]\n");
+    return 2;
+  }
+
+  std::FILE* out = o.out.empty() ? stdout : std::fopen(o.out.c_str(), "w");
+  if (!out) {
+    std::fprintf(stderr, "cannot write %s\n", o.out.c_str());
+    return 1;
+  }
+  const char* sync = o.sync == FileIo::SyncMode::PerWrite ? "perwrite" : o.sync == FileIo::SyncMode::Off ? "off" : "grouped";
+  std::fprintf(out, "{\n  \"backend\": \"%s\",\n  \"sync\": \"%s\",\n  \"seed\": %llu,\n  \"corpora\": [\n",
+               o.backend == NoteStorageKind::Log ? "log" : "dir", sync, static_cast<unsigned long long>(o.seed));
+  bool ok = true;
+  for (size_t i = 0; i < o.sizes.size() && ok; ++i) {
+    ok = runCorpus(o, o.sizes[i], out, i + 1 == o.sizes.size());
+  }
+  std::fprintf(out, "  ]\n}\n");
+  if (out != stdout) std::fclose(out);
+  return ok ? 0 : 1;
+}
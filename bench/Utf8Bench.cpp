@@ -0,0 +1,143 @@
+// UTF-8 <-> wchar_t transcoding throughput over a note corpus.
+//
+//   Utf8Bench [notes-dir] [iterations]
+//
+// notes-dir is a notes folder (e.g. %APPDATA%\AlertCalendar\notes); every
+// title/meta/content file under it is loaded once and converted `iterations`
+// times. Without it a synthetic corpus is used: Russian and English text plus
+// RTF with picture hex, in roughly the proportions real notes have. On Windows
+// the previous implementation (two MultiByteToWideChar/WideCharToMultiByte
+// calls and a fresh string per conversion) is timed alongside.
+
+#include "core/Utf8.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+std::vector<std::string> loadCorpus(const fs::path& dir) {
+  std::vector<std::string> files;
+  std::error_code ec;
+  for (fs::recursive_directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+    if (!it->is_regular_file()) continue;
+    const auto ext = it->path().extension();
+    if (ext != L".txt" && ext != L".rtf" && ext != L".html" && ext != L".md") continue;
+    std::ifstream f(it->path(), std::ios::binary);
+    files.emplace_back((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+  }
+  return files;
+}
+
+std::vector<std::string> syntheticCorpus() {
+  const std::string ru = "Позвонить в банк насчёт перевода, взять паспорт и договор. ";
+  const std::string en = "Meeting notes: review the quarterly budget draft. ";
+  std::vector<std::string> files;
+  for (int i = 0; i < 2000; ++i) {
+    files.push_back(ru.substr(0, ru.find(' ', 10 + i % 40))); // title.txt
+    files.push_back("scheduledAtUtcMs=1767225600000\nimportance=1\ncontentMode=0\nautoHideEnabled=0\n");
+    std::string rtf = "{\\rtf1\\ansi\\ansicpg1251{\\fonttbl{\\f0 Segoe UI;}}\\pard ";
+    for (int k = 0; k < 1 + i % 8; ++k) rtf += (k % 2 ? en : ru) + "\\par ";
+    if (i % 10 == 0) {
+      rtf += "{\\pict\\pngblip ";
+      for (int k = 0; k < 4000; ++k) rtf += "89504e470d0a1a0a";
+      rtf += "}";
+    }
+    files.push_back(rtf + "}");
+  }
+  return files;
+}
+
+template <class Fn>
+double mbPerSecond(size_t bytes, int iterations, Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) fn();
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(bytes) * iterations / (1024.0 * 1024.0) / elapsed.count();
+}
+
+#ifdef _WIN32
+std::wstring win32FromUtf8(const std::string& s) {
+  if (s.empty()) return {};
+  const int needed = MultiByteToWideChar(CP_UTF8, 0, s.data(), static_cast<int>(s.size()), nullptr, 0);
+  std::wstring out(static_cast<size_t>(needed), L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, s.data(), static_cast<int>(s.size()), out.data(), needed);
+  return out;
+}
+
+std::string win32ToUtf8(const std::wstring& ws) {
+  if (ws.empty()) return {};
+  const int needed = WideCharToMultiByte(CP_UTF8, 0, ws.data(), static_cast<int>(ws.size()), nullptr, 0, nullptr, nullptr);
+  std::string out(static_cast<size_t>(needed), '\0');
+  WideCharToMultiByte(CP_UTF8, 0, ws.data(), static_cast<int>(ws.size()), out.data(), needed, nullptr, nullptr);
+  return out;
+}
+#endif
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::vector<std::string> files = argc > 1 ? loadCorpus(argv[1]) : syntheticCorpus();
+  const int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+  if (files.empty()) {
+    std::fprintf(stderr, "no note files under %s\n", argv[1]);
+    return 1;
+  }
+
+  size_t bytes = 0;
+  size_t invalid = 0;
+  std::vector<std::wstring> wide(files.size());
+  for (size_t i = 0; i < files.size(); ++i) {
+    bytes += files[i].size();
+    invalid += Utf8::isValid(files[i]) ? 0 : 1;
+    Utf8::toWide(files[i], wide[i]);
+  }
+  std::printf("corpus: %zu files, %.1f MB, %zu not valid UTF-8, %d iterations\n", files.size(),
+              static_cast<double>(bytes) / (1024.0 * 1024.0), invalid, iterations);
+
+  volatile size_t sink = 0;
+  std::wstring wbuf;
+  std::string buf;
+  std::printf("%-34s %10.0f MB/s\n", "decode, reused buffer", mbPerSecond(bytes, iterations, [&] {
+    for (const auto& f : files) {
+      Utf8::toWide(f, wbuf);
+      sink = sink + wbuf.size();
+    }
+  }));
+  std::printf("%-34s %10.0f MB/s\n", "decode, new string per file", mbPerSecond(bytes, iterations, [&] {
+    for (const auto& f : files) {
+      std::wstring w;
+      Utf8::toWide(f, w);
+      sink = sink + w.size();
+    }
+  }));
+  std::printf("%-34s %10.0f MB/s\n", "encode, reused buffer", mbPerSecond(bytes, iterations, [&] {
+    for (const auto& w : wide) {
+      Utf8::toUtf8(w, buf);
+      sink = sink + buf.size();
+    }
+  }));
+  std::printf("%-34s %10.0f MB/s\n", "validate", mbPerSecond(bytes, iterations, [&] {
+    for (const auto& f : files) sink = sink + (Utf8::isValid(f) ? 1 : 0);
+  }));
+#ifdef _WIN32
+  std::printf("%-34s %10.0f MB/s\n", "decode, MultiByteToWideChar x2", mbPerSecond(bytes, iterations, [&] {
+    for (const auto& f : files) sink = sink + win32FromUtf8(f).size();
+  }));
+  std::printf("%-34s %10.0f MB/s\n", "encode, WideCharToMultiByte x2", mbPerSecond(bytes, iterations, [&] {
+    for (const auto& w : wide) sink = sink + win32ToUtf8(w).size();
+  }));
+#endif
+  return 0;
+}
@@ -2,34 +2,82 @@
 
 #include "app/AppInfo.h"
 
+#ifdef _WIN32
 #include <ShlObj.h>
+#else
+#include <cstdlib>
+#endif
 
 #include <filesystem>
+#include <mutex>
 #include <system_error>
 
-std::filesystem::path AppPaths::appDataDir() {
+namespace {
+struct Override {
+  std::mutex mutex;
+  std::filesystem::path dir;
+};
+
+Override& dataDirOverride() {
+  static Override o;
+  return o;
+}
+
+std::filesystem::path defaultBaseDir() {
+#ifdef _WIN32
   PWSTR roaming = nullptr;
   const HRESULT hr = SHGetKnownFolderPath(FOLDERID_RoamingAppData, KF_FLAG_CREATE, nullptr, &roaming);
-
-  std::filesystem::path base;
   if (SUCCEEDED(hr) && roaming) {
-    base = roaming;
+    std::filesystem::path base = roaming;
     CoTaskMemFree(roaming);
-  } else {
-    base = std::filesystem::current_path();
+    return base;
+  }
+#else
+  if (const char* data = std::getenv("XDG_DATA_HOME"); data && *data) {
+    return data;
+  }
+  if (const char* home = std::getenv("HOME"); home && *home) {
+    return std::filesystem::path(home) / ".local" / "share";
   }
+#endif
+  return std::filesystem::current_path();
+}
+} // namespace
 
-  base /= AppInfo::ApplicationName;
+std::filesystem::path AppPaths::appDataDir() {
+  std::filesystem::path base;
+  {
+    Override& o = dataDirOverride();
+    std::lock_guard<std::mutex> lock(o.mutex);
+    base = o.dir;
+  }
+  if (base.empty()) {
+    base = defaultBaseDir() / AppInfo::ApplicationName;
+  }
   std::filesystem::create_directories(base);
   return base;
 }
 
+void AppPaths::setAppDataDir(const std::filesystem::path& dir) {
+  Override& o = dataDirOverride();
+  std::lock_guard<std::mutex> lock(o.mutex);
+  o.dir = dir;
+}
+
 std::filesystem::path AppPaths::notesRootDir() {
   auto dir = appDataDir() / L"notes";
   std::filesystem::create_directories(dir);
   return dir;
 }
 
+std::filesystem::path AppPaths::notesLogPath() {
+  return appDataDir() / L"notes.log";
+}
+
+std::filesystem::path AppPaths::indexSnapshotPath() {
+  return appDataDir() / L"index.snap";
+}
+
 std::filesystem::path AppPaths::mediaRootDir() {
   auto dir = appDataDir() / L"media";
   std::filesystem::create_directories(dir);
@@ -5,8 +5,15 @@
 
 class AppPaths {
 public:
+  // %APPDATA%\AlertCalendar on Windows, $XDG_DATA_HOME/AlertCalendar (or
+  // ~/.local/share/AlertCalendar) elsewhere, unless overridden.
   static std::filesystem::path appDataDir();
+  // Keeps all data under dir instead (benchmarks, portable runs); empty restores
+  // the default. Call before the repository is opened.
+  static void setAppDataDir(const std::filesystem::path& dir);
   static std::filesystem::path notesRootDir();
+  static std::filesystem::path notesLogPath();
+  static std::filesystem::path indexSnapshotPath();
   static std::filesystem::path mediaRootDir();
   static std::filesystem::path noteDir(const std::wstring& noteId);
   static std::filesystem::path noteMediaDir(const std::wstring& noteId);
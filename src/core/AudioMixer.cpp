@@ -0,0 +1,57 @@
+#include "AudioMixer.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIOMIXER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+// dst[i] += src[i], saturating.
+void addSaturating(int16_t* dst, const int16_t* src, size_t n) {
+  size_t i = 0;
+#ifdef AUDIOMIXER_SSE2
+  for (; i + 8 <= n; i += 8) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epi16(a, b));
+  }
+#endif
+  for (; i < n; ++i) {
+    dst[i] = static_cast<int16_t>(std::clamp(dst[i] + src[i], -32768, 32767));
+  }
+}
+} // namespace
+
+void AudioMixer::play(std::shared_ptr<const Wav::Clip> clip) {
+  if (!clip || clip->samples.empty()) return;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_voices.size() >= kMaxVoices) {
+    m_voices.erase(m_voices.begin());
+  }
+  m_voices.push_back({ std::move(clip), 0 });
+}
+
+void AudioMixer::stopAll() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_voices.clear();
+}
+
+bool AudioMixer::active() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return !m_voices.empty();
+}
+
+void AudioMixer::render(int16_t* out, size_t frames) {
+  const size_t n = frames * Wav::kChannels;
+  std::fill(out, out + n, int16_t{ 0 });
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto& v : m_voices) {
+    const size_t take = std::min(n, v.clip->samples.size() - v.at);
+    addSaturating(out, v.clip->samples.data() + v.at, take);
+    v.at += take;
+  }
+  std::erase_if(m_voices, [](const Voice& v) { return v.at == v.clip->samples.size(); });
+}
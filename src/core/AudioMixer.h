@@ -0,0 +1,35 @@
+#pragma once
+
+#include "core/Wav.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Mixes overlapping clips (Wav format) into one stream: each play() starts a voice
+// from the beginning of its clip, render() sums the voices that are playing with
+// 16-bit saturation and drops those that finished. play() and render() may be
+// called from different threads (UI and audio output). Portable (no WinAPI).
+class AudioMixer {
+public:
+  // Beyond this the oldest voice is cut off.
+  static constexpr size_t kMaxVoices = 8;
+
+  void play(std::shared_ptr<const Wav::Clip> clip);
+  void stopAll();
+  bool active() const;
+
+  // Fills frames stereo frames of out (silence past the end of every voice).
+  void render(int16_t* out, size_t frames);
+
+private:
+  struct Voice {
+    std::shared_ptr<const Wav::Clip> clip;
+    size_t at = 0; // next sample
+  };
+
+  mutable std::mutex m_mutex;
+  std::vector<Voice> m_voices; // oldest first
+};
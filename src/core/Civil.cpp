@@ -0,0 +1,137 @@
+#include "Civil.h"
+
+#include <utility>
+
+// Compile-time tests of Civil.h: nothing here runs. Every day of 1970-2100 (the
+// span of TimeUtils::localZone()) is checked against a date stepped by hand, and
+// ISO weeks of every day of 2000-2040, in 4-year chunks that each stay within the
+// default constant-evaluation step limits of MSVC, Clang and GCC.
+namespace {
+using Civil::Date;
+
+constexpr Date nextDay(Date d) {
+  if (d.day < Civil::daysInMonth(d.year, d.month)) {
+    ++d.day;
+  } else if (d.month < 12) {
+    d.day = 1;
+    ++d.month;
+  } else {
+    d = { d.year + 1, 1, 1 };
+  }
+  return d;
+}
+
+// Day numbers, round trips and weekdays of every day of [fromYear, toYear).
+constexpr bool checkYears(int fromYear, int toYear) {
+  Date d{ fromYear, 1, 1 };
+  int32_t days = Civil::toDays(d);
+  int weekday = Civil::weekday(days);
+  while (d.year < toYear) {
+    if (Civil::toDays(d) != days || Civil::fromDays(days) != d || Civil::weekday(days) != weekday) {
+      return false;
+    }
+    d = nextDay(d);
+    ++days;
+    weekday = (weekday + 1) % 7;
+  }
+  return true;
+}
+
+// ISO weeks of consecutive days start on Monday and count up by one each Monday,
+// resetting only where the ISO year changes.
+constexpr bool checkIsoWeeks(int fromYear, int toYear) {
+  int32_t days = Civil::toDays({ fromYear, 1, 1 });
+  Civil::IsoWeek prev = Civil::isoWeek(Civil::fromDays(days));
+  for (++days; Civil::fromDays(days).year < toYear; ++days) {
+    const Civil::IsoWeek w = Civil::isoWeek(Civil::fromDays(days));
+    const bool monday = Civil::weekdayMonday0(days) == 0;
+    if (!monday && w != prev) return false;
+    if (monday && !(w.year == prev.year ? w.week == prev.week + 1
+                                        : w.year == prev.year + 1 && w.week == 1 && prev.week >= 52)) {
+      return false;
+    }
+    prev = w;
+  }
+  return true;
+}
+
+// A variable template per chunk, so each chunk is its own constant evaluation.
+constexpr int kChunkYears = 4;
+
+template <int FromYear>
+constexpr bool kYearsOk = checkYears(FromYear, FromYear + kChunkYears);
+template <int FromYear>
+constexpr bool kIsoWeeksOk = checkIsoWeeks(FromYear, FromYear + kChunkYears);
+
+template <int FromYear, int... Chunk>
+constexpr bool yearsOk(std::integer_sequence<int, Chunk...>) {
+  return (kYearsOk<FromYear + Chunk * kChunkYears> && ...);
+}
+template <int FromYear, int... Chunk>
+constexpr bool isoWeeksOk(std::integer_sequence<int, Chunk...>) {
+  return (kIsoWeeksOk<FromYear + Chunk * kChunkYears> && ...);
+}
+
+static_assert(yearsOk<1970>(std::make_integer_sequence<int, 132 / kChunkYears>{})); // through 2101
+static_assert(isoWeeksOk<2000>(std::make_integer_sequence<int, 40 / kChunkYears>{}));
+
+static_assert(Civil::toDays({ 1970, 1, 1 }) == 0);
+static_assert(Civil::weekday(0) == 4); // Thursday
+
+// Far from the epoch and across the proleptic range.
+static_assert(Civil::toDays({ 2000, 3, 1 }) == 11017);
+static_assert(Civil::toDays({ 1600, 1, 1 }) == -135140);
+static_assert(Civil::fromDays(-719468) == Date{ 0, 3, 1 });
+static_assert(Civil::fromDays(Civil::toDays({ -4713, 11, 24 })) == Date{ -4713, 11, 24 });
+static_assert(Civil::toDays({ 9999, 12, 31 }) == 2932896);
+
+// Leap years and month lengths.
+static_assert(Civil::isLeapYear(2000) && Civil::isLeapYear(2024) && !Civil::isLeapYear(1900) &&
+              !Civil::isLeapYear(2100) && !Civil::isLeapYear(2023));
+static_assert(Civil::daysInMonth(2024, 2) == 29 && Civil::daysInMonth(2023, 2) == 28 &&
+              Civil::daysInMonth(1900, 2) == 28 && Civil::daysInMonth(2000, 2) == 29);
+static_assert(Civil::daysInMonth(2023, 1) == 31 && Civil::daysInMonth(2023, 4) == 30 &&
+              Civil::daysInMonth(2023, 12) == 31);
+
+// Normalization of out-of-range month and day.
+static_assert(Civil::daysFromCivil(2024, 13, 1) == Civil::toDays({ 2025, 1, 1 }));
+static_assert(Civil::daysFromCivil(2024, 0, 1) == Civil::toDays({ 2023, 12, 1 }));
+static_assert(Civil::daysFromCivil(2024, -11, 1) == Civil::toDays({ 2023, 1, 1 }));
+static_assert(Civil::daysFromCivil(2024, -12, 1) == Civil::toDays({ 2022, 12, 1 }));
+static_assert(Civil::daysFromCivil(2024, 3, 0) == Civil::toDays({ 2024, 2, 29 }));
+static_assert(Civil::daysFromCivil(2023, 12, 32) == Civil::toDays({ 2024, 1, 1 }));
+static_assert(Civil::daysFromCivil(2024, 1, -30) == Civil::toDays({ 2023, 12, 1 }));
+
+// Weekdays and the calendar grid.
+static_assert(Civil::weekday(-1) == 3 && Civil::weekday(-7) == 4 && Civil::weekday(-8) == 3);
+static_assert(Civil::weekdayMonday0(Civil::toDays({ 2024, 1, 1 })) == 0); // Monday
+static_assert(Civil::weekdayMonday0(Civil::toDays({ 2023, 10, 1 })) == 6); // Sunday
+static_assert(Civil::firstWeekdayMonday0(2025, 2) == 5);                    // Saturday
+static_assert(Civil::firstWeekdayMonday0(2026, 10) == 3);                   // Thursday
+
+// Stepping.
+static_assert(Civil::addDays({ 2024, 2, 28 }, 1) == Date{ 2024, 2, 29 });
+static_assert(Civil::addDays({ 2024, 2, 29 }, 1) == Date{ 2024, 3, 1 });
+static_assert(Civil::addDays({ 2024, 1, 1 }, -1) == Date{ 2023, 12, 31 });
+static_assert(Civil::addDays({ 2023, 12, 31 }, 366) == Date{ 2024, 12, 31 });
+static_assert(Civil::addMonths({ 2024, 1, 31 }, 1) == Date{ 2024, 2, 29 });
+static_assert(Civil::addMonths({ 2023, 1, 31 }, 1) == Date{ 2023, 2, 28 });
+static_assert(Civil::addMonths({ 2024, 3, 31 }, -1) == Date{ 2024, 2, 29 });
+static_assert(Civil::addMonths({ 2024, 12, 15 }, 1) == Date{ 2025, 1, 15 });
+static_assert(Civil::addMonths({ 2024, 1, 15 }, -1) == Date{ 2023, 12, 15 });
+static_assert(Civil::addMonths({ 2024, 5, 31 }, -17) == Date{ 2022, 12, 31 });
+static_assert(Civil::addMonths({ 2024, 5, 10 }, 24) == Date{ 2026, 5, 10 });
+
+// ISO weeks, including years with week 53 and dates that belong to the
+// neighbouring ISO year.
+static_assert(Civil::isoWeek({ 2024, 1, 1 }) == Civil::IsoWeek{ 2024, 1 });
+static_assert(Civil::isoWeek({ 2024, 12, 30 }) == Civil::IsoWeek{ 2025, 1 });
+static_assert(Civil::isoWeek({ 2021, 1, 3 }) == Civil::IsoWeek{ 2020, 53 });
+static_assert(Civil::isoWeek({ 2020, 12, 31 }) == Civil::IsoWeek{ 2020, 53 });
+static_assert(Civil::isoWeek({ 2023, 1, 1 }) == Civil::IsoWeek{ 2022, 52 });
+static_assert(Civil::isoWeek({ 2026, 1, 1 }) == Civil::IsoWeek{ 2026, 1 });
+static_assert(Civil::isoWeek({ 2026, 12, 31 }) == Civil::IsoWeek{ 2026, 53 });
+static_assert(Civil::isoWeek({ 2015, 12, 31 }) == Civil::IsoWeek{ 2015, 53 });
+static_assert(Civil::isoWeek({ 2026, 10, 17 }) == Civil::IsoWeek{ 2026, 42 });
+
+} // namespace
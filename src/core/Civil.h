@@ -0,0 +1,112 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+
+// Proleptic Gregorian calendar arithmetic, constexpr and free of Win32: dates map
+// to day numbers (days since 1970-01-01), and weekdays, week numbers and date
+// stepping are integer math on those. Civil.cpp checks it at compile time.
+namespace Civil {
+struct Date {
+  int year = 1970;
+  int month = 1; // 1..12
+  int day = 1;   // 1..daysInMonth
+
+  friend constexpr auto operator<=>(const Date&, const Date&) = default;
+};
+
+struct IsoWeek {
+  int year = 1970; // ISO week-numbering year; differs from the date's near New Year
+  int week = 1;    // 1..53
+
+  friend constexpr bool operator==(const IsoWeek&, const IsoWeek&) = default;
+};
+
+namespace detail {
+constexpr int64_t floorDiv(int64_t a, int64_t b) {
+  const int64_t q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+} // namespace detail
+
+constexpr bool isLeapYear(int year) {
+  return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+}
+
+// month 1..12.
+constexpr int daysInMonth(int year, int month) {
+  constexpr int kDays[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+  return month == 2 && isLeapYear(year) ? 29 : kDays[month - 1];
+}
+
+// Days since 1970-01-01 (H. Hinnant's algorithm, on years starting in March).
+// month and day may run past their range (month 13 or 0, day 32 or 0, negative
+// values) and are normalized: month first, then day as an offset from the 1st.
+constexpr int32_t daysFromCivil(int year, int month, int day) {
+  const int64_t m0 = month - 1;
+  const int64_t y0 = year + detail::floorDiv(m0, 12);
+  const int m = static_cast<int>(m0 - detail::floorDiv(m0, 12) * 12) + 1;
+
+  const int64_t y = m <= 2 ? y0 - 1 : y0;
+  const int64_t era = detail::floorDiv(y, 400);
+  const int64_t yoe = y - era * 400;                          // [0, 399]
+  const int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5; // [0, 365]
+  const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;  // [0, 146096]
+  return static_cast<int32_t>(era * 146097 + doe - 719468 + (day - 1));
+}
+
+constexpr int32_t toDays(const Date& d) {
+  return daysFromCivil(d.year, d.month, d.day);
+}
+
+constexpr Date fromDays(int32_t days) {
+  const int64_t z = static_cast<int64_t>(days) + 719468;
+  const int64_t era = detail::floorDiv(z, 146097);
+  const int doe = static_cast<int>(z - era * 146097);
+  const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const int mp = (5 * doy + 2) / 153;
+  Date d;
+  d.day = doy - (153 * mp + 2) / 5 + 1;
+  d.month = mp < 10 ? mp + 3 : mp - 9;
+  d.year = static_cast<int>(yoe + era * 400) + (d.month <= 2 ? 1 : 0);
+  return d;
+}
+
+// 0 = Sunday .. 6 = Saturday, like SYSTEMTIME::wDayOfWeek.
+constexpr int weekday(int32_t days) {
+  const int r = static_cast<int>((static_cast<int64_t>(days) + 4) % 7); // 1970-01-01 was a Thursday
+  return r < 0 ? r + 7 : r;
+}
+
+// 0 = Monday .. 6 = Sunday, as calendar grids are laid out.
+constexpr int weekdayMonday0(int32_t days) {
+  return (weekday(days) + 6) % 7;
+}
+
+constexpr int firstWeekdayMonday0(int year, int month) {
+  return weekdayMonday0(daysFromCivil(year, month, 1));
+}
+
+constexpr Date addDays(const Date& d, int n) {
+  return fromDays(toDays(d) + n);
+}
+
+// Same day n months later (or earlier), clamped to the end of a shorter month.
+constexpr Date addMonths(const Date& d, int n) {
+  const int64_t m0 = static_cast<int64_t>(d.month) - 1 + n;
+  Date r;
+  r.year = static_cast<int>(d.year + detail::floorDiv(m0, 12));
+  r.month = static_cast<int>(m0 - detail::floorDiv(m0, 12) * 12) + 1;
+  r.day = d.day < 1 ? 1 : (d.day > daysInMonth(r.year, r.month) ? daysInMonth(r.year, r.month) : d.day);
+  return r;
+}
+
+// ISO 8601 week: weeks start on Monday, week 1 holds the year's first Thursday.
+constexpr IsoWeek isoWeek(const Date& d) {
+  const int32_t days = toDays(d);
+  const int32_t thursday = days - weekdayMonday0(days) + 3; // same ISO week
+  const int year = fromDays(thursday).year;
+  return { year, (thursday - daysFromCivil(year, 1, 1)) / 7 + 1 };
+}
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Crc32 {
+// CRC-32 (IEEE 802.3, reflected 0xEDB88320). Chain calls by passing the previous result.
+uint32_t update(uint32_t crc, const void* data, size_t size);
+
+inline uint32_t compute(const void* data, size_t size) {
+  return update(0, data, size);
+}
+}
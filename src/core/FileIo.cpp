@@ -0,0 +1,430 @@
+#include "FileIo.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+struct SyncState {
+  std::mutex mutex;
+  std::condition_variable cv;
+  FileIo::SyncMode mode = FileIo::SyncMode::PerWrite;
+  int groupMs = 1000;
+  std::set<fs::path> pending;
+  std::thread flusher;
+  bool stop = false;
+};
+
+SyncState& syncState() {
+  static SyncState s;
+  return s;
+}
+
+thread_local int t_deferDepth = 0;
+
+// Replaces and deletes held back by the DeferredSync scopes of this thread, in order.
+struct Staged {
+  fs::path tmp; // empty: delete target
+  fs::path target;
+};
+thread_local std::vector<Staged> t_staged;
+
+#ifdef _WIN32
+// A reader holding the target open without FILE_SHARE_DELETE (std::ifstream) makes
+// the replace fail until it closes the file; such reads are short, so retry a few times.
+constexpr int kReplaceRetries = 5;
+constexpr DWORD kReplaceRetryMs = 10; // doubled per attempt: at most ~300 ms in total
+#endif
+
+bool flushFile(const fs::path& p) {
+  // Dirty pages are cached per file, so flushing through a fresh handle covers
+  // writes made through other handles (e.g. the log's fstream).
+#ifdef _WIN32
+  HANDLE h = CreateFileW(p.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (h == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  const BOOL ok = FlushFileBuffers(h);
+  CloseHandle(h);
+  return ok != FALSE;
+#else
+  const int fd = ::open(p.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  const bool ok = fsync(fd) == 0;
+  ::close(fd);
+  return ok;
+#endif
+}
+
+void flushAll(std::set<fs::path>& paths) {
+  for (const auto& p : paths) {
+    flushFile(p);
+  }
+  paths.clear();
+}
+
+void flusherLoop() {
+  SyncState& s = syncState();
+  std::unique_lock<std::mutex> lock(s.mutex);
+  while (true) {
+    s.cv.wait(lock, [&]() { return s.stop || !s.pending.empty(); });
+    if (!s.stop) {
+      // Let writes accumulate for one group interval.
+      s.cv.wait_for(lock, std::chrono::milliseconds(s.groupMs), [&]() { return s.stop; });
+    }
+    std::set<fs::path> batch;
+    batch.swap(s.pending);
+    const bool stop = s.stop;
+    lock.unlock();
+    flushAll(batch);
+    if (stop) {
+      return;
+    }
+    lock.lock();
+  }
+}
+
+void queueBarrier(SyncState& s, const fs::path& p) {
+  s.pending.insert(p);
+  if (s.mode == FileIo::SyncMode::Grouped) {
+    if (!s.flusher.joinable()) {
+      s.stop = false;
+      s.flusher = std::thread(flusherLoop);
+    }
+    s.cv.notify_one();
+  }
+}
+
+// Queues a barrier for path. Returns false if the caller must flush it itself.
+bool deferBarrier(const fs::path& p) {
+  SyncState& s = syncState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  if (s.mode == FileIo::SyncMode::Off) {
+    return true;
+  }
+  if (s.mode == FileIo::SyncMode::PerWrite && t_deferDepth == 0) {
+    return false;
+  }
+  queueBarrier(s, p);
+  return true;
+}
+
+// Makes renames into dir durable: now (PerWrite) or with the next group flush
+// (Grouped). On Windows PerWrite renames are written through instead, and there is
+// no directory flush to defer.
+void syncDirectory(const fs::path& dir, FileIo::SyncMode mode) {
+#ifdef _WIN32
+  (void)dir;
+  (void)mode;
+#else
+  if (mode == FileIo::SyncMode::PerWrite) {
+    flushFile(dir);
+  } else if (mode == FileIo::SyncMode::Grouped) {
+    SyncState& s = syncState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    queueBarrier(s, dir);
+  }
+#endif
+}
+
+std::wstring errorText(const wchar_t* what, const fs::path& p, unsigned long code) {
+  return std::wstring(what) + p.wstring() + L" (код " + std::to_wstring(code) + L")";
+}
+
+void discardTemp(const fs::path& tmp) {
+#ifdef _WIN32
+  DeleteFileW(tmp.c_str());
+#else
+  ::unlink(tmp.c_str());
+#endif
+}
+
+fs::path tempPath(const fs::path& path) {
+  fs::path tmp = path;
+  tmp += L".tmp";
+  return tmp;
+}
+
+Staged* findStaged(const fs::path& target) {
+  for (auto& st : t_staged) {
+    if (st.target == target) return &st;
+  }
+  return nullptr;
+}
+
+// Writes data to tmp (created or truncated), flushed if asked. Removes tmp on failure.
+bool writeTemp(const fs::path& tmp, std::string_view data, bool flush, std::wstring* errorOut) {
+#ifdef _WIN32
+  HANDLE h = CreateFileW(tmp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (h == INVALID_HANDLE_VALUE) {
+    if (errorOut) {
+      *errorOut = errorText(L"Не удалось открыть файл для записи: ", tmp, GetLastError());
+    }
+    return false;
+  }
+
+  bool ok = true;
+  DWORD err = 0;
+  size_t off = 0;
+  while (ok && off < data.size()) {
+    const DWORD chunk = static_cast<DWORD>(std::min<size_t>(data.size() - off, 1u << 30));
+    DWORD written = 0;
+    ok = WriteFile(h, data.data() + off, chunk, &written, nullptr) != FALSE && written == chunk;
+    off += written;
+  }
+  if (!ok) err = GetLastError();
+  if (ok && flush) {
+    ok = FlushFileBuffers(h) != FALSE;
+    if (!ok) err = GetLastError();
+  }
+  CloseHandle(h);
+#else
+  const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    if (errorOut) {
+      *errorOut = errorText(L"Не удалось открыть файл для записи: ", tmp, static_cast<unsigned long>(errno));
+    }
+    return false;
+  }
+
+  bool ok = true;
+  int err = 0;
+  size_t off = 0;
+  while (ok && off < data.size()) {
+    const ssize_t written = ::write(fd, data.data() + off, data.size() - off);
+    if (written < 0 && errno == EINTR) continue;
+    ok = written > 0;
+    if (ok) off += static_cast<size_t>(written);
+  }
+  if (!ok) err = errno;
+  if (ok && flush) {
+    ok = fsync(fd) == 0;
+    if (!ok) err = errno;
+  }
+  ::close(fd);
+#endif
+
+  if (!ok) {
+    if (errorOut) {
+      *errorOut = errorText(L"Не удалось записать файл: ", tmp, static_cast<unsigned long>(err));
+    }
+    discardTemp(tmp);
+  }
+  return ok;
+}
+
+// Renames tmp over target. Removes tmp on failure.
+bool replaceFile(const fs::path& tmp, const fs::path& target, bool writeThrough, std::wstring* errorOut) {
+#ifdef _WIN32
+  const DWORD flags = MOVEFILE_REPLACE_EXISTING | (writeThrough ? MOVEFILE_WRITE_THROUGH : 0);
+  DWORD err = 0;
+  for (int attempt = 0;; ++attempt) {
+    if (MoveFileExW(tmp.c_str(), target.c_str(), flags) != FALSE) {
+      return true;
+    }
+    err = GetLastError();
+    if ((err != ERROR_SHARING_VIOLATION && err != ERROR_ACCESS_DENIED) || attempt == kReplaceRetries) {
+      break;
+    }
+    Sleep(kReplaceRetryMs << attempt);
+  }
+#else
+  (void)writeThrough;
+  if (std::rename(tmp.c_str(), target.c_str()) == 0) {
+    return true;
+  }
+  const int err = errno;
+#endif
+  if (errorOut) {
+    *errorOut = errorText(L"Не удалось записать файл: ", target, static_cast<unsigned long>(err));
+  }
+  discardTemp(tmp);
+  return false;
+}
+} // namespace
+
+namespace FileIo {
+void setSyncPolicy(SyncMode mode, int groupMs) {
+  SyncState& s = syncState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  s.mode = mode;
+  s.groupMs = std::clamp(groupMs, 10, 60'000);
+}
+
+SyncMode syncMode() {
+  SyncState& s = syncState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  return s.mode;
+}
+
+bool writeFileAtomic(const fs::path& path, std::string_view data, std::wstring* errorOut) {
+  const SyncMode mode = syncMode();
+  const fs::path tmp = tempPath(path);
+  const bool stage = t_deferDepth > 0 && mode != SyncMode::Off;
+  if (!writeTemp(tmp, data, !stage && mode != SyncMode::Off, errorOut)) {
+    return false;
+  }
+  if (stage) {
+    Staged* st = findStaged(path);
+    if (!st) {
+      t_staged.push_back(Staged{ tmp, path });
+    } else if (st->tmp.empty()) {
+      st->tmp = tmp; // written again after a staged delete
+    }
+    return true;
+  }
+
+  if (!replaceFile(tmp, path, mode == SyncMode::PerWrite, errorOut)) {
+    return false;
+  }
+  syncDirectory(path.parent_path(), mode);
+  return true;
+}
+
+bool writeFileDurable(const fs::path& path, std::string_view data, std::wstring* errorOut) {
+  const SyncMode mode = syncMode();
+  const SyncMode now = mode == SyncMode::Off ? SyncMode::Off : SyncMode::PerWrite;
+  const fs::path tmp = tempPath(path);
+  if (!writeTemp(tmp, data, now != SyncMode::Off, errorOut) ||
+      !replaceFile(tmp, path, now != SyncMode::Off, errorOut)) {
+    return false;
+  }
+  syncDirectory(path.parent_path(), now);
+  return true;
+}
+
+void removeFile(const fs::path& path) {
+  if (t_deferDepth > 0 && syncMode() != SyncMode::Off) {
+    Staged* st = findStaged(path);
+    if (!st) {
+      t_staged.push_back(Staged{ {}, path });
+    } else if (!st->tmp.empty()) {
+      discardTemp(st->tmp);
+      st->tmp.clear();
+    }
+    return;
+  }
+  std::error_code ec;
+  fs::remove(path, ec);
+}
+
+fs::path currentPath(const fs::path& path) {
+  const Staged* st = t_deferDepth > 0 ? findStaged(path) : nullptr;
+  return st && !st->tmp.empty() ? st->tmp : path;
+}
+
+void commit(const fs::path& path) {
+  if (!deferBarrier(path)) {
+    flushFile(path);
+  }
+}
+
+bool syncNow(const fs::path& path) {
+  if (syncMode() == SyncMode::Off) {
+    return true;
+  }
+  return flushFile(path);
+}
+
+void flushPending() {
+  SyncState& s = syncState();
+  std::set<fs::path> batch;
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    batch.swap(s.pending);
+  }
+  flushAll(batch);
+}
+
+void shutdown() {
+  SyncState& s = syncState();
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.stop = true;
+  }
+  s.cv.notify_one();
+  if (s.flusher.joinable()) {
+    s.flusher.join();
+  }
+  flushPending();
+}
+
+DeferredSync::DeferredSync() {
+  ++t_deferDepth;
+}
+
+DeferredSync::~DeferredSync() {
+  if (--t_deferDepth == 0) {
+    // Left without commit(): the batch never replaces anything.
+    for (const auto& st : t_staged) {
+      if (!st.tmp.empty()) discardTemp(st.tmp);
+    }
+    t_staged.clear();
+    // Grouped barriers are already queued for the flusher; PerWrite ones are issued here.
+    if (syncMode() == SyncMode::PerWrite) {
+      flushPending();
+    }
+  }
+}
+
+bool DeferredSync::commit(std::wstring* errorOut) {
+  if (t_deferDepth != 1) {
+    return true;
+  }
+  std::vector<Staged> staged;
+  staged.swap(t_staged);
+  const SyncMode mode = syncMode();
+
+  // All data first, then the renames: no file is replaced by unflushed bytes.
+  bool ok = true;
+  for (const auto& st : staged) {
+    if (ok && !st.tmp.empty() && mode != SyncMode::Off && !flushFile(st.tmp)) {
+      ok = false;
+      if (errorOut) {
+        *errorOut = L"Не удалось сбросить файл на диск: " + st.target.wstring();
+      }
+    }
+  }
+  std::set<fs::path> dirs;
+  for (const auto& st : staged) {
+    if (st.tmp.empty()) continue;
+    if (ok) {
+      ok = replaceFile(st.tmp, st.target, mode == SyncMode::PerWrite, errorOut);
+      dirs.insert(st.target.parent_path());
+    } else {
+      discardTemp(st.tmp);
+    }
+  }
+  // Deletes last: a note never loses a file before its replacement is in place.
+  for (const auto& st : staged) {
+    if (ok && st.tmp.empty()) {
+      std::error_code ec;
+      fs::remove(st.target, ec);
+      dirs.insert(st.target.parent_path());
+    }
+  }
+  for (const auto& dir : dirs) {
+    syncDirectory(dir, mode);
+  }
+  return ok;
+}
+}
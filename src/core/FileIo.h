@@ -0,0 +1,68 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// Crash-safe file replacement and a process-wide durability (fsync) policy.
+namespace FileIo {
+enum class SyncMode : int {
+  PerWrite = 0, // a replaced file is durable (data and directory entry) when the call returns
+  Grouped = 1,  // data is flushed before it replaces the old version; directory entries and
+                // log barriers are flushed once per group interval (a crash may lose the
+                // last interval of changes, but never leaves a torn file)
+  Off = 2       // leave flushing to the OS (atomic replace still protects from app crashes)
+};
+
+// Call once at startup (before any note writes). groupMs applies to Grouped only.
+void setSyncPolicy(SyncMode mode, int groupMs);
+SyncMode syncMode();
+
+// Writes data to "<path>.tmp" and atomically renames it over path, so readers and a
+// crash mid-write see either the old or the new file, never a torn one. Inside a
+// DeferredSync scope the rename waits for DeferredSync::commit.
+bool writeFileAtomic(const std::filesystem::path& path, std::string_view data, std::wstring* errorOut);
+
+// Like writeFileAtomic, but never held back by a DeferredSync scope, and durable
+// (unless sync is Off) when it returns: for files that other writes refer to.
+bool writeFileDurable(const std::filesystem::path& path, std::string_view data, std::wstring* errorOut);
+
+// Deletes path (a missing file is fine). Inside a DeferredSync scope the delete
+// waits for DeferredSync::commit, so it never lands before the batch's new files.
+void removeFile(const std::filesystem::path& path);
+
+// Where the latest version of path written on this thread is now: its temp file while
+// a DeferredSync scope holds the rename back, path otherwise. The temp file keeps
+// its mtime when renamed.
+std::filesystem::path currentPath(const std::filesystem::path& path);
+
+// Durability barrier for data already written to path (e.g. appended to a log):
+// immediate (PerWrite), deferred to the next group flush (Grouped) or none (Off).
+void commit(const std::filesystem::path& path);
+
+// Flushes path right away unless sync is Off (before a file is replaced wholesale).
+bool syncNow(const std::filesystem::path& path);
+
+// Issues all deferred barriers now.
+void flushPending();
+// Flushes pending barriers and stops the group flusher thread.
+void shutdown();
+
+// Group commit. Within the scope, files written on this thread with writeFileAtomic
+// stay in their temp files and barriers are collected; commit() on the outermost
+// scope flushes all temp files in one pass, renames them over their targets, then
+// flushes the directories (one barrier per batch instead of one per file). Files
+// still staged when the outermost scope ends without commit() are discarded.
+class DeferredSync {
+public:
+  DeferredSync();
+  ~DeferredSync();
+
+  // Returns false if a flush or rename fails (after a failed flush nothing is
+  // renamed). Inner scopes leave the work to the outermost one and return true.
+  bool commit(std::wstring* errorOut);
+
+  DeferredSync(const DeferredSync&) = delete;
+  DeferredSync& operator=(const DeferredSync&) = delete;
+};
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Hash64 {
+// XXH64: fast non-cryptographic 64-bit hash, used to detect unchanged content
+// before rewriting it. Chain calls by passing the previous result as seed.
+uint64_t compute(const void* data, size_t size, uint64_t seed = 0);
+}
@@ -0,0 +1,101 @@
+#include "LocalTime.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LOCALTIME_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+int64_t floorDiv(int64_t a, int64_t b) {
+  const int64_t q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+} // namespace
+
+namespace LocalTime {
+Zone::Zone(const std::vector<Transition>& transitions) {
+  if (transitions.empty()) {
+    return;
+  }
+  m_offset[0] = transitions.front().offsetMs;
+  for (const auto& t : transitions) {
+    if (t.offsetMs == m_offset.back()) {
+      continue; // no change: the rule switched but the clock didn't
+    }
+    m_at.push_back(t.atUtcMs);
+    m_offset.push_back(t.offsetMs);
+  }
+}
+
+size_t Zone::segmentOf(int64_t utcMs) const {
+  return static_cast<size_t>(std::upper_bound(m_at.begin(), m_at.end(), utcMs) - m_at.begin()) - 1;
+}
+
+int32_t Zone::offsetAt(int64_t utcMs) const {
+  return m_offset[segmentOf(utcMs)];
+}
+
+int64_t Zone::toUtc(int64_t localMs) const {
+  // Offsets change at most once within the few hours around any instant, so only
+  // the segment the first guess lands in and its neighbours can map to localMs.
+  const size_t guess = segmentOf(localMs - m_offset[segmentOf(localMs)]);
+  const size_t first = guess == 0 ? 0 : guess - 1;
+  const size_t last = std::min(guess + 1, m_at.size() - 1);
+  for (size_t i = first; i <= last; ++i) {
+    const int64_t utc = localMs - m_offset[i];
+    if (utc >= m_at[i] && (i + 1 == m_at.size() || utc < m_at[i + 1])) {
+      return utc; // earliest match: segments are visited in time order
+    }
+  }
+  // Skipped: the clock jumps over localMs at the start of one of these segments.
+  for (size_t i = std::max<size_t>(first, 1); i <= last; ++i) {
+    if (m_at[i] + m_offset[i] > localMs) {
+      return m_at[i];
+    }
+  }
+  return localMs - m_offset[guess];
+}
+
+int32_t Zone::dayNumber(int64_t utcMs) const {
+  return static_cast<int32_t>(floorDiv(toLocal(utcMs), kDayMs));
+}
+
+void Zone::dayNumbers(const int64_t* utcMs, size_t count, int32_t* out) const {
+  size_t i = 0;
+  while (i < count) {
+    const size_t seg = segmentOf(utcMs[i]);
+    const int64_t offset = m_offset[seg];
+    const size_t end = seg + 1 == m_at.size()
+        ? count
+        : static_cast<size_t>(std::lower_bound(utcMs + i, utcMs + count, m_at[seg + 1]) - utcMs);
+
+    // Days relative to the local midnight before the first time of the run: the
+    // differences are non-negative, so truncation is floor.
+    const int32_t baseDay = dayNumber(utcMs[i]);
+    const int64_t base = baseDay * kDayMs - offset;
+#ifdef LOCALTIME_SSE2
+    // Exact as doubles below 2^52; a quotient below 2^20 days also keeps x / kDayMs
+    // from rounding up to the next integer.
+    constexpr int64_t kMaxSpan = kDayMs << 20;
+    if (end - i >= 2 && utcMs[end - 1] - base < kMaxSpan) {
+      const __m128i magicBits = _mm_set1_epi64x(0x4330000000000000LL); // 2^52
+      const __m128d magic = _mm_set1_pd(4503599627370496.0);
+      const __m128d day = _mm_set1_pd(static_cast<double>(kDayMs));
+      const __m128i baseVec = _mm_set1_epi64x(base);
+      const __m128i baseDayVec = _mm_set1_epi32(baseDay);
+      for (; i + 2 <= end; i += 2) {
+        const __m128i x = _mm_sub_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(utcMs + i)), baseVec);
+        const __m128d xd = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(x, magicBits)), magic);
+        const __m128i days = _mm_add_epi32(_mm_cvttpd_epi32(_mm_div_pd(xd, day)), baseDayVec);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), days);
+      }
+    }
+#endif
+    for (; i < end; ++i) {
+      out[i] = baseDay + static_cast<int32_t>((utcMs[i] - base) / kDayMs);
+    }
+  }
+}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LocalTime {
+// Portable UTC <-> local wall-clock conversion over a cached table of UTC offset
+// transitions: after the table is built (TimeUtils::localZone() does that once
+// from the Win32 zone rules) a conversion is a binary search plus integer
+// arithmetic, with no system calls. Local times are milliseconds since
+// 1970-01-01 00:00 local; local day numbers count days from that date, as
+// Civil::toDays() does for dates.
+
+constexpr int64_t kDayMs = 86'400'000;
+
+// From atUtcMs on, local time is UTC + offsetMs.
+struct Transition {
+  int64_t atUtcMs = 0;
+  int32_t offsetMs = 0;
+};
+
+class Zone {
+public:
+  // UTC.
+  Zone() = default;
+  // Transitions sorted by time; the first offset also applies before it and the
+  // last one indefinitely after it.
+  explicit Zone(const std::vector<Transition>& transitions);
+
+  int32_t offsetAt(int64_t utcMs) const;
+  int64_t toLocal(int64_t utcMs) const { return utcMs + offsetAt(utcMs); }
+
+  // The UTC instant of a local wall-clock time. Of a time that occurs twice (clock
+  // set back) the earlier instant; of one that is skipped (clock set forward) the
+  // transition itself, i.e. the first instant at or after it.
+  int64_t toUtc(int64_t localMs) const;
+
+  int32_t dayNumber(int64_t utcMs) const;
+  int64_t dayStartUtc(int32_t dayNumber) const { return toUtc(dayNumber * kDayMs); }
+
+  // dayNumber() of count ascending times (as NoteIndex::forRange yields them) into
+  // out: one table lookup per run of times sharing an offset, and the division by
+  // kDayMs two lanes at a time with SSE2 where available.
+  void dayNumbers(const int64_t* utcMs, size_t count, int32_t* out) const;
+
+private:
+  size_t segmentOf(int64_t utcMs) const;
+
+  // m_at[i] <= t < m_at[i + 1] has offset m_offset[i]; m_at[0] is INT64_MIN.
+  std::vector<int64_t> m_at{ INT64_MIN };
+  std::vector<int32_t> m_offset{ 0 };
+};
+}
@@ -0,0 +1,91 @@
+#include "MappedFile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::filesystem::path& path) {
+  close();
+
+  m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (m_file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER size{};
+  if (!GetFileSizeEx(m_file, &size) || size.QuadPart <= 0 ||
+      static_cast<unsigned long long>(size.QuadPart) > static_cast<size_t>(-1)) {
+    close();
+    return false;
+  }
+
+  m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!m_mapping) {
+    close();
+    return false;
+  }
+  m_view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!m_view) {
+    close();
+    return false;
+  }
+  m_size = static_cast<size_t>(size.QuadPart);
+  return true;
+}
+
+void MappedFile::close() {
+  if (m_view) {
+    UnmapViewOfFile(m_view);
+    m_view = nullptr;
+  }
+  if (m_mapping) {
+    CloseHandle(m_mapping);
+    m_mapping = nullptr;
+  }
+  if (m_file != INVALID_HANDLE_VALUE) {
+    CloseHandle(m_file);
+    m_file = INVALID_HANDLE_VALUE;
+  }
+  m_size = 0;
+}
+#else
+bool MappedFile::open(const std::filesystem::path& path) {
+  close();
+
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st {};
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    return false;
+  }
+  // The mapping keeps the file referenced; the descriptor is not needed.
+  void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (view == MAP_FAILED) {
+    return false;
+  }
+  m_view = view;
+  m_size = static_cast<size_t>(st.st_size);
+  return true;
+}
+
+void MappedFile::close() {
+  if (m_view) {
+    munmap(const_cast<void*>(m_view), m_size);
+    m_view = nullptr;
+  }
+  m_size = 0;
+}
+#endif
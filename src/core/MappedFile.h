@@ -0,0 +1,33 @@
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include <cstddef>
+#include <filesystem>
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // False if the file is missing, empty or can't be mapped.
+  bool open(const std::filesystem::path& path);
+  void close();
+
+  const char* data() const { return static_cast<const char*>(m_view); }
+  size_t size() const { return m_size; }
+
+private:
+#ifdef _WIN32
+  HANDLE m_file = INVALID_HANDLE_VALUE;
+  HANDLE m_mapping = nullptr;
+#endif
+  const void* m_view = nullptr;
+  size_t m_size = 0;
+};
@@ -0,0 +1,316 @@
+#include "PlainText.h"
+
+#include "core/RtfTokenizer.h"
+
+#include <algorithm>
+
+#include <cstdint>
+#include <string_view>
+
+namespace {
+bool isAsciiLetter(wchar_t c) {
+  return (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z');
+}
+
+bool isDigit(wchar_t c) {
+  return c >= L'0' && c <= L'9';
+}
+
+int hexValue(wchar_t c) {
+  if (c >= L'0' && c <= L'9') return c - L'0';
+  if (c >= L'a' && c <= L'f') return c - L'a' + 10;
+  if (c >= L'A' && c <= L'F') return c - L'A' + 10;
+  return -1;
+}
+
+wchar_t asciiLower(wchar_t c) {
+  return (c >= L'A' && c <= L'Z') ? static_cast<wchar_t>(c + 32) : c;
+}
+
+bool startsWithNoCase(const std::wstring& s, size_t pos, std::wstring_view prefix) {
+  if (s.size() - pos < prefix.size()) return false;
+  for (size_t k = 0; k < prefix.size(); ++k) {
+    if (asciiLower(s[pos + k]) != prefix[k]) return false;
+  }
+  return true;
+}
+
+// Windows-1251 0x80..0xBF; 0xC0..0xFF are U+0410..U+044F.
+constexpr wchar_t kCp1251High[64] = {
+  0x0402, 0x0403, 0x201A, 0x0453, 0x201E, 0x2026, 0x2020, 0x2021, 0x20AC, 0x2030, 0x0409, 0x2039, 0x040A, 0x040C, 0x040B, 0x040F,
+  0x0452, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, 0xFFFD, 0x2122, 0x0459, 0x203A, 0x045A, 0x045C, 0x045B, 0x045F,
+  0x00A0, 0x040E, 0x045E, 0x0408, 0x00A4, 0x0490, 0x00A6, 0x00A7, 0x0401, 0x00A9, 0x0404, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x0407,
+  0x00B0, 0x00B1, 0x0406, 0x0456, 0x0491, 0x00B5, 0x00B6, 0x00B7, 0x0451, 0x2116, 0x0454, 0x00BB, 0x0458, 0x0405, 0x0455, 0x0457,
+};
+
+wchar_t decodeAnsi(unsigned byte, int codepage) {
+  if (byte < 0x80) return static_cast<wchar_t>(byte);
+  if (codepage == 1251) {
+    return byte >= 0xC0 ? static_cast<wchar_t>(0x0410 + (byte - 0xC0)) : kCp1251High[byte - 0x80];
+  }
+  return static_cast<wchar_t>(byte); // 1252 and anything else: Latin-1 is close enough for text
+}
+
+// Groups whose text is not part of the document body.
+bool isSkippedDestination(std::wstring_view word) {
+  static constexpr std::wstring_view kWords[] = {
+    L"fonttbl", L"colortbl", L"stylesheet", L"info", L"pict", L"object", L"themedata",
+    L"colorschememapping", L"latentstyles", L"datastore", L"listtable", L"listoverridetable",
+    L"rsidtbl", L"generator", L"xmlnstbl", L"fldinst", L"nonshppict", L"pntext",
+    L"header", L"headerl", L"headerr", L"headerf", L"footer", L"footerl", L"footerr", L"footerf",
+  };
+  for (auto w : kWords) {
+    if (word == w) return true;
+  }
+  return false;
+}
+
+wchar_t specialChar(std::wstring_view word) {
+  if (word == L"emdash") return 0x2014;
+  if (word == L"endash") return 0x2013;
+  if (word == L"bullet") return 0x2022;
+  if (word == L"lquote") return 0x2018;
+  if (word == L"rquote") return 0x2019;
+  if (word == L"ldblquote") return 0x201C;
+  if (word == L"rdblquote") return 0x201D;
+  return 0;
+}
+} // namespace
+
+namespace PlainText {
+
+void appendRtf(std::wstring_view rtf, std::wstring& out) {
+  struct Group {
+    bool skip = false;
+    int uc = 1; // fallback characters after \uN
+  };
+  // Fixed stack: deeper nesting (never produced by RichEdit) shares the innermost state.
+  constexpr int kMaxDepth = 64;
+  Group stack[kMaxDepth];
+  int depth = 0;
+  int overflow = 0;
+  Group cur;
+  int codepage = 1252;
+  int fallback = 0; // \uN fallback characters still to drop
+  bool groupStart = false;
+
+  auto emit = [&](wchar_t c) {
+    if (fallback > 0) {
+      --fallback;
+    } else if (!cur.skip) {
+      out.push_back(c);
+    }
+  };
+  auto breakLine = [&]() {
+    fallback = 0;
+    if (!cur.skip && !out.empty() && out.back() != L'\n') out.push_back(L'\n');
+  };
+  auto popGroup = [&]() {
+    if (overflow > 0) {
+      --overflow;
+    } else if (depth > 0) {
+      cur = stack[--depth];
+    }
+  };
+
+  RtfTokenizer tok(rtf);
+  for (;;) {
+    const RtfTokenizer::Token t = tok.next();
+    const bool first = groupStart;
+    groupStart = false;
+    switch (t.kind) {
+      case RtfTokenizer::TokenKind::End:
+        return;
+      case RtfTokenizer::TokenKind::GroupStart:
+        if (depth < kMaxDepth) {
+          stack[depth++] = cur;
+        } else {
+          ++overflow;
+        }
+        fallback = 0;
+        groupStart = true;
+        break;
+      case RtfTokenizer::TokenKind::GroupEnd:
+        popGroup();
+        fallback = 0;
+        break;
+      case RtfTokenizer::TokenKind::Text:
+        if (cur.skip) break;
+        if (fallback > 0) {
+          const size_t drop = std::min(static_cast<size_t>(fallback), t.text.size());
+          fallback -= static_cast<int>(drop);
+          out.append(t.text.substr(drop));
+        } else {
+          out.append(t.text);
+        }
+        break;
+      case RtfTokenizer::TokenKind::HexChar:
+        emit(decodeAnsi(static_cast<unsigned>(t.param), codepage));
+        break;
+      case RtfTokenizer::TokenKind::Binary:
+        break;
+      case RtfTokenizer::TokenKind::ControlSymbol:
+        switch (t.text[0]) {
+          case L'\\':
+          case L'{':
+          case L'}':
+            emit(t.text[0]);
+            break;
+          case L'~':
+            emit(L' ');
+            break;
+          case L'_':
+            emit(L'-');
+            break;
+          case L'*':
+            if (first) {
+              tok.skipGroup(); // ignorable destination: {\* ...}
+              popGroup();
+            } else {
+              cur.skip = true;
+            }
+            break;
+          case L'\r':
+          case L'\n':
+            breakLine();
+            break;
+          default:
+            break; // \- (optional hyphen), \| etc.
+        }
+        break;
+      case RtfTokenizer::TokenKind::ControlWord: {
+        const std::wstring_view word = t.text;
+        if (word == L"par" || word == L"line" || word == L"row" || word == L"sect" || word == L"page") {
+          breakLine();
+        } else if (word == L"tab" || word == L"cell") {
+          emit(L' ');
+        } else if (word == L"u" && t.hasParam) {
+          fallback = 0;
+          emit(static_cast<wchar_t>(t.param < 0 ? t.param + 65536 : t.param));
+          fallback = cur.uc;
+        } else if (word == L"uc" && t.hasParam) {
+          cur.uc = std::max(0, t.param);
+        } else if (word == L"ansicpg" && t.hasParam) {
+          codepage = t.param;
+        } else if (isSkippedDestination(word)) {
+          if (first) {
+            tok.skipGroup(); // pictures end up here: one vector scan over the payload
+            popGroup();
+          } else {
+            cur.skip = true;
+          }
+        } else if (const wchar_t special = specialChar(word)) {
+          emit(special);
+        }
+        break;
+      }
+    }
+  }
+}
+
+std::wstring fromRtf(const std::wstring& rtf) {
+  std::wstring out;
+  out.reserve(rtf.size() / 4);
+  appendRtf(rtf, out);
+  return out;
+}
+
+std::wstring fromHtml(const std::wstring& html) {
+  std::wstring out;
+  out.reserve(html.size());
+  const size_t n = html.size();
+  for (size_t i = 0; i < n; ++i) {
+    const wchar_t c = html[i];
+    if (c == L'<') {
+      if (html.compare(i, 4, L"<!--") == 0) {
+        const size_t end = html.find(L"-->", i + 4);
+        if (end == std::wstring::npos) break;
+        i = end + 2;
+        continue;
+      }
+      const size_t close = html.find(L'>', i + 1);
+      if (close == std::wstring::npos) break;
+      for (std::wstring_view raw : { std::wstring_view(L"script"), std::wstring_view(L"style") }) {
+        if (startsWithNoCase(html, i + 1, raw) && i + 1 + raw.size() < n &&
+            !isAsciiLetter(html[i + 1 + raw.size()])) {
+          std::wstring endTag = L"</";
+          endTag += raw;
+          size_t end = close;
+          while ((end = html.find(L"</", end)) != std::wstring::npos && !startsWithNoCase(html, end, endTag)) {
+            end += 2;
+          }
+          if (end == std::wstring::npos) return out;
+          const size_t endClose = html.find(L'>', end);
+          if (endClose == std::wstring::npos) return out;
+          i = endClose;
+          break;
+        }
+      }
+      if (i < close) i = close;
+      out.push_back(L' ');
+    } else if (c == L'&') {
+      const size_t semi = html.find(L';', i + 1);
+      if (semi == std::wstring::npos || semi - i > 10) {
+        out.push_back(c);
+        continue;
+      }
+      const std::wstring_view name(html.data() + i + 1, semi - i - 1);
+      wchar_t decoded = 0;
+      if (name == L"amp") decoded = L'&';
+      else if (name == L"lt") decoded = L'<';
+      else if (name == L"gt") decoded = L'>';
+      else if (name == L"quot") decoded = L'"';
+      else if (name == L"apos") decoded = L'\'';
+      else if (name == L"nbsp") decoded = L' ';
+      else if (name.size() > 1 && name[0] == L'#') {
+        uint32_t cp = 0;
+        const bool hex = name[1] == L'x' || name[1] == L'X';
+        bool valid = name.size() > (hex ? 2u : 1u);
+        for (size_t k = hex ? 2 : 1; valid && k < name.size(); ++k) {
+          const int v = hex ? hexValue(name[k]) : (isDigit(name[k]) ? name[k] - L'0' : -1);
+          valid = v >= 0 && cp <= 0x10FFFF;
+          cp = cp * (hex ? 16 : 10) + static_cast<uint32_t>(v);
+        }
+        if (valid && cp > 0 && cp <= 0x10FFFF) {
+          if (cp >= 0x10000) {
+            cp -= 0x10000;
+            out.push_back(static_cast<wchar_t>(0xD800 + (cp >> 10)));
+            decoded = static_cast<wchar_t>(0xDC00 + (cp & 0x3FF));
+          } else {
+            decoded = static_cast<wchar_t>(cp);
+          }
+        }
+      }
+      if (decoded) {
+        out.push_back(decoded);
+        i = semi;
+      } else {
+        out.push_back(c);
+      }
+    } else {
+      out.push_back(c);
+    }
+  }
+  return out;
+}
+
+std::wstring fromMarkdown(const std::wstring& markdown) {
+  std::wstring out;
+  out.reserve(markdown.size());
+  const size_t n = markdown.size();
+  for (size_t i = 0; i < n; ++i) {
+    const wchar_t c = markdown[i];
+    if (c == L']' && i + 1 < n && markdown[i + 1] == L'(') {
+      const size_t close = markdown.find(L')', i + 2);
+      if (close != std::wstring::npos) {
+        out.push_back(L' ');
+        i = close;
+        continue;
+      }
+    }
+    out.push_back(c);
+  }
+  return out;
+}
+
+} // namespace PlainText
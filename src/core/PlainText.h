@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace PlainText {
+// Readable text of stored note content, for indexing and snippets (not for display:
+// formatting is dropped and paragraph/cell breaks become single spaces or newlines).
+
+// Skips font/color/style tables, pictures and other destinations; decodes \'hh
+// (in the document's \ansicpg, 1251 or 1252) and \uN escapes.
+std::wstring fromRtf(const std::wstring& rtf);
+// Same, appending to out: allocation-free once out has the capacity (reuse it
+// across calls).
+void appendRtf(std::wstring_view rtf, std::wstring& out);
+// Drops tags, comments and <script>/<style> bodies; decodes common entities.
+std::wstring fromHtml(const std::wstring& html);
+// Drops link/image targets; other markup is punctuation a tokenizer ignores anyway.
+std::wstring fromMarkdown(const std::wstring& markdown);
+}
@@ -0,0 +1,197 @@
+#include "RtfTokenizer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RTF_TOKENIZER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+constexpr size_t kMaxWordLength = 32; // longer letter runs end the word (spec limit)
+
+bool isAsciiLetter(wchar_t c) {
+  return (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z');
+}
+
+bool isSpecial(wchar_t c, bool newlines) {
+  return c == L'{' || c == L'}' || c == L'\\' || (newlines && (c == L'\r' || c == L'\n'));
+}
+
+int hexValue(wchar_t c) {
+  if (c >= L'0' && c <= L'9') return c - L'0';
+  if (c >= L'a' && c <= L'f') return c - L'a' + 10;
+  if (c >= L'A' && c <= L'F') return c - L'A' + 10;
+  return -1;
+}
+
+#ifdef RTF_TOKENIZER_SSE2
+// Lane-wise equality for wchar_t (2 bytes on Windows, 4 elsewhere).
+__m128i equalLanes(__m128i v, wchar_t c) {
+  if constexpr (sizeof(wchar_t) == 2) {
+    return _mm_cmpeq_epi16(v, _mm_set1_epi16(static_cast<short>(c)));
+  } else {
+    return _mm_cmpeq_epi32(v, _mm_set1_epi32(static_cast<int>(c)));
+  }
+}
+#endif
+
+// First structural character ('{', '}', '\', plus CR/LF if newlines) in [p, end).
+const wchar_t* findSpecial(const wchar_t* p, const wchar_t* end, bool newlines) {
+#ifdef RTF_TOKENIZER_SSE2
+  constexpr size_t kLanes = 16 / sizeof(wchar_t);
+  auto hits = [newlines](const wchar_t* at) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(at));
+    __m128i hit = _mm_or_si128(_mm_or_si128(equalLanes(v, L'{'), equalLanes(v, L'}')), equalLanes(v, L'\\'));
+    if (newlines) {
+      hit = _mm_or_si128(hit, _mm_or_si128(equalLanes(v, L'\r'), equalLanes(v, L'\n')));
+    }
+    return hit;
+  };
+  // 64 bytes per iteration while nothing matches (picture payloads), then narrow down.
+  while (static_cast<size_t>(end - p) >= 4 * kLanes) {
+    const __m128i any = _mm_or_si128(_mm_or_si128(hits(p), hits(p + kLanes)),
+                                     _mm_or_si128(hits(p + 2 * kLanes), hits(p + 3 * kLanes)));
+    if (_mm_movemask_epi8(any) != 0) break;
+    p += 4 * kLanes;
+  }
+  while (static_cast<size_t>(end - p) >= kLanes) {
+    const auto mask = static_cast<unsigned>(_mm_movemask_epi8(hits(p)));
+    if (mask != 0) {
+      return p + std::countr_zero(mask) / sizeof(wchar_t);
+    }
+    p += kLanes;
+  }
+#endif
+  while (p < end && !isSpecial(*p, newlines)) ++p;
+  return p;
+}
+
+// "bin" at p, not followed by another letter.
+bool startsBinWord(const wchar_t* p, const wchar_t* end) {
+  return end - p >= 3 && p[0] == L'b' && p[1] == L'i' && p[2] == L'n' && (end - p == 3 || !isAsciiLetter(p[3]));
+}
+
+// Parses the optional numeric parameter of a control word at rtf[i]; returns the
+// index past it (and past a single space delimiter).
+size_t parseParam(std::wstring_view rtf, size_t i, int32_t& param, bool& hasParam) {
+  bool negative = false;
+  if (i < rtf.size() && rtf[i] == L'-' && i + 1 < rtf.size() && rtf[i + 1] >= L'0' && rtf[i + 1] <= L'9') {
+    negative = true;
+    ++i;
+  }
+  int64_t value = 0;
+  hasParam = false;
+  while (i < rtf.size() && rtf[i] >= L'0' && rtf[i] <= L'9') {
+    hasParam = true;
+    if (value <= INT32_MAX) value = value * 10 + (rtf[i] - L'0');
+    ++i;
+  }
+  if (value > INT32_MAX) value = INT32_MAX;
+  param = static_cast<int32_t>(negative ? -value : value);
+  if (i < rtf.size() && rtf[i] == L' ') ++i; // delimiter belongs to the word
+  return i;
+}
+} // namespace
+
+RtfTokenizer::Token RtfTokenizer::next() {
+  Token t;
+  const size_t n = m_rtf.size();
+
+  if (m_binPending > 0) {
+    const size_t len = m_binPending < n - m_pos ? m_binPending : n - m_pos;
+    m_binPending = 0;
+    t.kind = TokenKind::Binary;
+    t.text = m_rtf.substr(m_pos, len);
+    m_pos += len;
+    return t;
+  }
+
+  while (m_pos < n && (m_rtf[m_pos] == L'\r' || m_rtf[m_pos] == L'\n')) ++m_pos;
+  if (m_pos >= n) return t;
+
+  const wchar_t c = m_rtf[m_pos];
+  if (c == L'{') {
+    t.kind = TokenKind::GroupStart;
+    t.text = m_rtf.substr(m_pos++, 1);
+    return t;
+  }
+  if (c == L'}') {
+    t.kind = TokenKind::GroupEnd;
+    t.text = m_rtf.substr(m_pos++, 1);
+    return t;
+  }
+  if (c != L'\\') {
+    const wchar_t* begin = m_rtf.data() + m_pos;
+    const wchar_t* stop = findSpecial(begin, m_rtf.data() + n, true);
+    t.kind = TokenKind::Text;
+    t.text = std::wstring_view(begin, static_cast<size_t>(stop - begin));
+    m_pos += t.text.size();
+    return t;
+  }
+
+  // Backslash: control word, \'hh or control symbol.
+  if (m_pos + 1 >= n) {
+    ++m_pos;
+    return t; // lone trailing backslash
+  }
+  const wchar_t next = m_rtf[m_pos + 1];
+  if (isAsciiLetter(next)) {
+    size_t j = m_pos + 1;
+    while (j < n && j - m_pos - 1 < kMaxWordLength && isAsciiLetter(m_rtf[j])) ++j;
+    t.kind = TokenKind::ControlWord;
+    t.text = m_rtf.substr(m_pos + 1, j - m_pos - 1);
+    m_pos = parseParam(m_rtf, j, t.param, t.hasParam);
+    if (t.text == L"bin" && t.hasParam && t.param > 0) {
+      m_binPending = static_cast<size_t>(t.param);
+    }
+    return t;
+  }
+  if (next == L'\'') {
+    const int hi = m_pos + 2 < n ? hexValue(m_rtf[m_pos + 2]) : -1;
+    const int lo = m_pos + 3 < n ? hexValue(m_rtf[m_pos + 3]) : -1;
+    if (hi >= 0 && lo >= 0) {
+      t.kind = TokenKind::HexChar;
+      t.text = m_rtf.substr(m_pos, 4);
+      t.param = (hi << 4) | lo;
+      t.hasParam = true;
+      m_pos += 4;
+      return t;
+    }
+  }
+  t.kind = TokenKind::ControlSymbol;
+  t.text = m_rtf.substr(m_pos + 1, 1);
+  m_pos += 2;
+  return t;
+}
+
+void RtfTokenizer::skipGroup() {
+  m_binPending = 0;
+  const wchar_t* p = m_rtf.data() + m_pos;
+  const wchar_t* const end = m_rtf.data() + m_rtf.size();
+  int depth = 1;
+  while ((p = findSpecial(p, end, false)) < end) {
+    const wchar_t c = *p;
+    if (c == L'{') {
+      ++depth;
+      ++p;
+    } else if (c == L'}') {
+      ++p;
+      if (--depth == 0) break;
+    } else if (startsBinWord(p + 1, end)) {
+      // \binN: the raw data may contain braces
+      int32_t len = 0;
+      bool hasParam = false;
+      p = m_rtf.data() + parseParam(m_rtf, static_cast<size_t>(p + 4 - m_rtf.data()), len, hasParam);
+      if (hasParam && len > 0) {
+        p += std::min(static_cast<size_t>(len), static_cast<size_t>(end - p));
+      }
+    } else {
+      // escaped brace/backslash, or the first letter of a control word
+      p += std::min<ptrdiff_t>(2, end - p);
+    }
+  }
+  m_pos = static_cast<size_t>(p - m_rtf.data());
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Streaming tokenizer for RTF held in memory (as produced by RichEditUtil::getRtf
+// and stored in Note::contentRtf). Tokens are views into the input, so nothing is
+// allocated or copied; source line breaks are dropped between tokens.
+//
+// Portable: no Windows dependencies. Scanning for the next '{', '}' or '\' uses
+// SSE2 where available, which is what makes skipping picture payloads (megabytes
+// of hex) cheap.
+class RtfTokenizer {
+public:
+  enum class TokenKind {
+    End,
+    GroupStart,    // {
+    GroupEnd,      // }
+    ControlWord,   // \word or \wordN; text = word, param/hasParam
+    ControlSymbol, // \x for a non-letter x; text = x (a source line break for \<newline>)
+    HexChar,       // \'hh; param = byte value
+    Text,          // run of plain characters
+    Binary,        // payload of \binN (follows the "bin" control word)
+  };
+
+  struct Token {
+    TokenKind kind = TokenKind::End;
+    std::wstring_view text;
+    int32_t param = 0;
+    bool hasParam = false;
+  };
+
+  explicit RtfTokenizer(std::wstring_view rtf) : m_rtf(rtf) {}
+
+  Token next();
+
+  // Skips the rest of the current group, up to and including its closing brace
+  // (call right after a GroupStart, or anywhere inside the group). Used for
+  // destinations nobody reads: pictures, font and color tables, \* groups.
+  void skipGroup();
+
+  size_t position() const { return m_pos; }
+
+private:
+  std::wstring_view m_rtf;
+  size_t m_pos = 0;
+  size_t m_binPending = 0; // \binN seen: the next token is N raw characters
+};
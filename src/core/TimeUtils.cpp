@@ -1,15 +1,144 @@
 #include "TimeUtils.h"
 
+#include <mutex>
+#include <vector>
+
+#ifndef _WIN32
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#endif
+
 namespace {
+constexpr int kFirstZoneYear = 1970;
+constexpr int kLastZoneYear = 2100;
+
+std::mutex g_zoneMutex;
+std::shared_ptr<const LocalTime::Zone> g_zone;
+
+#ifdef _WIN32
 constexpr int64_t kUnixEpochDiff100ns = 116444736000000000LL; // 1601->1970 in 100ns
+
+int64_t wallClockMs(int32_t days, const SYSTEMTIME& st) {
+  return days * LocalTime::kDayMs + ((st.wHour * 60 + st.wMinute) * 60 + st.wSecond) * 1000 + st.wMilliseconds;
+}
+
+// Local wall-clock time of a TIME_ZONE_INFORMATION transition rule in a year:
+// an absolute date, or (wYear == 0) the wDay-th wDayOfWeek of the month, 5 = last.
+int64_t ruleLocalMs(int year, const SYSTEMTIME& rule) {
+  if (rule.wYear != 0) {
+    return wallClockMs(Civil::daysFromCivil(rule.wYear, rule.wMonth, rule.wDay), rule);
+  }
+  const int32_t first = Civil::daysFromCivil(year, rule.wMonth, 1);
+  const int32_t next = Civil::daysFromCivil(year, rule.wMonth + 1, 1);
+  int32_t day = first + (rule.wDayOfWeek - Civil::weekday(first) + 7) % 7 + (rule.wDay - 1) * 7;
+  while (day >= next) {
+    day -= 7;
+  }
+  return wallClockMs(day, rule);
+}
+
+LocalTime::Zone buildLocalZone() {
+  DYNAMIC_TIME_ZONE_INFORMATION dtzi{};
+  if (GetDynamicTimeZoneInformation(&dtzi) == TIME_ZONE_ID_INVALID) {
+    return {};
+  }
+  std::vector<LocalTime::Transition> transitions;
+  for (int year = kFirstZoneYear; year <= kLastZoneYear; ++year) {
+    TIME_ZONE_INFORMATION tzi{};
+    if (!GetTimeZoneInformationForYear(static_cast<USHORT>(year), &dtzi, &tzi)) {
+      continue;
+    }
+    // Bias is UTC - local in minutes.
+    const int32_t standard = -(tzi.Bias + tzi.StandardBias) * 60'000;
+    const int32_t daylight = -(tzi.Bias + tzi.DaylightBias) * 60'000;
+    const int64_t yearStart = Civil::daysFromCivil(year, 1, 1) * LocalTime::kDayMs;
+    if (tzi.StandardDate.wMonth == 0 || tzi.DaylightDate.wMonth == 0) {
+      transitions.push_back({ yearStart - standard, standard });
+      continue;
+    }
+    // Each rule is given in the wall-clock time in effect before it.
+    const int64_t toDaylight = ruleLocalMs(year, tzi.DaylightDate) - standard;
+    const int64_t toStandard = ruleLocalMs(year, tzi.StandardDate) - daylight;
+    if (toDaylight < toStandard) {
+      transitions.push_back({ yearStart - standard, standard });
+      transitions.push_back({ toDaylight, daylight });
+      transitions.push_back({ toStandard, standard });
+    } else { // southern hemisphere: the year starts in daylight time
+      transitions.push_back({ yearStart - daylight, daylight });
+      transitions.push_back({ toStandard, standard });
+      transitions.push_back({ toDaylight, daylight });
+    }
+  }
+  return LocalTime::Zone(transitions);
+}
+#else
+int32_t offsetMsAt(int64_t utcSeconds) {
+  const time_t t = static_cast<time_t>(utcSeconds);
+  tm local{};
+  if (!localtime_r(&t, &local)) return 0;
+  return static_cast<int32_t>(local.tm_gmtoff * 1000);
+}
+
+// The C library only answers point queries: sample the offset once a day and
+// bisect every change down to the second (zones never change twice within a day).
+LocalTime::Zone buildLocalZone() {
+  tzset();
+  const int64_t first = int64_t{ Civil::daysFromCivil(kFirstZoneYear, 1, 1) } * 86'400;
+  const int64_t end = int64_t{ Civil::daysFromCivil(kLastZoneYear + 1, 1, 1) } * 86'400;
+  int32_t offset = offsetMsAt(first);
+  std::vector<LocalTime::Transition> transitions{ { first * 1000, offset } };
+  for (int64_t t = first; t < end;) {
+    const int64_t next = std::min(t + 86'400, end);
+    if (offsetMsAt(next) == offset) {
+      t = next;
+      continue;
+    }
+    int64_t lo = t; // still the old offset
+    int64_t hi = next;
+    while (hi - lo > 1) {
+      const int64_t mid = lo + (hi - lo) / 2;
+      if (offsetMsAt(mid) == offset) {
+        lo = mid;
+      } else {
+        hi = mid;
+      }
+    }
+    offset = offsetMsAt(hi);
+    transitions.push_back({ hi * 1000, offset });
+    t = hi;
+  }
+  return LocalTime::Zone(transitions);
+}
+#endif
+} // namespace
+
+std::shared_ptr<const LocalTime::Zone> TimeUtils::localZone() {
+  std::lock_guard lock(g_zoneMutex);
+  if (!g_zone) {
+    g_zone = std::make_shared<const LocalTime::Zone>(buildLocalZone());
+  }
+  return g_zone;
+}
+
+void TimeUtils::resetLocalZone() {
+  std::lock_guard lock(g_zoneMutex);
+  g_zone.reset();
 }
 
 int64_t TimeUtils::unixMsNowUtc() {
+#ifdef _WIN32
   FILETIME ft{};
   GetSystemTimeAsFileTime(&ft);
   return fileTimeToUnixMsUtc(ft);
+#else
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+#endif
 }
 
+#ifdef _WIN32
+
 int64_t TimeUtils::fileTimeToUnixMsUtc(const FILETIME& ftUtc) {
   ULARGE_INTEGER u{};
   u.LowPart = ftUtc.dwLowDateTime;
@@ -42,21 +171,45 @@ SYSTEMTIME TimeUtils::unixMsToSystemTimeUtc(int64_t msUtc) {
 }
 
 SYSTEMTIME TimeUtils::unixMsToSystemTimeLocal(int64_t msUtc) {
-  FILETIME ftUtc = unixMsToFileTimeUtc(msUtc);
-  FILETIME ftLocal{};
-  FileTimeToLocalFileTime(&ftUtc, &ftLocal);
+  const int64_t local = localZone()->toLocal(msUtc);
+  auto days = static_cast<int32_t>(local / LocalTime::kDayMs);
+  auto msOfDay = static_cast<int32_t>(local % LocalTime::kDayMs);
+  if (msOfDay < 0) {
+    days -= 1;
+    msOfDay += static_cast<int32_t>(LocalTime::kDayMs);
+  }
+  const Civil::Date date = Civil::fromDays(days);
   SYSTEMTIME st{};
-  FileTimeToSystemTime(&ftLocal, &st);
+  st.wYear = static_cast<WORD>(date.year);
+  st.wMonth = static_cast<WORD>(date.month);
+  st.wDay = static_cast<WORD>(date.day);
+  st.wDayOfWeek = static_cast<WORD>(Civil::weekday(days));
+  st.wHour = static_cast<WORD>(msOfDay / 3'600'000);
+  st.wMinute = static_cast<WORD>(msOfDay / 60'000 % 60);
+  st.wSecond = static_cast<WORD>(msOfDay / 1000 % 60);
+  st.wMilliseconds = static_cast<WORD>(msOfDay % 1000);
   return st;
 }
 
 int64_t TimeUtils::localSystemTimeToUnixMsUtc(const SYSTEMTIME& stLocal) {
-  SYSTEMTIME stUtc{};
-  if (!TzSpecificLocalTimeToSystemTime(nullptr, &stLocal, &stUtc)) {
-    // fallback: treat as UTC if conversion failed
-    stUtc = stLocal;
-  }
-  return systemTimeUtcToUnixMs(stUtc);
+  return localZone()->toUtc(wallClockMs(Civil::daysFromCivil(stLocal.wYear, stLocal.wMonth, stLocal.wDay), stLocal));
+}
+
+#endif
+
+int64_t TimeUtils::localMidnightToUnixMsUtc(int year, int month, int day) {
+  return localZone()->dayStartUtc(Civil::daysFromCivil(year, month, day));
 }
 
+Civil::Date TimeUtils::localDate(int64_t msUtc) {
+  return Civil::fromDays(localZone()->dayNumber(msUtc));
+}
+
+int64_t TimeUtils::localTimeOfDayMs(int64_t msUtc) {
+  const int64_t ms = localZone()->toLocal(msUtc) % LocalTime::kDayMs;
+  return ms < 0 ? ms + LocalTime::kDayMs : ms;
+}
 
+int64_t TimeUtils::localDateTimeToUnixMsUtc(const Civil::Date& date, int64_t msOfDay) {
+  return localZone()->toUtc(Civil::toDays(date) * LocalTime::kDayMs + msOfDay);
+}
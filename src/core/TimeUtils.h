@@ -1,19 +1,47 @@
 #pragma once
 
+#include "core/Civil.h"
+#include "core/LocalTime.h"
+
 #include <cstdint>
+#include <memory>
+
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 namespace TimeUtils {
 int64_t unixMsNowUtc();
 
+// The user's time zone as a LocalTime table, built once from the Win32 rules for
+// 1970-2100 (GetTimeZoneInformationForYear, so historical and dynamic DST changes
+// are kept); elsewhere from the C library's zone (TZ, /etc/localtime). Thread-safe;
+// hold the pointer for a batch of conversions.
+std::shared_ptr<const LocalTime::Zone> localZone();
+// Rebuilds the table on next use; call when the time zone may have changed.
+void resetLocalZone();
+
+#ifdef _WIN32
 int64_t fileTimeToUnixMsUtc(const FILETIME& ftUtc);
 FILETIME unixMsToFileTimeUtc(int64_t msUtc);
 
 int64_t systemTimeUtcToUnixMs(const SYSTEMTIME& stUtc);
 SYSTEMTIME unixMsToSystemTimeUtc(int64_t msUtc);
 
+// Local conversions here and below go through localZone() and make no system calls.
 SYSTEMTIME unixMsToSystemTimeLocal(int64_t msUtc);
 int64_t localSystemTimeToUnixMsUtc(const SYSTEMTIME& stLocal);
-}
+#endif
+
+// UTC instant of local midnight starting the given date. month/day may run past
+// their range (month 13, day 32, day 0) and are normalized, so the next day/month
+// boundary is localMidnightToUnixMsUtc(y, m, d + 1) / (y, m + 1, 1).
+int64_t localMidnightToUnixMsUtc(int year, int month, int day);
 
+// Local calendar date / wall-clock time (ms since local midnight) of an instant,
+// and back: the date math itself is Civil, without SYSTEMTIME round-trips.
+Civil::Date localDate(int64_t msUtc);
+int64_t localTimeOfDayMs(int64_t msUtc);
+int64_t localDateTimeToUnixMsUtc(const Civil::Date& date, int64_t msOfDay);
+}
 
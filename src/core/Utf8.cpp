@@ -0,0 +1,327 @@
+#include "Utf8.h"
+
+#include <bit>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UTF8_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+constexpr char32_t kReplacement = 0xFFFD;
+
+bool isContinuation(uint8_t b) {
+  return (b & 0xC0) == 0x80;
+}
+
+wchar_t* putCodePoint(wchar_t* out, char32_t cp) {
+  if constexpr (sizeof(wchar_t) == 2) {
+    if (cp >= 0x10000) {
+      cp -= 0x10000;
+      *out++ = static_cast<wchar_t>(0xD800 + (cp >> 10));
+      *out++ = static_cast<wchar_t>(0xDC00 + (cp & 0x3FF));
+      return out;
+    }
+  }
+  *out++ = static_cast<wchar_t>(cp);
+  return out;
+}
+
+char* putUtf8(char* out, char32_t cp) {
+  if (cp < 0x80) {
+    *out++ = static_cast<char>(cp);
+  } else if (cp < 0x800) {
+    *out++ = static_cast<char>(0xC0 | (cp >> 6));
+    *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    *out++ = static_cast<char>(0xE0 | (cp >> 12));
+    *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+  } else {
+    *out++ = static_cast<char>(0xF0 | (cp >> 18));
+    *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+  }
+  return out;
+}
+
+// Decodes the non-ASCII sequence at p (p < end) into *cp. Returns false with
+// *cp = U+FFFD and *len covering the maximal invalid subpart.
+bool decodeSequence(const uint8_t* p, const uint8_t* end, char32_t* cp, size_t* len) {
+  const uint8_t b0 = p[0];
+  const size_t avail = static_cast<size_t>(end - p);
+  *cp = kReplacement;
+  *len = 1;
+  if (b0 >= 0xC2 && b0 <= 0xDF) {
+    if (avail < 2 || !isContinuation(p[1])) return false;
+    *len = 2;
+    *cp = (static_cast<char32_t>(b0 & 0x1F) << 6) | (p[1] & 0x3F);
+    return true;
+  }
+  if (b0 >= 0xE0 && b0 <= 0xEF) {
+    // second byte range excludes overlongs (E0) and surrogates (ED)
+    const uint8_t lo = b0 == 0xE0 ? 0xA0 : 0x80;
+    const uint8_t hi = b0 == 0xED ? 0x9F : 0xBF;
+    if (avail < 2 || p[1] < lo || p[1] > hi) return false;
+    if (avail < 3 || !isContinuation(p[2])) {
+      *len = 2;
+      return false;
+    }
+    *len = 3;
+    *cp = (static_cast<char32_t>(b0 & 0x0F) << 12) | (static_cast<char32_t>(p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+    return true;
+  }
+  if (b0 >= 0xF0 && b0 <= 0xF4) {
+    const uint8_t lo = b0 == 0xF0 ? 0x90 : 0x80;
+    const uint8_t hi = b0 == 0xF4 ? 0x8F : 0xBF;
+    if (avail < 2 || p[1] < lo || p[1] > hi) return false;
+    if (avail < 3 || !isContinuation(p[2])) {
+      *len = 2;
+      return false;
+    }
+    if (avail < 4 || !isContinuation(p[3])) {
+      *len = 3;
+      return false;
+    }
+    *len = 4;
+    *cp = (static_cast<char32_t>(b0 & 0x07) << 18) | (static_cast<char32_t>(p[1] & 0x3F) << 12) |
+          (static_cast<char32_t>(p[2] & 0x3F) << 6) | (p[3] & 0x3F);
+    return true;
+  }
+  return false; // stray continuation byte, C0/C1, F5..FF
+}
+
+#ifdef UTF8_SSE2
+// Widens 16 bytes to wchar_t and stores them at out.
+void storeWidened(wchar_t* out, __m128i bytes) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+  const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+  if constexpr (sizeof(wchar_t) == 2) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), hi);
+  } else {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(lo, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(lo, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpacklo_epi16(hi, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm_unpackhi_epi16(hi, zero));
+  }
+}
+
+// Narrows 16 wchar_t at in to bytes (values above 0xFF saturate); the 16-bit
+// mask has a bit set for every unit that is not ASCII.
+__m128i loadNarrowed(const wchar_t* in, unsigned* nonAscii) {
+  const auto* v = reinterpret_cast<const __m128i*>(in);
+  if constexpr (sizeof(wchar_t) == 2) {
+    const __m128i w0 = _mm_loadu_si128(v);
+    const __m128i w1 = _mm_loadu_si128(v + 1);
+    const __m128i highBits = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i a0 = _mm_cmpeq_epi16(_mm_and_si128(w0, highBits), zero);
+    const __m128i a1 = _mm_cmpeq_epi16(_mm_and_si128(w1, highBits), zero);
+    *nonAscii = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_packs_epi16(a0, a1))) & 0xFFFF;
+    return _mm_packus_epi16(w0, w1);
+  } else {
+    const __m128i highBits = _mm_set1_epi32(static_cast<int>(0xFFFFFF80u));
+    const __m128i d0 = _mm_loadu_si128(v);
+    const __m128i d1 = _mm_loadu_si128(v + 1);
+    const __m128i d2 = _mm_loadu_si128(v + 2);
+    const __m128i d3 = _mm_loadu_si128(v + 3);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i a0 = _mm_cmpeq_epi32(_mm_and_si128(d0, highBits), zero);
+    const __m128i a1 = _mm_cmpeq_epi32(_mm_and_si128(d1, highBits), zero);
+    const __m128i a2 = _mm_cmpeq_epi32(_mm_and_si128(d2, highBits), zero);
+    const __m128i a3 = _mm_cmpeq_epi32(_mm_and_si128(d3, highBits), zero);
+    const __m128i ascii = _mm_packs_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3));
+    *nonAscii = ~static_cast<unsigned>(_mm_movemask_epi8(ascii)) & 0xFFFF;
+    // Saturation garbles non-ASCII lanes; callers only keep the ASCII prefix.
+    return _mm_packus_epi16(_mm_packs_epi32(d0, d1), _mm_packs_epi32(d2, d3));
+  }
+}
+#endif
+} // namespace
+
+namespace Utf8 {
+size_t decode(std::string_view in, wchar_t* out, bool* invalid) {
+  const auto* p = reinterpret_cast<const uint8_t*>(in.data());
+  const uint8_t* const end = p + in.size();
+  wchar_t* const begin = out;
+  bool bad = false;
+  while (p < end) {
+#ifdef UTF8_SSE2
+    // Every unit written consumes at least one byte, so 16 bytes of input left
+    // means room for 16 units: store the whole block, keep its ASCII prefix.
+    if (end - p >= 16) {
+      const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      const auto mask = static_cast<unsigned>(_mm_movemask_epi8(bytes));
+      storeWidened(out, bytes);
+      const int ascii = mask == 0 ? 16 : std::countr_zero(mask);
+      p += ascii;
+      out += ascii;
+      if (ascii == 16) continue;
+    }
+#endif
+    // Scalar: up to the next ASCII byte (Cyrillic words stay in this loop).
+    while (p < end) {
+      const uint8_t b = *p;
+      if (b < 0x80) {
+        *out++ = static_cast<wchar_t>(b);
+        ++p;
+        break;
+      }
+      if (b >= 0xC2 && b <= 0xDF && end - p >= 2 && isContinuation(p[1])) {
+        *out++ = static_cast<wchar_t>(((b & 0x1F) << 6) | (p[1] & 0x3F));
+        p += 2;
+        continue;
+      }
+      char32_t cp = 0;
+      size_t len = 0;
+      bad |= !decodeSequence(p, end, &cp, &len);
+      out = putCodePoint(out, cp);
+      p += len;
+    }
+  }
+  if (invalid) *invalid = bad;
+  return static_cast<size_t>(out - begin);
+}
+
+size_t encode(std::wstring_view in, char* out, bool* invalid) {
+  const wchar_t* p = in.data();
+  const wchar_t* const end = p + in.size();
+  char* const begin = out;
+  bool bad = false;
+  while (p < end) {
+#ifdef UTF8_SSE2
+    // Every unit left needs at least one byte of output, so 16 units left
+    // mean room for 16 bytes even in an exactly sized buffer.
+    if (end - p >= 16) {
+      unsigned nonAscii = 0;
+      const __m128i bytes = loadNarrowed(p, &nonAscii);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+      const int ascii = nonAscii == 0 ? 16 : std::countr_zero(nonAscii);
+      p += ascii;
+      out += ascii;
+      if (ascii == 16) continue;
+    }
+#endif
+    while (p < end) {
+      char32_t cp = static_cast<char32_t>(*p);
+      if (cp < 0x80) {
+        *out++ = static_cast<char>(cp);
+        ++p;
+        break;
+      }
+      ++p;
+      if (cp >= 0xD800 && cp <= 0xDFFF) {
+        if constexpr (sizeof(wchar_t) == 2) {
+          if (cp <= 0xDBFF && p < end && *p >= 0xDC00 && *p <= 0xDFFF) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (static_cast<char32_t>(*p) - 0xDC00);
+            ++p;
+          } else {
+            cp = kReplacement;
+            bad = true;
+          }
+        } else {
+          cp = kReplacement;
+          bad = true;
+        }
+      } else if (cp > 0x10FFFF) {
+        cp = kReplacement;
+        bad = true;
+      }
+      out = putUtf8(out, cp);
+    }
+  }
+  if (invalid) *invalid = bad;
+  return static_cast<size_t>(out - begin);
+}
+
+size_t utf8Length(std::wstring_view in) {
+  size_t n = 0;
+  for (size_t i = 0; i < in.size(); ++i) {
+#ifdef UTF8_SSE2
+    if (in.size() - i >= 16) {
+      unsigned nonAscii = 0;
+      loadNarrowed(in.data() + i, &nonAscii);
+      if (nonAscii == 0) {
+        n += 16;
+        i += 15;
+        continue;
+      }
+    }
+#endif
+    const auto c = static_cast<char32_t>(in[i]);
+    if (c < 0x80) {
+      n += 1;
+    } else if (c < 0x800) {
+      n += 2;
+    } else if constexpr (sizeof(wchar_t) == 2) {
+      const bool pair = c >= 0xD800 && c <= 0xDBFF && i + 1 < in.size() && in[i + 1] >= 0xDC00 && in[i + 1] <= 0xDFFF;
+      n += pair ? 4 : 3; // an unpaired surrogate becomes U+FFFD
+      i += pair ? 1 : 0;
+    } else {
+      n += (c >= 0x10000 && c <= 0x10FFFF) ? 4 : 3;
+    }
+  }
+  return n;
+}
+
+void toWide(std::string_view in, std::wstring& out) {
+  out.clear();
+  appendWide(in, out);
+}
+
+void toUtf8(std::wstring_view in, std::string& out) {
+  out.clear();
+  appendUtf8(in, out);
+}
+
+std::wstring toWide(std::string_view in) {
+  std::wstring out;
+  appendWide(in, out);
+  return out;
+}
+
+std::string toUtf8(std::wstring_view in) {
+  std::string out;
+  appendUtf8(in, out);
+  return out;
+}
+
+void appendWide(std::string_view in, std::wstring& out) {
+  const size_t old = out.size();
+  out.resize(old + maxWideLength(in.size()));
+  out.resize(old + decode(in, out.data() + old));
+}
+
+void appendUtf8(std::wstring_view in, std::string& out) {
+  const size_t old = out.size();
+  out.resize(old + utf8Length(in));
+  encode(in, out.data() + old);
+}
+
+bool isValid(std::string_view in) {
+  const auto* p = reinterpret_cast<const uint8_t*>(in.data());
+  const uint8_t* const end = p + in.size();
+  while (p < end) {
+#ifdef UTF8_SSE2
+    if (end - p >= 16 &&
+        _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) == 0) {
+      p += 16;
+      continue;
+    }
+#endif
+    if (*p < 0x80) {
+      ++p;
+      continue;
+    }
+    char32_t cp = 0;
+    size_t len = 0;
+    if (!decodeSequence(p, end, &cp, &len)) return false;
+    p += len;
+  }
+  return true;
+}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace Utf8 {
+// Portable UTF-8 <-> wchar_t (UTF-16 on Windows, UTF-32 elsewhere) transcoding.
+// Malformed input is replaced with U+FFFD, one per maximal invalid subsequence
+// (UTF-8) or per unpaired surrogate (UTF-16), like MultiByteToWideChar and
+// WideCharToMultiByte without the "fail on invalid" flags. Runs of ASCII are
+// converted 16 characters at a time with SSE2 where available.
+
+// Output capacity that is always enough for n input units.
+constexpr size_t maxWideLength(size_t utf8Bytes) {
+  return utf8Bytes;
+}
+constexpr size_t maxUtf8Length(size_t wideUnits) {
+  return wideUnits * (sizeof(wchar_t) == 2 ? 3 : 4);
+}
+
+// Exact encoded size of in (cheap: one pass over the units, no output).
+size_t utf8Length(std::wstring_view in);
+
+// Convert into a caller buffer and return the number of units written. decode()
+// needs maxWideLength(in.size()) units; encode() needs utf8Length(in) bytes
+// (at most maxUtf8Length(in.size())).
+// *invalid is set when a replacement character had to be emitted.
+size_t decode(std::string_view in, wchar_t* out, bool* invalid = nullptr);
+size_t encode(std::wstring_view in, char* out, bool* invalid = nullptr);
+
+// Replace the contents of out, reusing its capacity.
+void toWide(std::string_view in, std::wstring& out);
+void toUtf8(std::wstring_view in, std::string& out);
+// Same, into a new string.
+std::wstring toWide(std::string_view in);
+std::string toUtf8(std::wstring_view in);
+
+// Appends to out.
+void appendWide(std::string_view in, std::wstring& out);
+void appendUtf8(std::wstring_view in, std::string& out);
+
+bool isValid(std::string_view in);
+}
@@ -0,0 +1,166 @@
+#include "Wav.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr uint16_t kFormatPcm = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+// Longer files are left to the system player rather than held in memory
+// (5 minutes of 48 kHz stereo is about 55 MB).
+constexpr uint64_t kMaxFrames = uint64_t{ Wav::kSampleRate } * 5 * 60;
+
+uint16_t loadU16(const char* p) {
+  const auto* b = reinterpret_cast<const unsigned char*>(p);
+  return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+uint32_t loadU32(const char* p) {
+  const auto* b = reinterpret_cast<const unsigned char*>(p);
+  return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) | (static_cast<uint32_t>(b[2]) << 16) |
+         (static_cast<uint32_t>(b[3]) << 24);
+}
+
+bool fail(std::wstring* errorOut, const wchar_t* what) {
+  if (errorOut) *errorOut = what;
+  return false;
+}
+
+struct Format {
+  uint16_t tag = 0; // kFormatPcm or kFormatFloat after unwrapping WAVE_FORMAT_EXTENSIBLE
+  uint16_t channels = 0;
+  uint32_t sampleRate = 0;
+  uint16_t blockAlign = 0;
+  uint16_t bits = 0;
+};
+
+// One sample in [-1, 1].
+float sampleAt(const char* p, const Format& f) {
+  if (f.tag == kFormatFloat) {
+    if (f.bits == 32) {
+      float v;
+      std::memcpy(&v, p, sizeof v);
+      return v;
+    }
+    double v;
+    std::memcpy(&v, p, sizeof v);
+    return static_cast<float>(v);
+  }
+  switch (f.bits) {
+    case 8: return (static_cast<int>(static_cast<unsigned char>(*p)) - 128) / 128.0f;
+    case 16: return static_cast<int16_t>(loadU16(p)) / 32768.0f;
+    case 24: {
+      const auto* b = reinterpret_cast<const unsigned char*>(p);
+      int32_t v = b[0] | (b[1] << 8) | (b[2] << 16);
+      if (v & 0x800000) v -= 0x1000000;
+      return v / 8388608.0f;
+    }
+    default: return static_cast<int32_t>(loadU32(p)) / 2147483648.0f;
+  }
+}
+
+// The inverse of the 16-bit case of sampleAt(), so 16-bit input is kept exactly.
+int16_t toPcm16(float v) {
+  const float scaled = std::nearbyint(v * 32768.0f);
+  if (!(scaled > -32768.0f)) return -32768; // also NaN
+  if (scaled > 32767.0f) return 32767;
+  return static_cast<int16_t>(scaled);
+}
+} // namespace
+
+namespace Wav {
+bool decode(std::string_view file, Clip& out, std::wstring* errorOut) {
+  out.samples.clear();
+  if (file.size() < 12 || file.substr(0, 4) != "RIFF" || file.substr(8, 4) != "WAVE") {
+    return fail(errorOut, L"Файл не является WAV (RIFF/WAVE)");
+  }
+
+  Format f;
+  bool haveFormat = false;
+  std::string_view data;
+  bool haveData = false;
+  size_t pos = 12;
+  while (pos + 8 <= file.size()) {
+    const std::string_view id = file.substr(pos, 4);
+    const uint32_t size = loadU32(file.data() + pos + 4);
+    pos += 8;
+    // The last chunk of a truncated (or still being written) file claims more
+    // bytes than there are: take what is there.
+    const size_t avail = std::min<size_t>(size, file.size() - pos);
+    const char* p = file.data() + pos;
+    if (id == "fmt " && avail >= 16) {
+      f.tag = loadU16(p);
+      f.channels = loadU16(p + 2);
+      f.sampleRate = loadU32(p + 4);
+      f.blockAlign = loadU16(p + 12);
+      f.bits = loadU16(p + 14);
+      if (f.tag == kFormatExtensible && avail >= 40) {
+        f.tag = loadU16(p + 24); // first two bytes of the SubFormat GUID
+      }
+      haveFormat = true;
+    } else if (id == "data") {
+      data = file.substr(pos, avail);
+      haveData = true;
+    }
+    pos += avail + (avail & 1); // chunks are padded to an even size
+  }
+
+  if (!haveFormat || !haveData) {
+    return fail(errorOut, L"В WAV нет блока формата или данных");
+  }
+  const bool pcm = f.tag == kFormatPcm && (f.bits == 8 || f.bits == 16 || f.bits == 24 || f.bits == 32);
+  const bool flt = f.tag == kFormatFloat && (f.bits == 32 || f.bits == 64);
+  if (!pcm && !flt) {
+    return fail(errorOut, L"Формат WAV не поддерживается (нужен PCM или float без сжатия)");
+  }
+  const size_t bytesPerSample = f.bits / 8;
+  if (f.channels == 0 || f.sampleRate == 0 || f.blockAlign < f.channels * bytesPerSample) {
+    return fail(errorOut, L"Повреждённый заголовок WAV");
+  }
+
+  const uint64_t inFrames = data.size() / f.blockAlign;
+  if (inFrames == 0) return true;
+  const uint64_t outFrames = std::max<uint64_t>(1, inFrames * kSampleRate / f.sampleRate);
+  if (outFrames > kMaxFrames) {
+    return fail(errorOut, L"Звук слишком длинный");
+  }
+
+  // Source frame i as a stereo pair.
+  const size_t right = f.channels > 1 ? bytesPerSample : 0;
+  auto frame = [&](uint64_t i, float& l, float& r) {
+    const char* p = data.data() + i * f.blockAlign;
+    l = sampleAt(p, f);
+    r = sampleAt(p + right, f);
+  };
+
+  out.samples.resize(static_cast<size_t>(outFrames) * kChannels);
+  int16_t* dst = out.samples.data();
+  if (f.sampleRate == kSampleRate) {
+    for (uint64_t i = 0; i < outFrames; ++i) {
+      float l, r;
+      frame(i, l, r);
+      *dst++ = toPcm16(l);
+      *dst++ = toPcm16(r);
+    }
+    return true;
+  }
+
+  // Linear interpolation; the source position advances in 32.32 fixed point.
+  const uint64_t step = (uint64_t{ f.sampleRate } << 32) / kSampleRate;
+  uint64_t at = 0;
+  for (uint64_t i = 0; i < outFrames; ++i, at += step) {
+    const uint64_t i0 = std::min(at >> 32, inFrames - 1);
+    const uint64_t i1 = std::min(i0 + 1, inFrames - 1);
+    const float t = static_cast<float>(at & 0xFFFFFFFFu) * (1.0f / 4294967296.0f);
+    float l0, r0, l1, r1;
+    frame(i0, l0, r0);
+    frame(i1, l1, r1);
+    *dst++ = toPcm16(l0 + (l1 - l0) * t);
+    *dst++ = toPcm16(r0 + (r1 - r0) * t);
+  }
+  return true;
+}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// WAV decoding into the one format the reminder mixer plays: interleaved stereo
+// 16-bit PCM at kSampleRate. Portable (no WinAPI).
+namespace Wav {
+constexpr int kSampleRate = 48000;
+constexpr int kChannels = 2;
+
+struct Clip {
+  std::vector<int16_t> samples; // L R L R ...
+
+  size_t frames() const { return samples.size() / kChannels; }
+};
+
+// Parses a RIFF/WAVE file: integer PCM of 8, 16, 24 or 32 bits or IEEE float of
+// 32 or 64 bits (plain or WAVE_FORMAT_EXTENSIBLE), any rate and channel count.
+// Mono is played on both channels, channels past the first two are dropped and
+// other rates are resampled (linear interpolation). Compressed formats (ADPCM,
+// MP3 in WAV, ...) fail with errorOut set.
+bool decode(std::string_view file, Clip& out, std::wstring* errorOut = nullptr);
+}
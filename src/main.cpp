@@ -1,5 +1,9 @@
 #include "app/SingleInstance.h"
+#include "core/FileIo.h"
+#include "model/NoteRepository.h"
+#include "settings/AppSettings.h"
 #include "win/MainWindow.h"
+#include "win/ReminderSounds.h"
 #include "win/WinUtil.h"
 
 #include <windows.h>
@@ -19,8 +23,25 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, PWSTR, int nCmdShow) {
     return 0;
   }
 
+  FileIo::setSyncPolicy(static_cast<FileIo::SyncMode>(AppSettings::storageSyncMode()),
+                        AppSettings::storageSyncGroupMs());
+
+  {
+    const auto kind = static_cast<NoteStorageKind>(AppSettings::storageBackend());
+    std::wstring err;
+    if (!NoteRepository::open(kind, &err) && kind != NoteStorageKind::Directory) {
+      // Keep the app usable: fall back to the per-directory layout.
+      MessageBoxW(nullptr, err.c_str(), L"AlertCalendar", MB_ICONERROR);
+      NoteRepository::open(NoteStorageKind::Directory, nullptr);
+    }
+  }
+
+  ReminderSounds::init();
+
   MainWindow w(hInstance);
   if (!w.create()) {
+    ReminderSounds::shutdown();
+    NoteRepository::close();
     return 1;
   }
   w.show(nCmdShow);
@@ -31,6 +52,8 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, PWSTR, int nCmdShow) {
     DispatchMessageW(&msg);
   }
 
+  ReminderSounds::shutdown();
+  NoteRepository::close();
   if (comInit) CoUninitialize();
   return 0;
 }
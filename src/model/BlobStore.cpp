@@ -0,0 +1,133 @@
+#include "BlobStore.h"
+
+#include "core/FileIo.h"
+#include "core/Hash64.h"
+
+#include <cwctype>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr size_t kHashDigits = 32;
+constexpr uint64_t kSecondSeed = 0x9E3779B97F4A7C15ull;
+
+void appendHex64(std::wstring& out, uint64_t v) {
+  static const wchar_t* hex = L"0123456789abcdef";
+  for (int shift = 60; shift >= 0; shift -= 4) {
+    out.push_back(hex[(v >> shift) & 0xF]);
+  }
+}
+
+bool isHexDigit(wchar_t c) {
+  return (c >= L'0' && c <= L'9') || (c >= L'a' && c <= L'f');
+}
+
+bool sameBytes(const fs::path& path, const std::string& bytes) {
+  std::ifstream f(path, std::ios::binary);
+  if (!f.is_open()) {
+    return false;
+  }
+  std::string stored((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+  return stored == bytes;
+}
+} // namespace
+
+BlobStore::BlobStore(fs::path root) : m_root(std::move(root)) {}
+
+bool BlobStore::isValidKey(const std::wstring& key) {
+  // 32 lowercase hex digits, then ".ext" of 1..8 alphanumerics: never a path.
+  if (key.size() < kHashDigits + 2 || key.size() > kHashDigits + 9 || key[kHashDigits] != L'.') {
+    return false;
+  }
+  for (size_t i = 0; i < key.size(); ++i) {
+    const wchar_t c = key[i];
+    if (i < kHashDigits ? !isHexDigit(c) : (i > kHashDigits && !iswalnum(c))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+fs::path BlobStore::pathFor(const std::wstring& key) const {
+  return m_root / key.substr(0, 2) / key;
+}
+
+std::wstring BlobStore::put(const std::string& bytes, const std::wstring& ext, std::wstring* errorOut) {
+  std::wstring key;
+  key.reserve(kHashDigits + ext.size());
+  appendHex64(key, Hash64::compute(bytes.data(), bytes.size()));
+  appendHex64(key, Hash64::compute(bytes.data(), bytes.size(), kSecondSeed));
+  key += ext;
+  if (!isValidKey(key)) {
+    if (errorOut) {
+      *errorOut = L"Недопустимый тип изображения: " + ext;
+    }
+    return {};
+  }
+
+  const fs::path path = pathFor(key);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_verified.count(key)) {
+      return key;
+    }
+  }
+  // A file under this key may be left over from a crash (empty or cut short), and
+  // every later put would trust it: compare it with the bytes once, rewrite if it differs.
+  std::error_code ec;
+  if (!fs::exists(path, ec) || fs::file_size(path, ec) != bytes.size() || !sameBytes(path, bytes)) {
+    fs::create_directories(path.parent_path(), ec);
+    // Durable before any note that refers to it is written.
+    if (!FileIo::writeFileDurable(path, bytes, errorOut)) {
+      return {};
+    }
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_verified.insert(key);
+  return key;
+}
+
+bool BlobStore::get(const std::wstring& key, std::string& out) const {
+  out.clear();
+  if (!isValidKey(key)) {
+    return false;
+  }
+  std::ifstream f(pathFor(key), std::ios::binary);
+  if (!f.is_open()) {
+    return false;
+  }
+  out.assign((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+  return true;
+}
+
+size_t BlobStore::sweep(const std::unordered_set<std::wstring>& live) {
+  size_t removed = 0;
+  std::error_code ec;
+  for (fs::directory_iterator dir(m_root, ec), end; !ec && dir != end; dir.increment(ec)) {
+    // Only the two-digit fan-out directories belong to the store.
+    const std::wstring name = dir->path().filename().wstring();
+    if (name.size() != 2 || !isHexDigit(name[0]) || !isHexDigit(name[1]) || !dir->is_directory(ec)) {
+      continue;
+    }
+    std::vector<fs::path> dead;
+    std::error_code fec;
+    for (fs::directory_iterator it(dir->path(), fec); !fec && it != end; it.increment(fec)) {
+      const std::wstring key = it->path().filename().wstring();
+      if (isValidKey(key) && !live.count(key)) {
+        dead.push_back(it->path());
+      }
+    }
+    for (const auto& path : dead) {
+      std::error_code rec;
+      if (fs::remove(path, rec)) {
+        ++removed;
+      }
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_verified.erase(path.filename().wstring());
+    }
+  }
+  return removed;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+// Content-addressed, write-once file store for binary blobs (note pictures).
+//
+// A key is 32 hex digits (two Hash64 passes over the bytes) plus a type extension,
+// e.g. "0123...cdef.png"; the blob lives at <root>/<first 2 digits>/<key>. Identical
+// bytes always map to the same file, so a picture pasted into many notes is stored
+// once. Files are replaced atomically and never modified after creation; a file
+// found under a key is checked against the bytes the first time it is reused.
+class BlobStore {
+public:
+  explicit BlobStore(std::filesystem::path root);
+
+  // Stores bytes (no-op if already stored intact) and returns the key, or "" on error.
+  // ext: L".png" etc.
+  std::wstring put(const std::string& bytes, const std::wstring& ext, std::wstring* errorOut);
+  bool get(const std::wstring& key, std::string& out) const;
+
+  // Deletes every blob whose key is not in live. Returns the number removed.
+  size_t sweep(const std::unordered_set<std::wstring>& live);
+
+  static bool isValidKey(const std::wstring& key);
+
+private:
+  std::filesystem::path pathFor(const std::wstring& key) const;
+
+  std::filesystem::path m_root;
+
+  std::mutex m_mutex; // puts come from the UI thread and the storage worker
+  std::unordered_set<std::wstring> m_verified; // keys whose file holds the right bytes
+};
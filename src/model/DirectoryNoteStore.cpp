@@ -0,0 +1,266 @@
+#include "DirectoryNoteStore.h"
+
+#include "core/FileIo.h"
+#include "core/Hash64.h"
+#include "core/Utf8.h"
+#include "model/NoteMeta.h"
+
+#include <fstream>
+#include <optional>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace {
+bool readFileUtf8(const fs::path& p, std::wstring* out, std::wstring* errorOut) {
+  (void)errorOut;
+  out->clear();
+  std::ifstream f(p, std::ios::binary);
+  if (!f.is_open()) {
+    return false;
+  }
+  std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+  Utf8::toWide(data, *out);
+  return true;
+}
+
+int64_t mtimeOf(const fs::path& p) {
+  std::error_code ec;
+  const auto t = fs::last_write_time(p, ec);
+  return ec ? 0 : static_cast<int64_t>(t.time_since_epoch().count());
+}
+
+} // namespace
+
+DirectoryNoteStore::DirectoryNoteStore(fs::path root) : m_root(std::move(root)) {}
+
+// temp file + atomic rename: a crash never leaves a half-written file behind.
+// Identical bytes over a file we wrote (and nobody touched since) are skipped.
+bool DirectoryNoteStore::writeFileIfChanged(const fs::path& p, std::string_view data, std::wstring* errorOut) {
+  const uint64_t hash = Hash64::compute(data.data(), data.size());
+  std::optional<FileState> known;
+  {
+    std::lock_guard<std::mutex> lock(m_filesMutex);
+    auto it = m_files.find(p.wstring());
+    if (it != m_files.end()) known = it->second;
+  }
+  if (known && known->hash == hash && known->mtime == mtimeOf(FileIo::currentPath(p))) {
+    return true;
+  }
+
+  if (!FileIo::writeFileAtomic(p, data, errorOut)) {
+    forgetFile(p);
+    return false;
+  }
+  // Inside a batch the file is still the temp one; it keeps this mtime when renamed.
+  const int64_t mtime = mtimeOf(FileIo::currentPath(p));
+  std::lock_guard<std::mutex> lock(m_filesMutex);
+  m_files[p.wstring()] = FileState{ hash, mtime };
+  return true;
+}
+
+void DirectoryNoteStore::forgetFile(const fs::path& p) {
+  std::lock_guard<std::mutex> lock(m_filesMutex);
+  m_files.erase(p.wstring());
+}
+
+// Like readFileUtf8, but remembers the file state so saving it back unchanged is free.
+bool DirectoryNoteStore::readContentFile(const fs::path& p, std::wstring* out) {
+  out->clear();
+  const int64_t mtime = mtimeOf(p);
+  std::ifstream f(p, std::ios::binary);
+  if (!f.is_open()) {
+    return false;
+  }
+  std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+  {
+    std::lock_guard<std::mutex> lock(m_filesMutex);
+    m_files[p.wstring()] = FileState{ Hash64::compute(data.data(), data.size()), mtime };
+  }
+  Utf8::toWide(data, *out);
+  return true;
+}
+
+// title.txt + meta.txt
+bool DirectoryNoteStore::writeMetaFiles(const fs::path& dir, const NoteSummary& n, std::wstring* errorOut) {
+  std::string title;
+  Utf8::toUtf8(n.title, title);
+  char meta[NoteMeta::kMaxSize];
+  return writeFileIfChanged(dir / L"title.txt", title, errorOut) &&
+         writeFileIfChanged(dir / L"meta.txt", std::string_view(meta, NoteMeta::format(n, meta)), errorOut);
+}
+
+bool DirectoryNoteStore::loadAll(std::vector<NoteSummary>& out, std::wstring* errorOut) {
+  (void)errorOut;
+  out.clear();
+  fs::create_directories(m_root);
+  for (const auto& entry : fs::directory_iterator(m_root)) {
+    if (!entry.is_directory()) continue;
+    const std::wstring id = entry.path().filename().wstring();
+
+    NoteSummary n;
+    if (!readSummary(id, n)) {
+      continue;
+    }
+    out.push_back(std::move(n));
+  }
+  return true;
+}
+
+int64_t DirectoryNoteStore::stamp(const std::wstring& id) {
+  const fs::path dir = noteDir(id);
+  const int64_t meta = mtimeOf(dir / L"meta.txt");
+  if (meta == 0) return 0;
+  const uint64_t title = static_cast<uint64_t>(mtimeOf(dir / L"title.txt"));
+  const uint64_t mixed = static_cast<uint64_t>(meta) * 0x9E3779B97F4A7C15ull ^ title;
+  return mixed == 0 ? 1 : static_cast<int64_t>(mixed);
+}
+
+// Same walk as loadAll, but a stat of meta.txt and title.txt decides whether the
+// note is parsed again or taken from `known` (unchanged since the snapshot was
+// written).
+bool DirectoryNoteStore::scan(const std::unordered_map<std::wstring, StampedSummary>& known,
+                              std::vector<StampedSummary>& out, std::wstring* errorOut) {
+  (void)errorOut;
+  out.clear();
+  out.reserve(known.size());
+  std::error_code ec;
+  fs::create_directories(m_root, ec);
+  for (fs::directory_iterator it(m_root, ec), end; !ec && it != end; it.increment(ec)) {
+    if (!it->is_directory(ec)) continue;
+    const std::wstring id = it->path().filename().wstring();
+
+    StampedSummary entry;
+    entry.stamp = stamp(id);
+    if (entry.stamp == 0) continue; // no meta.txt: not a note
+
+    auto k = known.find(id);
+    if (k != known.end() && k->second.stamp == entry.stamp) {
+      entry.summary = k->second.summary;
+    } else if (!readSummary(id, entry.summary)) {
+      continue;
+    }
+    out.push_back(std::move(entry));
+  }
+  return true;
+}
+
+// Reads title.txt + meta.txt only (a few hundred bytes per note).
+bool DirectoryNoteStore::readSummary(const std::wstring& id, NoteSummary& out) const {
+  out = NoteSummary{};
+  out.id = id;
+  const fs::path dir = noteDir(id);
+
+  // title
+  {
+    std::wstring title;
+    readFileUtf8(dir / L"title.txt", &title, nullptr);
+    out.title = title;
+  }
+
+  // meta: a few hundred bytes, read into the stack unless hand-edited past that
+  std::ifstream f(dir / L"meta.txt", std::ios::binary);
+  if (!f.is_open()) {
+    // treat missing meta as missing note
+    return false;
+  }
+  char buf[1024];
+  f.read(buf, sizeof buf);
+  const auto got = static_cast<size_t>(f.gcount());
+  if (got < sizeof buf) {
+    NoteMeta::parse(std::string_view(buf, got), out);
+  } else {
+    std::string meta(buf, got);
+    meta.append(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    NoteMeta::parse(meta, out);
+  }
+
+  return true;
+}
+
+// Full note: summary + content files. Only for the editor and notification popups.
+bool DirectoryNoteStore::read(const std::wstring& id, Note& out, std::wstring* errorOut) {
+  (void)errorOut;
+  out = Note{};
+  NoteSummary summary;
+  if (!readSummary(id, summary)) {
+    return false;
+  }
+  applySummary(out, summary);
+  const fs::path dir = noteDir(id);
+
+  // content (optional)
+  {
+    std::wstring rtf;
+    if (readContentFile(dir / L"content.rtf", &rtf)) {
+      out.contentRtf = rtf;
+    }
+    std::wstring html;
+    if (readContentFile(dir / L"content.html", &html)) {
+      out.contentHtml = html;
+    }
+    std::wstring md;
+    if (readContentFile(dir / L"content.md", &md)) {
+      out.contentMarkdown = md;
+    }
+  }
+
+  return true;
+}
+
+// Content first, meta.txt last. Each file is replaced atomically, and since a
+// directory without meta.txt is not a note, a new note only appears once complete.
+bool DirectoryNoteStore::write(const Note& n, std::wstring* errorOut) {
+  const fs::path dir = noteDir(n.id);
+  fs::create_directories(dir);
+
+  // content files: сохраняем то, что передано
+  // Important: if content becomes empty, we must clear old files, otherwise "old text comes back".
+  std::string bytes; // one buffer for all content files
+  auto writeOrDelete = [&](const fs::path& p, const std::wstring& text) -> bool {
+    if (text.empty()) {
+      FileIo::removeFile(p);
+      forgetFile(p);
+      return true;
+    }
+    Utf8::toUtf8(text, bytes);
+    return writeFileIfChanged(p, bytes, errorOut);
+  };
+
+  if (!writeOrDelete(dir / L"content.rtf", n.contentRtf)) return false;
+  if (!writeOrDelete(dir / L"content.html", n.contentHtml)) return false;
+  if (!writeOrDelete(dir / L"content.md", n.contentMarkdown)) return false;
+
+  return writeMetaFiles(dir, makeSummary(n), errorOut);
+}
+
+// Field-level updates: title.txt + meta.txt only, content files stay as they are.
+bool DirectoryNoteStore::writeSummary(const NoteSummary& summary, std::wstring* errorOut) {
+  const fs::path dir = noteDir(summary.id);
+  if (!fs::exists(FileIo::currentPath(dir / L"meta.txt"))) {
+    if (errorOut) {
+      *errorOut = L"Заметка не найдена: " + summary.id;
+    }
+    return false;
+  }
+  return writeMetaFiles(dir, summary, errorOut);
+}
+
+// Group commit: the files of the whole batch are flushed in one pass and only then
+// renamed into place. A batch that fails part way replaces nothing.
+bool DirectoryNoteStore::apply(const std::vector<NoteChange>& changes, std::wstring* errorOut) {
+  FileIo::DeferredSync sync;
+  return NoteStore::apply(changes, errorOut) && sync.commit(errorOut);
+}
+
+bool DirectoryNoteStore::remove(const std::wstring& id, std::wstring* errorOut) {
+  (void)errorOut;
+  const fs::path dir = noteDir(id);
+  if (fs::exists(dir)) {
+    fs::remove_all(dir);
+  }
+  for (const wchar_t* name : { L"title.txt", L"meta.txt", L"content.rtf", L"content.html", L"content.md" }) {
+    forgetFile(dir / name);
+  }
+  return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "model/NoteStore.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Original on-disk layout: one directory per note under root, holding
+// title.txt, meta.txt and content.rtf/.html/.md.
+//
+// Files whose bytes would not change are not rewritten: the store remembers a
+// Hash64 and the mtime of every file it wrote (and of content files it read). A
+// different mtime means the file was touched outside the app, so it is written.
+class DirectoryNoteStore final : public NoteStore {
+public:
+  explicit DirectoryNoteStore(std::filesystem::path root);
+
+  bool loadAll(std::vector<NoteSummary>& out, std::wstring* errorOut) override;
+  bool read(const std::wstring& id, Note& out, std::wstring* errorOut) override;
+  bool write(const Note& note, std::wstring* errorOut) override;
+  bool writeSummary(const NoteSummary& summary, std::wstring* errorOut) override;
+  bool remove(const std::wstring& id, std::wstring* errorOut) override;
+  bool apply(const std::vector<NoteChange>& changes, std::wstring* errorOut) override;
+
+  // Stamp = meta.txt and title.txt mtimes (0 without meta.txt): everything a
+  // summary is read from, so out-of-band edits of either are picked up on warm
+  // start. Content files are not stamped; the snapshot holds no content, and
+  // content is always read from disk.
+  bool supportsSnapshot() const override { return true; }
+  int64_t stamp(const std::wstring& id) override;
+  bool scan(const std::unordered_map<std::wstring, StampedSummary>& known, std::vector<StampedSummary>& out,
+            std::wstring* errorOut) override;
+
+private:
+  struct FileState {
+    uint64_t hash = 0;
+    int64_t mtime = 0;
+  };
+
+  bool readSummary(const std::wstring& id, NoteSummary& out) const;
+  bool readContentFile(const std::filesystem::path& p, std::wstring* out);
+  bool writeFileIfChanged(const std::filesystem::path& p, std::string_view data, std::wstring* errorOut);
+  bool writeMetaFiles(const std::filesystem::path& dir, const NoteSummary& n, std::wstring* errorOut);
+  void forgetFile(const std::filesystem::path& p);
+  std::filesystem::path noteDir(const std::wstring& id) const { return m_root / id; }
+
+  std::filesystem::path m_root;
+
+  std::mutex m_filesMutex; // writes may come from the storage worker
+  std::unordered_map<std::wstring, FileState> m_files; // by full path
+};
@@ -0,0 +1,134 @@
+#include "IndexSnapshot.h"
+
+#include "core/Crc32.h"
+#include "core/FileIo.h"
+#include "core/MappedFile.h"
+#include "core/Utf8.h"
+#include "model/NoteBinary.h"
+#include "model/NoteSchema.h"
+
+#include <cstring>
+
+namespace {
+constexpr char kMagic[8] = { 'A', 'C', 'N', 'S', 'N', 'A', 'P', '1' };
+// 1: variable-length NoteBinary entries; 2: fixed-size records + string heap.
+constexpr uint32_t kVersion = 2;
+constexpr size_t kHeaderSize = sizeof(kMagic) + 16;
+constexpr size_t kTrailerSize = 4;
+
+constexpr size_t countFields(NoteSchema::Wire wire) {
+  size_t n = 0;
+  NoteSchema::forEach([&](const auto& field) {
+    if (NoteSchema::wireOf<decltype(field)> == wire) ++n;
+  });
+  return n;
+}
+
+// stamp | I64 fields | I32 fields | id offset, id size | title offset, title size
+constexpr size_t kRecordSize =
+    8 + 8 * countFields(NoteSchema::Wire::I64) + 4 * countFields(NoteSchema::Wire::I32) + 16;
+static_assert(kRecordSize % 8 == 0 && kHeaderSize % 8 == 0, "records stay 8-byte aligned in the file");
+
+// Appends a string to the heap and its offset/length pair to the record.
+void putString(std::string& record, std::string& heap, const std::wstring& s) {
+  const size_t offset = heap.size();
+  Utf8::appendUtf8(s, heap);
+  NoteBinary::putU32(record, static_cast<uint32_t>(offset));
+  NoteBinary::putU32(record, static_cast<uint32_t>(heap.size() - offset));
+}
+
+bool loadString(const char* ref, std::string_view heap, std::wstring& out) {
+  const size_t offset = NoteBinary::loadU32(ref);
+  const size_t size = NoteBinary::loadU32(ref + 4);
+  if (offset > heap.size() || size > heap.size() - offset) return false;
+  Utf8::toWide(heap.substr(offset, size), out);
+  return true;
+}
+} // namespace
+
+bool IndexSnapshot::load(const std::filesystem::path& path, std::vector<StampedSummary>& out) {
+  out.clear();
+  MappedFile file;
+  if (!file.open(path) || file.size() < kHeaderSize + kTrailerSize) {
+    return false;
+  }
+
+  const char* p = file.data();
+  const size_t bodySize = file.size() - kTrailerSize;
+  if (std::memcmp(p, kMagic, sizeof(kMagic)) != 0 || NoteBinary::loadU32(p + 8) != kVersion ||
+      NoteBinary::loadU32(p + 16) != kRecordSize) {
+    return false;
+  }
+  const size_t count = NoteBinary::loadU32(p + 12);
+  const size_t heapSize = NoteBinary::loadU32(p + 20);
+  if ((bodySize - kHeaderSize) / kRecordSize < count ||
+      kHeaderSize + count * kRecordSize + heapSize != bodySize ||
+      NoteBinary::loadU32(p + bodySize) != Crc32::compute(p, bodySize)) {
+    return false;
+  }
+
+  const char* records = p + kHeaderSize;
+  const std::string_view heap(records + count * kRecordSize, heapSize);
+  out.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    const char* r = records + i * kRecordSize;
+    StampedSummary& e = out[i];
+    e.stamp = NoteBinary::loadI64(r);
+    r += 8;
+    NoteSchema::forEach([&](const auto& field) {
+      if constexpr (NoteSchema::wireOf<decltype(field)> == NoteSchema::Wire::I64) {
+        field.set(e.summary, NoteBinary::loadI64(r));
+        r += 8;
+      }
+    });
+    NoteSchema::forEach([&](const auto& field) {
+      if constexpr (NoteSchema::wireOf<decltype(field)> == NoteSchema::Wire::I32) {
+        field.set(e.summary, static_cast<int32_t>(NoteBinary::loadU32(r)));
+        r += 4;
+      }
+    });
+    if (!loadString(r, heap, e.summary.id) || !loadString(r + 8, heap, e.summary.title)) {
+      out.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IndexSnapshot::save(const std::filesystem::path& path, const std::vector<StampedSummary>& entries,
+                         std::wstring* errorOut) {
+  std::string b;
+  std::string heap;
+  b.reserve(kHeaderSize + entries.size() * kRecordSize + kTrailerSize);
+  heap.reserve(entries.size() * 48);
+  b.append(kMagic, sizeof(kMagic));
+  NoteBinary::putU32(b, kVersion);
+  NoteBinary::putU32(b, static_cast<uint32_t>(entries.size()));
+  NoteBinary::putU32(b, static_cast<uint32_t>(kRecordSize));
+  NoteBinary::putU32(b, 0); // heap size, patched below
+  for (const auto& e : entries) {
+    NoteBinary::putI64(b, e.stamp);
+    NoteSchema::forEach([&](const auto& field) {
+      if constexpr (NoteSchema::wireOf<decltype(field)> == NoteSchema::Wire::I64) {
+        NoteBinary::putI64(b, field.get(e.summary));
+      }
+    });
+    NoteSchema::forEach([&](const auto& field) {
+      if constexpr (NoteSchema::wireOf<decltype(field)> == NoteSchema::Wire::I32) {
+        NoteBinary::putU32(b, static_cast<uint32_t>(field.get(e.summary)));
+      }
+    });
+    putString(b, heap, e.summary.id);
+    putString(b, heap, e.summary.title);
+  }
+  if (heap.size() > UINT32_MAX) {
+    if (errorOut) *errorOut = L"Снимок индекса слишком велик";
+    return false;
+  }
+  std::string heapSize;
+  NoteBinary::putU32(heapSize, static_cast<uint32_t>(heap.size()));
+  b.replace(kHeaderSize - 4, 4, heapSize);
+  b += heap;
+  NoteBinary::putU32(b, Crc32::compute(b.data(), b.size()));
+  return FileIo::writeFileAtomic(path, b, errorOut);
+}
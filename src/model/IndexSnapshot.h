@@ -0,0 +1,25 @@
+#pragma once
+
+#include "model/NoteStore.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Persisted copy of the resident metadata index for warm starts.
+//
+// Layout (little-endian): 8-byte magic | u32 version | u32 count | u32 record size |
+// u32 heap size | count x fixed-size record | string heap | u32 crc32 (covers
+// everything before it). A record holds the stamp, the NoteSchema fields (64-bit
+// ones first, then 32-bit ones, each group in schema order) and offset/length
+// pairs of the UTF-8 id and title in the heap, so loading is a strided pass over
+// one contiguous array. The file is memory-mapped on load and rejected as a whole
+// if anything doesn't check out, including an older version: the store then scans
+// meta.txt and the next save writes the current layout. Stamps let the store tell
+// which entries are still current.
+class IndexSnapshot {
+public:
+  static bool load(const std::filesystem::path& path, std::vector<StampedSummary>& out);
+  static bool save(const std::filesystem::path& path, const std::vector<StampedSummary>& entries,
+                   std::wstring* errorOut);
+};
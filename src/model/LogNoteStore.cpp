@@ -0,0 +1,684 @@
+#include "LogNoteStore.h"
+
+#include "core/Crc32.h"
+#include "core/FileIo.h"
+#include "model/NoteBinary.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using NoteBinary::loadU32;
+using NoteBinary::putStr;
+using NoteBinary::putSummary;
+using NoteBinary::putU32;
+using NoteBinary::readSummary;
+using NoteBinary::Reader;
+
+namespace {
+constexpr char kFileMagic[8] = { 'A', 'C', 'N', 'L', 'O', 'G', '0', '1' };
+constexpr size_t kFileHeaderSize = sizeof(kFileMagic);
+
+constexpr uint32_t kRecordMagic = 0x52434341; // "ACCR" little-endian
+constexpr size_t kRecordHeaderSize = 16;
+constexpr uint32_t kMaxPayloadSize = 256u * 1024 * 1024;
+
+constexpr uint8_t kTypePut = 1;
+constexpr uint8_t kTypeRemove = 2;
+constexpr uint8_t kTypeMeta = 3;
+
+// Compaction starts once garbage exceeds both this floor and the live data size.
+constexpr uint64_t kCompactMinDeadBytes = 4ull * 1024 * 1024;
+
+// Empty if the payload is over kMaxPayloadSize: such a record would read as
+// damaged on the next open.
+std::string encodeRecord(uint8_t type, const std::string& payload) {
+  if (payload.size() > kMaxPayloadSize) return {};
+  std::string rec;
+  rec.reserve(kRecordHeaderSize + payload.size());
+  putU32(rec, kRecordMagic);
+  rec.push_back(static_cast<char>(type));
+  rec.append(3, '\0');
+  putU32(rec, static_cast<uint32_t>(payload.size()));
+  const uint32_t crc = Crc32::update(Crc32::compute(rec.data() + 4, 8), payload.data(), payload.size());
+  putU32(rec, crc);
+  rec += payload;
+  return rec;
+}
+
+std::string encodePut(const Note& n) {
+  std::string p;
+  p.reserve(256 + (n.contentRtf.size() + n.contentHtml.size() + n.contentMarkdown.size()) * 2);
+  // summary part (decoded on cold open)
+  putSummary(p, n);
+  // content part (decoded on demand)
+  putStr(p, n.contentRtf);
+  putStr(p, n.contentHtml);
+  putStr(p, n.contentMarkdown);
+  return encodeRecord(kTypePut, p);
+}
+
+std::string encodeMeta(const NoteSummary& n) {
+  std::string p;
+  p.reserve(256);
+  putSummary(p, n);
+  return encodeRecord(kTypeMeta, p);
+}
+
+std::string encodeRemove(const std::wstring& id) {
+  std::string p;
+  putStr(p, id);
+  return encodeRecord(kTypeRemove, p);
+}
+
+// Validates the framed record at p (n bytes available) and returns its total size,
+// or 0 if it is torn/corrupted. incompleteOut tells the two apart: set if the
+// record is intact as far as it goes but runs past the n bytes (torn append).
+size_t parseRecord(const char* p, size_t n, uint8_t* typeOut, const char** payloadOut, uint32_t* payloadSizeOut,
+                   bool* incompleteOut = nullptr) {
+  if (incompleteOut) *incompleteOut = false;
+  auto incomplete = [&]() -> size_t {
+    if (incompleteOut) *incompleteOut = true;
+    return 0;
+  };
+  if (n < 4) return incomplete();
+  if (loadU32(p) != kRecordMagic) return 0;
+  if (n < kRecordHeaderSize) return incomplete();
+  const uint32_t size = loadU32(p + 8);
+  if (size > kMaxPayloadSize) return 0;
+  if (n - kRecordHeaderSize < size) return incomplete();
+  const char* payload = p + kRecordHeaderSize;
+  const uint32_t crc = Crc32::update(Crc32::compute(p + 4, 8), payload, size);
+  if (crc != loadU32(p + 12)) return 0;
+
+  *typeOut = static_cast<uint8_t>(p[4]);
+  *payloadOut = payload;
+  *payloadSizeOut = size;
+  return kRecordHeaderSize + size;
+}
+
+// Offset of the next intact record after a damaged one at from - 1, or npos.
+size_t resync(const std::string& data, size_t from) {
+  char magic[4];
+  std::memcpy(magic, &kRecordMagic, sizeof(magic)); // little-endian, as written by putU32
+  for (size_t at = data.find(magic, from, sizeof(magic)); at != std::string::npos;
+       at = data.find(magic, at + 1, sizeof(magic))) {
+    uint8_t type = 0;
+    const char* payload = nullptr;
+    uint32_t payloadSize = 0;
+    if (parseRecord(data.data() + at, data.size() - at, &type, &payload, &payloadSize) != 0) {
+      return at;
+    }
+  }
+  return std::string::npos;
+}
+
+bool tooLarge(std::wstring* errorOut, const std::wstring& id) {
+  if (errorOut) {
+    *errorOut = L"Заметка слишком большая для журнала: " + id;
+  }
+  return false;
+}
+
+fs::path compactTempPath(const fs::path& p) {
+  fs::path tmp = p;
+  tmp += L".compact";
+  return tmp;
+}
+} // namespace
+
+LogNoteStore::LogNoteStore(fs::path file) : m_path(std::move(file)) {}
+
+LogNoteStore::~LogNoteStore() {
+  if (m_compactor.joinable()) {
+    m_compactor.join();
+  }
+}
+
+bool LogNoteStore::loadAll(std::vector<NoteSummary>& out, std::wstring* errorOut) {
+  if (m_compactor.joinable()) {
+    m_compactor.join();
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_loaded = false;
+  m_openError.clear();
+  out.clear();
+  m_records.clear();
+  m_liveBytes = 0;
+  if (m_file.is_open()) {
+    m_file.close();
+  }
+
+  std::error_code ec;
+  fs::create_directories(m_path.parent_path(), ec);
+
+  // Cold open: one sequential read of the whole log.
+  std::string data;
+  {
+    std::ifstream f(m_path, std::ios::binary);
+    if (f.is_open()) {
+      f.seekg(0, std::ios::end);
+      const auto size = static_cast<size_t>(f.tellg());
+      f.seekg(0, std::ios::beg);
+      data.resize(size);
+      f.read(data.data(), static_cast<std::streamsize>(size));
+    }
+  }
+
+  if (data.size() < kFileHeaderSize || std::memcmp(data.data(), kFileMagic, kFileHeaderSize) != 0) {
+    if (!data.empty()) {
+      if (errorOut) {
+        *errorOut = L"Журнал заметок повреждён или имеет неизвестный формат: " + m_path.wstring();
+      }
+      return false;
+    }
+    std::ofstream f(m_path, std::ios::binary | std::ios::trunc);
+    f.write(kFileMagic, kFileHeaderSize);
+    if (!f) {
+      if (errorOut) {
+        *errorOut = L"Не удалось создать журнал заметок: " + m_path.wstring();
+      }
+      return false;
+    }
+    data.assign(kFileMagic, kFileHeaderSize);
+  }
+
+  std::unordered_map<std::wstring, NoteSummary> latest;
+  size_t pos = kFileHeaderSize;
+  bool torn = false;
+  while (pos < data.size()) {
+    uint8_t type = 0;
+    const char* payload = nullptr;
+    uint32_t payloadSize = 0;
+    bool incomplete = false;
+    const size_t recSize = parseRecord(data.data() + pos, data.size() - pos, &type, &payload, &payloadSize, &incomplete);
+    if (recSize == 0) {
+      // A damaged record (bad CRC or framing) inside the log: skip to the next
+      // intact one. Its bytes stay in the file; later records are still valid.
+      // Only a record that runs past the end with nothing intact after it (a
+      // damaged size field can look the same) is a torn append.
+      const size_t next = resync(data, pos + 1);
+      if (next == std::string::npos) {
+        torn = incomplete;
+        break;
+      }
+      pos = next;
+      continue;
+    }
+
+    // Records whose payload does not decode are skipped: the framing (checked by
+    // the CRC) still says where the next one starts.
+    Reader r(payload, payloadSize);
+    if (type == kTypePut) {
+      NoteSummary s;
+      if (readSummary(r, s)) {
+        auto it = m_records.find(s.id);
+        if (it != m_records.end()) {
+          m_liveBytes -= it->second.bytes();
+        }
+        m_records[s.id] = NoteRecord{ RecordRef{ pos, static_cast<uint32_t>(recSize) }, RecordRef{} };
+        m_liveBytes += recSize;
+        std::wstring id = s.id;
+        latest.insert_or_assign(std::move(id), std::move(s));
+      }
+    } else if (type == kTypeMeta) {
+      NoteSummary s;
+      if (readSummary(r, s)) {
+        auto it = m_records.find(s.id);
+        if (it != m_records.end()) {
+          m_liveBytes -= it->second.meta.size;
+          it->second.meta = RecordRef{ pos, static_cast<uint32_t>(recSize) };
+          m_liveBytes += recSize;
+          std::wstring id = s.id;
+          latest.insert_or_assign(std::move(id), std::move(s));
+        }
+      }
+    } else if (type == kTypeRemove) {
+      std::wstring id;
+      if (r.str(id)) {
+        auto it = m_records.find(id);
+        if (it != m_records.end()) {
+          m_liveBytes -= it->second.bytes();
+          m_records.erase(it);
+        }
+        latest.erase(id);
+      }
+    }
+    pos += recSize;
+  }
+
+  m_fileSize = data.size();
+  if (torn) {
+    // The last record runs past the end of the file (crash mid-append): drop it so
+    // new appends stay readable. Nothing else is ever cut off.
+    fs::resize_file(m_path, pos, ec);
+    if (!ec) m_fileSize = pos;
+  }
+
+  m_file.open(m_path, std::ios::in | std::ios::out | std::ios::binary);
+  if (!m_file.is_open()) {
+    if (errorOut) {
+      *errorOut = L"Не удалось открыть журнал заметок: " + m_path.wstring();
+    }
+    return false;
+  }
+
+  out.reserve(latest.size());
+  for (auto& [id, s] : latest) {
+    out.push_back(std::move(s));
+  }
+  m_loaded = true;
+  maybeStartCompactionLocked();
+  return true;
+}
+
+bool LogNoteStore::ensureOpenLocked(std::wstring* errorOut) {
+  if (m_loaded) {
+    return true;
+  }
+  if (errorOut) {
+    *errorOut = m_openError.empty() ? std::wstring(L"Журнал заметок не открыт.") : m_openError;
+  }
+  return false;
+}
+
+bool LogNoteStore::readRecordLocked(const RecordRef& ref, uint8_t expectedType, std::string& buf,
+                                    const char** payloadOut, uint32_t* payloadSizeOut) {
+  buf.assign(ref.size, '\0');
+  m_file.clear();
+  m_file.seekg(static_cast<std::streamoff>(ref.offset));
+  m_file.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+
+  uint8_t type = 0;
+  return m_file && parseRecord(buf.data(), buf.size(), &type, payloadOut, payloadSizeOut) != 0 &&
+         type == expectedType;
+}
+
+bool LogNoteStore::read(const std::wstring& id, Note& out, std::wstring* errorOut) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!ensureOpenLocked(errorOut)) return false;
+
+  auto it = m_records.find(id);
+  if (it == m_records.end()) {
+    return false;
+  }
+
+  auto corrupted = [&]() {
+    if (errorOut) {
+      *errorOut = L"Повреждённая запись в журнале заметок: " + id;
+    }
+    return false;
+  };
+
+  std::string buf;
+  const char* payload = nullptr;
+  uint32_t payloadSize = 0;
+  if (!readRecordLocked(it->second.put, kTypePut, buf, &payload, &payloadSize)) {
+    return corrupted();
+  }
+
+  Reader r(payload, payloadSize);
+  NoteSummary summary;
+  out = Note{};
+  if (!readSummary(r, summary) || !r.str(out.contentRtf) || !r.str(out.contentHtml) || !r.str(out.contentMarkdown)) {
+    return corrupted();
+  }
+
+  if (it->second.meta.size != 0) {
+    if (!readRecordLocked(it->second.meta, kTypeMeta, buf, &payload, &payloadSize)) {
+      return corrupted();
+    }
+    Reader mr(payload, payloadSize);
+    if (!readSummary(mr, summary)) {
+      return corrupted();
+    }
+  }
+  applySummary(out, summary);
+  it->second.contentHash = contentHash(out);
+  return true;
+}
+
+bool LogNoteStore::appendLocked(const std::string& record, uint64_t* offsetOut, std::wstring* errorOut) {
+  m_file.clear();
+  m_file.seekp(static_cast<std::streamoff>(m_fileSize));
+  m_file.write(record.data(), static_cast<std::streamsize>(record.size()));
+  m_file.flush();
+  if (!m_file) {
+    // Drop whatever part of the record made it to disk; the next open would cut it anyway.
+    m_file.clear();
+    std::error_code ec;
+    fs::resize_file(m_path, m_fileSize, ec);
+    if (errorOut) {
+      *errorOut = L"Не удалось записать в журнал заметок: " + m_path.wstring();
+    }
+    return false;
+  }
+  *offsetOut = m_fileSize;
+  m_fileSize += record.size();
+  FileIo::commit(m_path);
+  return true;
+}
+
+bool LogNoteStore::write(const Note& note, std::wstring* errorOut) {
+  const uint64_t hash = contentHash(note);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!ensureOpenLocked(errorOut)) return false;
+
+    // Content unchanged since the current Put: a Meta record is enough.
+    auto it = m_records.find(note.id);
+    if (it != m_records.end() && hash != 0 && it->second.contentHash == hash) {
+      return appendMetaLocked(it->second, makeSummary(note), errorOut);
+    }
+  }
+
+  const std::string record = encodePut(note);
+  if (record.empty()) {
+    return tooLarge(errorOut, note.id);
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!ensureOpenLocked(errorOut)) return false;
+
+  uint64_t offset = 0;
+  if (!appendLocked(record, &offset, errorOut)) {
+    return false;
+  }
+
+  auto it = m_records.find(note.id);
+  if (it != m_records.end()) {
+    m_liveBytes -= it->second.bytes();
+  }
+  m_records[note.id] = NoteRecord{ RecordRef{ offset, static_cast<uint32_t>(record.size()) }, RecordRef{}, hash };
+  m_liveBytes += record.size();
+  maybeStartCompactionLocked();
+  return true;
+}
+
+bool LogNoteStore::writeSummary(const NoteSummary& summary, std::wstring* errorOut) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!ensureOpenLocked(errorOut)) return false;
+
+  auto it = m_records.find(summary.id);
+  if (it == m_records.end()) {
+    if (errorOut) {
+      *errorOut = L"Заметка не найдена: " + summary.id;
+    }
+    return false;
+  }
+  return appendMetaLocked(it->second, summary, errorOut);
+}
+
+bool LogNoteStore::appendMetaLocked(NoteRecord& rec, const NoteSummary& summary, std::wstring* errorOut) {
+  const std::string record = encodeMeta(summary);
+  if (record.empty()) {
+    return tooLarge(errorOut, summary.id);
+  }
+  uint64_t offset = 0;
+  if (!appendLocked(record, &offset, errorOut)) {
+    return false;
+  }
+  m_liveBytes -= rec.meta.size;
+  rec.meta = RecordRef{ offset, static_cast<uint32_t>(record.size()) };
+  m_liveBytes += record.size();
+  maybeStartCompactionLocked();
+  return true;
+}
+
+bool LogNoteStore::remove(const std::wstring& id, std::wstring* errorOut) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!ensureOpenLocked(errorOut)) return false;
+
+  auto it = m_records.find(id);
+  if (it == m_records.end()) {
+    return true;
+  }
+
+  const std::string record = encodeRemove(id);
+  if (record.empty()) {
+    return tooLarge(errorOut, id);
+  }
+  uint64_t offset = 0;
+  if (!appendLocked(record, &offset, errorOut)) {
+    return false;
+  }
+  m_liveBytes -= it->second.bytes();
+  m_records.erase(it);
+  maybeStartCompactionLocked();
+  return true;
+}
+
+bool LogNoteStore::apply(const std::vector<NoteChange>& changes, std::wstring* errorOut) {
+  struct Staged {
+    uint8_t type;
+    const std::wstring* id;
+    size_t offset; // within the batch buffer
+    uint32_t size;
+    uint64_t hash; // Put: content hash, as write() keeps it
+  };
+
+  std::string batch;
+  std::vector<Staged> staged;
+  staged.reserve(changes.size());
+  for (const auto& c : changes) {
+    std::string rec;
+    Staged st{};
+    switch (c.kind) {
+      case NoteChange::Kind::Write:
+        rec = encodePut(c.note);
+        st = Staged{ kTypePut, &c.note.id, 0, 0, contentHash(c.note) };
+        break;
+      case NoteChange::Kind::WriteSummary:
+        rec = encodeMeta(c.summary);
+        st = Staged{ kTypeMeta, &c.summary.id, 0, 0, 0 };
+        break;
+      case NoteChange::Kind::Remove:
+        rec = encodeRemove(c.id);
+        st = Staged{ kTypeRemove, &c.id, 0, 0, 0 };
+        break;
+    }
+    if (rec.empty()) {
+      return tooLarge(errorOut, *st.id);
+    }
+    st.offset = batch.size();
+    st.size = static_cast<uint32_t>(rec.size());
+    batch += rec;
+    staged.push_back(st);
+  }
+  if (staged.empty()) {
+    return true;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!ensureOpenLocked(errorOut)) return false;
+
+  // Meta records only make sense on top of a Put; check before anything hits the disk.
+  {
+    std::unordered_map<std::wstring, bool> present;
+    for (const auto& st : staged) {
+      if (st.type == kTypeMeta) {
+        auto it = present.find(*st.id);
+        const bool exists = it != present.end() ? it->second : m_records.count(*st.id) != 0;
+        if (!exists) {
+          if (errorOut) {
+            *errorOut = L"Заметка не найдена: " + *st.id;
+          }
+          return false;
+        }
+      } else {
+        present[*st.id] = st.type == kTypePut;
+      }
+    }
+  }
+
+  uint64_t base = 0;
+  if (!appendLocked(batch, &base, errorOut)) {
+    return false;
+  }
+
+  for (const auto& st : staged) {
+    const RecordRef ref{ base + st.offset, st.size };
+    auto it = m_records.find(*st.id);
+    if (st.type == kTypePut) {
+      if (it != m_records.end()) {
+        m_liveBytes -= it->second.bytes();
+      }
+      m_records[*st.id] = NoteRecord{ ref, RecordRef{}, st.hash };
+      m_liveBytes += ref.size;
+    } else if (st.type == kTypeMeta) {
+      m_liveBytes -= it->second.meta.size;
+      it->second.meta = ref;
+      m_liveBytes += ref.size;
+    } else if (it != m_records.end()) {
+      m_liveBytes -= it->second.bytes();
+      m_records.erase(it);
+    }
+  }
+  maybeStartCompactionLocked();
+  return true;
+}
+
+void LogNoteStore::maybeStartCompactionLocked() {
+  const uint64_t dead = m_fileSize - kFileHeaderSize - m_liveBytes;
+  if (dead < kCompactMinDeadBytes || dead < m_liveBytes) {
+    return;
+  }
+  if (m_compacting.exchange(true)) {
+    return;
+  }
+  if (m_compactor.joinable()) {
+    m_compactor.join(); // previous run already finished (m_compacting was false)
+  }
+  m_compactor = std::thread([this]() { compact(); });
+}
+
+void LogNoteStore::compact() {
+  // 1. Snapshot live records; everything before snapshotEnd is immutable.
+  std::vector<std::pair<std::wstring, NoteRecord>> live;
+  uint64_t snapshotEnd = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    live.assign(m_records.begin(), m_records.end());
+    snapshotEnd = m_fileSize;
+  }
+  std::sort(live.begin(), live.end(), [](const auto& a, const auto& b) { return a.second.put.offset < b.second.put.offset; });
+
+  // 2. Copy them into a fresh file without holding the lock.
+  const fs::path tmpPath = compactTempPath(m_path);
+  std::unordered_map<std::wstring, NoteRecord> moved;
+  moved.reserve(live.size());
+  uint64_t pos = kFileHeaderSize;
+  std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+  bool ok = out.is_open();
+  if (ok) {
+    std::ifstream in(m_path, std::ios::binary);
+    ok = in.is_open();
+    out.write(kFileMagic, kFileHeaderSize);
+    std::string buf;
+    auto copy = [&](const RecordRef& ref) -> RecordRef {
+      buf.resize(ref.size);
+      in.seekg(static_cast<std::streamoff>(ref.offset));
+      in.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+      out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+      ok = ok && static_cast<bool>(in) && static_cast<bool>(out);
+      const RecordRef copied{ pos, ref.size };
+      pos += ref.size;
+      return copied;
+    };
+    for (const auto& [id, rec] : live) {
+      if (!ok) break;
+      NoteRecord& dst = moved[id];
+      dst.put = copy(rec.put);
+      if (rec.meta.size != 0) {
+        dst.meta = copy(rec.meta);
+      }
+    }
+  }
+
+  // 3. Under the lock: carry over records appended meanwhile, then swap files.
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ok && m_fileSize > snapshotEnd) {
+      std::string tail(static_cast<size_t>(m_fileSize - snapshotEnd), '\0');
+      m_file.clear();
+      m_file.seekg(static_cast<std::streamoff>(snapshotEnd));
+      m_file.read(tail.data(), static_cast<std::streamsize>(tail.size()));
+      ok = static_cast<bool>(m_file);
+
+      size_t p = 0;
+      while (ok && p < tail.size()) {
+        uint8_t type = 0;
+        const char* payload = nullptr;
+        uint32_t payloadSize = 0;
+        const size_t recSize = parseRecord(tail.data() + p, tail.size() - p, &type, &payload, &payloadSize);
+        Reader r(payload, payloadSize);
+        std::wstring id;
+        if (recSize == 0 || !r.str(id)) {
+          ok = false;
+          break;
+        }
+        const RecordRef ref{ pos + p, static_cast<uint32_t>(recSize) };
+        if (type == kTypePut) {
+          moved[id] = NoteRecord{ ref, RecordRef{} };
+        } else if (type == kTypeMeta) {
+          auto mit = moved.find(id);
+          if (mit != moved.end()) {
+            mit->second.meta = ref;
+          }
+        } else {
+          moved.erase(id);
+        }
+        p += recSize;
+      }
+      if (ok) {
+        out.write(tail.data(), static_cast<std::streamsize>(tail.size()));
+        pos += tail.size();
+      }
+    }
+    if (ok) {
+      out.flush();
+      ok = static_cast<bool>(out);
+    }
+    out.close();
+    // The compacted file replaces the whole log, so it must be on disk first.
+    if (ok) {
+      ok = FileIo::syncNow(tmpPath);
+    }
+
+    std::error_code ec;
+    if (ok) {
+      m_file.close();
+      fs::rename(tmpPath, m_path, ec);
+      ok = !ec;
+      m_file.open(m_path, std::ios::in | std::ios::out | std::ios::binary);
+      if (!m_file.is_open()) {
+        // Whichever file is in place now, nothing can be read from or appended to
+        // it: fail every call until the log is loaded again.
+        m_loaded = false;
+        m_openError = L"Не удалось открыть журнал заметок после уплотнения: " + m_path.wstring();
+        ok = false;
+      }
+      if (ok) {
+        // Same notes, same Puts: the content hashes still apply.
+        for (auto& [id, rec] : moved) {
+          const auto cur = m_records.find(id);
+          if (cur != m_records.end()) rec.contentHash = cur->second.contentHash;
+        }
+        m_records = std::move(moved);
+        m_fileSize = pos;
+        m_liveBytes = 0;
+        for (const auto& [id, rec] : m_records) {
+          m_liveBytes += rec.bytes();
+        }
+      }
+    }
+    if (!ok) {
+      fs::remove(tmpPath, ec);
+    }
+  }
+
+  m_compacting = false;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "model/NoteStore.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// Single-file, append-only note store.
+//
+// Layout: 8-byte file header, then framed records:
+//   u32 magic | u8 type | u8[3] reserved | u32 payloadSize | u32 crc32 | payload
+// crc32 covers type..payloadSize and the payload. A Put payload holds the summary
+// fields first and content last, so cold open decodes summaries only and keeps
+// record offsets for on-demand content reads. A Meta record carries the summary
+// fields alone and overrides the metadata of the preceding Put for that id, so
+// field-level updates (fired/dismissed/snooze) never rewrite content. A torn tail
+// record (crash during append) is dropped on open; a damaged record inside the log
+// is skipped (reading resumes at the next intact record) but left in the file.
+// Record payloads are limited to 256 MB; larger notes are rejected on write.
+// Superseded records are reclaimed by a background compaction that rewrites live
+// records into a fresh file. A write whose content matches the current Put (by
+// contentHash) is stored as a Meta record.
+class LogNoteStore final : public NoteStore {
+public:
+  explicit LogNoteStore(std::filesystem::path file);
+  ~LogNoteStore() override;
+
+  LogNoteStore(const LogNoteStore&) = delete;
+  LogNoteStore& operator=(const LogNoteStore&) = delete;
+
+  bool loadAll(std::vector<NoteSummary>& out, std::wstring* errorOut) override;
+  bool read(const std::wstring& id, Note& out, std::wstring* errorOut) override;
+  bool write(const Note& note, std::wstring* errorOut) override;
+  bool writeSummary(const NoteSummary& summary, std::wstring* errorOut) override;
+  bool remove(const std::wstring& id, std::wstring* errorOut) override;
+  // Encodes the whole batch into one append (single write + flush).
+  bool apply(const std::vector<NoteChange>& changes, std::wstring* errorOut) override;
+
+private:
+  struct RecordRef {
+    uint64_t offset = 0;
+    uint32_t size = 0; // header + payload
+  };
+
+  struct NoteRecord {
+    RecordRef put;  // summary + content
+    RecordRef meta; // latest metadata override (size 0 if none)
+    uint64_t contentHash = 0; // of the Put's content once written/read here (0 = unknown)
+    uint64_t bytes() const { return put.size + meta.size; }
+  };
+
+  bool ensureOpenLocked(std::wstring* errorOut);
+  bool appendLocked(const std::string& record, uint64_t* offsetOut, std::wstring* errorOut);
+  bool appendMetaLocked(NoteRecord& rec, const NoteSummary& summary, std::wstring* errorOut);
+  bool readRecordLocked(const RecordRef& ref, uint8_t expectedType, std::string& buf, const char** payloadOut,
+                        uint32_t* payloadSizeOut);
+  void maybeStartCompactionLocked();
+  void compact();
+
+  std::filesystem::path m_path;
+
+  std::mutex m_mutex;
+  std::fstream m_file;
+  bool m_loaded = false;
+  std::wstring m_openError; // why the log became unusable after loading (failed reopen)
+  uint64_t m_fileSize = 0;
+  uint64_t m_liveBytes = 0;
+  std::unordered_map<std::wstring, NoteRecord> m_records;
+
+  std::thread m_compactor;
+  std::atomic<bool> m_compacting{ false };
+};
@@ -0,0 +1,350 @@
+#include "MediaNoteStore.h"
+
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr std::wstring_view kPictOpen = L"{\\pict";
+constexpr std::wstring_view kRefOpen = L"{\\*\\acblob ";
+// Smaller pictures stay inline; a reference would save next to nothing.
+constexpr size_t kMinBlobBytes = 512;
+
+bool isAsciiLetter(wchar_t c) {
+  return (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z');
+}
+
+bool isRtfSpace(wchar_t c) {
+  return c == L' ' || c == L'\r' || c == L'\n' || c == L'\t';
+}
+
+int hexValue(wchar_t c) {
+  if (c >= L'0' && c <= L'9') return c - L'0';
+  if (c >= L'a' && c <= L'f') return c - L'a' + 10;
+  if (c >= L'A' && c <= L'F') return c - L'A' + 10;
+  return -1;
+}
+
+// rtf[i] == '{'; returns the index just past the matching '}' (npos if unbalanced).
+size_t skipGroup(const std::wstring& rtf, size_t i) {
+  int depth = 0;
+  for (; i < rtf.size(); ++i) {
+    const wchar_t c = rtf[i];
+    if (c == L'\\') {
+      ++i; // escaped brace/backslash, or first letter of a control word
+    } else if (c == L'{') {
+      ++depth;
+    } else if (c == L'}' && --depth == 0) {
+      return i + 1;
+    }
+  }
+  return std::wstring::npos;
+}
+
+struct Pict {
+  size_t dataBegin = 0; // hex payload [dataBegin, dataEnd), may contain whitespace
+  size_t dataEnd = 0;   // the group's closing '}'
+  const wchar_t* ext = L".bin";
+};
+
+// Parses the picture group starting at rtf[start] ("{\pict"): control words and
+// nested groups first, then the hex payload. Anything else (\bin binary data,
+// control words after the payload, no payload) is left alone.
+bool parsePict(const std::wstring& rtf, size_t start, Pict& out) {
+  size_t i = start + kPictOpen.size();
+  if (i < rtf.size() && isAsciiLetter(rtf[i])) {
+    return false; // another control word that merely starts with "pict"
+  }
+  size_t dataBegin = std::wstring::npos;
+  while (i < rtf.size()) {
+    const wchar_t c = rtf[i];
+    if (c == L'}') {
+      if (dataBegin == std::wstring::npos) return false;
+      out.dataBegin = dataBegin;
+      out.dataEnd = i;
+      return true;
+    }
+    if (dataBegin != std::wstring::npos && (c == L'{' || c == L'\\')) {
+      return false;
+    }
+    if (c == L'{') {
+      i = skipGroup(rtf, i);
+      if (i == std::wstring::npos) return false;
+    } else if (c == L'\\') {
+      size_t j = i + 1;
+      while (j < rtf.size() && isAsciiLetter(rtf[j])) ++j;
+      const std::wstring_view word(rtf.data() + i + 1, j - i - 1);
+      if (word.empty()) {
+        i = j + 1; // control symbol
+        continue;
+      }
+      if (word == L"bin") return false;
+      if (word == L"pngblip") out.ext = L".png";
+      else if (word == L"jpegblip") out.ext = L".jpg";
+      else if (word == L"emfblip") out.ext = L".emf";
+      else if (word == L"wmetafile") out.ext = L".wmf";
+      else if (word == L"dibitmap" || word == L"wbitmap") out.ext = L".bmp";
+
+      if (j < rtf.size() && rtf[j] == L'-') ++j;
+      while (j < rtf.size() && rtf[j] >= L'0' && rtf[j] <= L'9') ++j;
+      if (j < rtf.size() && rtf[j] == L' ') ++j; // delimiter belongs to the word
+      i = j;
+    } else if (hexValue(c) >= 0) {
+      if (dataBegin == std::wstring::npos) dataBegin = i;
+      ++i;
+    } else if (isRtfSpace(c)) {
+      ++i;
+    } else {
+      return false;
+    }
+  }
+  return false;
+}
+
+bool decodeHex(const std::wstring& rtf, size_t begin, size_t end, std::string& out) {
+  out.clear();
+  out.reserve((end - begin) / 2);
+  int high = -1;
+  for (size_t i = begin; i < end; ++i) {
+    const int v = hexValue(rtf[i]);
+    if (v < 0) continue; // line breaks
+    if (high < 0) {
+      high = v;
+    } else {
+      out.push_back(static_cast<char>((high << 4) | v));
+      high = -1;
+    }
+  }
+  return high < 0;
+}
+
+void appendHex(std::wstring& out, const std::string& bytes) {
+  static const wchar_t* hex = L"0123456789abcdef";
+  out.reserve(out.size() + bytes.size() * 2);
+  for (unsigned char b : bytes) {
+    out.push_back(hex[b >> 4]);
+    out.push_back(hex[b & 0xF]);
+  }
+}
+
+// Calls fn(refBegin, refEnd, key) for every {\*\acblob key} reference.
+template <class Fn>
+void forEachRef(const std::wstring& rtf, Fn&& fn) {
+  for (size_t pos = rtf.find(kRefOpen); pos != std::wstring::npos; pos = rtf.find(kRefOpen, pos + 1)) {
+    const size_t keyBegin = pos + kRefOpen.size();
+    const size_t close = rtf.find(L'}', keyBegin);
+    if (close == std::wstring::npos) return;
+    fn(pos, close + 1, rtf.substr(keyBegin, close - keyBegin));
+  }
+}
+
+std::unordered_set<std::wstring> referencedKeys(const std::wstring& rtf) {
+  std::unordered_set<std::wstring> keys;
+  forEachRef(rtf, [&](size_t, size_t, std::wstring key) { keys.insert(std::move(key)); });
+  return keys;
+}
+
+// Adds the blob keys referenced by every note in store. False if any note can't be
+// read: then no blob can be proven unused.
+bool collectRefs(NoteStore& store, std::unordered_set<std::wstring>& live) {
+  std::vector<NoteSummary> all;
+  if (!store.loadAll(all, nullptr)) {
+    return false;
+  }
+  for (const auto& summary : all) {
+    Note n;
+    if (!store.read(summary.id, n, nullptr)) {
+      return false;
+    }
+    forEachRef(n.contentRtf, [&](size_t, size_t, std::wstring key) { live.insert(std::move(key)); });
+  }
+  return true;
+}
+
+// Expands references in place; unknown/missing blobs keep their (ignorable) reference.
+void inlinePictures(Note& note, const BlobStore& blobs) {
+  if (note.contentRtf.find(kRefOpen) == std::wstring::npos) return;
+
+  std::wstring out;
+  size_t copied = 0;
+  std::string bytes;
+  forEachRef(note.contentRtf, [&](size_t begin, size_t end, const std::wstring& key) {
+    if (!blobs.get(key, bytes)) return;
+    out.append(note.contentRtf, copied, begin - copied);
+    appendHex(out, bytes);
+    copied = end;
+  });
+  if (copied == 0) return;
+  out.append(note.contentRtf, copied, std::wstring::npos);
+  note.contentRtf = std::move(out);
+}
+} // namespace
+
+MediaNoteStore::MediaNoteStore(std::unique_ptr<NoteStore> inner, fs::path mediaRoot)
+    : m_inner(std::move(inner)), m_blobs(std::move(mediaRoot)) {}
+
+bool MediaNoteStore::extractPictures(Note& note, std::unordered_set<std::wstring>& keys, std::wstring* errorOut) {
+  const std::wstring& rtf = note.contentRtf;
+  keys = referencedKeys(rtf); // pictures whose blob was missing on read stay referenced
+  if (rtf.find(kPictOpen) == std::wstring::npos) return true;
+
+  std::wstring out;
+  size_t copied = 0;
+  std::string bytes;
+  for (size_t pos = rtf.find(kPictOpen); pos != std::wstring::npos; pos = rtf.find(kPictOpen, pos + 1)) {
+    Pict pict;
+    if (!parsePict(rtf, pos, pict) || !decodeHex(rtf, pict.dataBegin, pict.dataEnd, bytes) ||
+        bytes.size() < kMinBlobBytes) {
+      continue;
+    }
+    const std::wstring key = m_blobs.put(bytes, pict.ext, errorOut);
+    if (key.empty()) {
+      return false;
+    }
+    out.append(rtf, copied, pict.dataBegin - copied);
+    out += kRefOpen;
+    out += key;
+    out += L'}';
+    copied = pict.dataEnd;
+    keys.insert(key);
+    pos = pict.dataEnd;
+  }
+  if (copied != 0) {
+    out.append(rtf, copied, std::wstring::npos);
+    note.contentRtf = std::move(out);
+  }
+  return true;
+}
+
+void MediaNoteStore::notePictures(const std::wstring& id, std::unordered_set<std::wstring>&& keys) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_noteKeys.find(id);
+  if (it != m_noteKeys.end()) {
+    for (const auto& key : it->second) {
+      if (!keys.count(key)) {
+        m_mayHaveGarbage = true;
+        break;
+      }
+    }
+    it->second = std::move(keys);
+  } else {
+    m_noteKeys.emplace(id, std::move(keys));
+  }
+}
+
+bool MediaNoteStore::loadAll(std::vector<NoteSummary>& out, std::wstring* errorOut) {
+  return m_inner->loadAll(out, errorOut);
+}
+
+bool MediaNoteStore::read(const std::wstring& id, Note& out, std::wstring* errorOut) {
+  if (!readWithoutPictures(id, out, errorOut)) {
+    return false;
+  }
+  inlinePictures(out, m_blobs);
+  return true;
+}
+
+bool MediaNoteStore::readWithoutPictures(const std::wstring& id, Note& out, std::wstring* errorOut) {
+  if (!m_inner->read(id, out, errorOut)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_noteKeys[id] = referencedKeys(out.contentRtf);
+  return true;
+}
+
+bool MediaNoteStore::write(const Note& note, std::wstring* errorOut) {
+  if (note.contentRtf.find(kPictOpen) == std::wstring::npos &&
+      note.contentRtf.find(kRefOpen) == std::wstring::npos) {
+    notePictures(note.id, {});
+    return m_inner->write(note, errorOut);
+  }
+
+  Note stored = note;
+  std::unordered_set<std::wstring> keys;
+  if (!extractPictures(stored, keys, errorOut) || !m_inner->write(stored, errorOut)) {
+    return false;
+  }
+  notePictures(note.id, std::move(keys));
+  return true;
+}
+
+bool MediaNoteStore::writeSummary(const NoteSummary& summary, std::wstring* errorOut) {
+  return m_inner->writeSummary(summary, errorOut);
+}
+
+bool MediaNoteStore::remove(const std::wstring& id, std::wstring* errorOut) {
+  if (!m_inner->remove(id, errorOut)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_noteKeys.find(id);
+  if (it == m_noteKeys.end() || !it->second.empty()) {
+    m_mayHaveGarbage = true; // unknown or had pictures
+  }
+  if (it != m_noteKeys.end()) {
+    m_noteKeys.erase(it);
+  }
+  return true;
+}
+
+bool MediaNoteStore::apply(const std::vector<NoteChange>& changes, std::wstring* errorOut) {
+  // Same batch with pictures extracted; the wrapped store keeps its single pass.
+  std::vector<NoteChange> stored = changes;
+  std::vector<std::pair<std::wstring, std::unordered_set<std::wstring>>> written;
+  bool removed = false;
+  for (auto& c : stored) {
+    if (c.kind == NoteChange::Kind::Write) {
+      std::unordered_set<std::wstring> keys;
+      if (!extractPictures(c.note, keys, errorOut)) {
+        return false;
+      }
+      written.emplace_back(c.note.id, std::move(keys));
+    } else if (c.kind == NoteChange::Kind::Remove) {
+      removed = true;
+    }
+  }
+  if (!m_inner->apply(stored, errorOut)) {
+    return false;
+  }
+
+  for (auto& [id, keys] : written) {
+    notePictures(id, std::move(keys));
+  }
+  if (removed) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& c : stored) {
+      if (c.kind == NoteChange::Kind::Remove) {
+        m_noteKeys.erase(c.id);
+      }
+    }
+    m_mayHaveGarbage = true;
+  }
+  return true;
+}
+
+bool MediaNoteStore::scan(const std::unordered_map<std::wstring, StampedSummary>& known,
+                          std::vector<StampedSummary>& out, std::wstring* errorOut) {
+  return m_inner->scan(known, out, errorOut);
+}
+
+void MediaNoteStore::collectGarbage(const std::vector<NoteStore*>& otherStores) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_mayHaveGarbage) return;
+  }
+
+  std::unordered_set<std::wstring> live;
+  if (!collectRefs(*m_inner, live)) {
+    return;
+  }
+  for (NoteStore* other : otherStores) {
+    if (!collectRefs(*other, live)) {
+      return;
+    }
+  }
+  m_blobs.sweep(live);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_mayHaveGarbage = false;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "model/BlobStore.h"
+#include "model/NoteStore.h"
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// NoteStore decorator that keeps pictures out of stored RTF.
+//
+// On write, the hex payload of every {\pict ...} group in contentRtf goes to a
+// BlobStore (deduplicated by content) and is replaced by an ignorable destination
+// {\*\acblob <key>}; the picture's size/format control words stay in place. On read
+// the references are expanded back, so callers always see self-contained RTF while
+// the wrapped store only holds text-sized content.
+class MediaNoteStore final : public NoteStore {
+public:
+  MediaNoteStore(std::unique_ptr<NoteStore> inner, std::filesystem::path mediaRoot);
+
+  bool loadAll(std::vector<NoteSummary>& out, std::wstring* errorOut) override;
+  bool read(const std::wstring& id, Note& out, std::wstring* errorOut) override;
+  bool write(const Note& note, std::wstring* errorOut) override;
+  bool writeSummary(const NoteSummary& summary, std::wstring* errorOut) override;
+  bool remove(const std::wstring& id, std::wstring* errorOut) override;
+  bool apply(const std::vector<NoteChange>& changes, std::wstring* errorOut) override;
+
+  // Like read, but picture references stay unexpanded: for callers that only want
+  // the text (search indexing), which then never touch the blob files.
+  bool readWithoutPictures(const std::wstring& id, Note& out, std::wstring* errorOut);
+
+  bool supportsSnapshot() const override { return m_inner->supportsSnapshot(); }
+  int64_t stamp(const std::wstring& id) override { return m_inner->stamp(id); }
+  bool scan(const std::unordered_map<std::wstring, StampedSummary>& known, std::vector<StampedSummary>& out,
+            std::wstring* errorOut) override;
+
+  // Deletes blobs no stored note refers to, here or in otherStores (stores sharing
+  // the media root, e.g. the inactive backend kept after a switch). Reads the
+  // (reference-only) content of every note, so it does nothing unless a note that
+  // may have had pictures was removed or saved without them since the last run.
+  // Not concurrent with writes.
+  void collectGarbage(const std::vector<NoteStore*>& otherStores = {});
+
+private:
+  bool extractPictures(Note& note, std::unordered_set<std::wstring>& keys, std::wstring* errorOut);
+  void notePictures(const std::wstring& id, std::unordered_set<std::wstring>&& keys);
+
+  std::unique_ptr<NoteStore> m_inner;
+  BlobStore m_blobs;
+
+  // Blob keys per note as last read/written here; tells whether a write or remove
+  // may have orphaned blobs.
+  std::mutex m_mutex;
+  std::unordered_map<std::wstring, std::unordered_set<std::wstring>> m_noteKeys;
+  bool m_mayHaveGarbage = false;
+};
@@ -0,0 +1,104 @@
+#include "MonthAggregates.h"
+
+#include "core/TimeUtils.h"
+#include "model/NoteIndex.h"
+
+#include <algorithm>
+#include <cwchar>
+#include <vector>
+
+namespace {
+// Cached months are tiny; the cap only guards against unbounded scrolling.
+constexpr size_t kMaxCachedMonths = 24;
+
+// Range scans are time-ordered, so the first note added to a day is its earliest one.
+void addToDay(CalendarDayMeta& d, const NoteSummary& n) {
+  d.count += 1;
+  d.maxImportance = std::max(d.maxImportance, n.importance);
+
+  // Preview: earliest scheduled time + title
+  if (d.count == 1) {
+    const int64_t minutes = TimeUtils::localTimeOfDayMs(n.scheduledAtUtcMs) / 60'000;
+    wchar_t time[8];
+    swprintf(time, 8, L"%02d:%02d", static_cast<int>(minutes / 60), static_cast<int>(minutes % 60));
+    std::wstring title = n.title.empty() ? L"(без названия)" : n.title;
+    // truncate a bit for cell
+    if (title.size() > 22) {
+      title.resize(22);
+      title += L"…";
+    }
+    d.preview = std::wstring(time) + L" " + title;
+  }
+}
+} // namespace
+
+const MonthAggregates::Month& MonthAggregates::month(const NoteIndex& index, int year, int month) {
+  const int key = monthKey(year, month);
+  auto it = m_months.find(key);
+  if (it != m_months.end()) {
+    return it->second;
+  }
+  if (m_months.size() >= kMaxCachedMonths) {
+    m_months.clear();
+  }
+
+  // Bucket the month's notes by local day in one batch over their times.
+  const auto zone = TimeUtils::localZone();
+  const int32_t firstDay = Civil::daysFromCivil(year, month, 1);
+  const int64_t from = zone->dayStartUtc(firstDay);
+  const int64_t to = zone->dayStartUtc(Civil::daysFromCivil(year, month + 1, 1));
+  m_notes.clear();
+  m_times.clear();
+  index.forRange(from, to, [&](const NoteSummary& n) {
+    m_notes.push_back(&n);
+    m_times.push_back(n.scheduledAtUtcMs);
+    return true;
+  });
+  m_days.resize(m_times.size());
+  zone->dayNumbers(m_times.data(), m_times.size(), m_days.data());
+
+  Month meta{};
+  for (size_t i = 0; i < m_notes.size(); ++i) {
+    const int32_t day = m_days[i] - firstDay + 1;
+    if (day >= 1 && day <= 31) {
+      addToDay(meta[day], *m_notes[i]);
+    }
+  }
+  return m_months.emplace(key, std::move(meta)).first->second;
+}
+
+void MonthAggregates::noteChanged(const NoteIndex& index, const NoteSummary* before, const NoteSummary* after) {
+  if (m_months.empty()) {
+    return;
+  }
+  if (before && after && before->scheduledAtUtcMs == after->scheduledAtUtcMs &&
+      before->importance == after->importance && before->title == after->title) {
+    return; // nothing shown in the cell changed (e.g. fired/dismissed flags)
+  }
+  if (before && before->scheduledAtUtcMs != 0) {
+    touchDay(index, before->scheduledAtUtcMs);
+  }
+  if (after && after->scheduledAtUtcMs != 0) {
+    touchDay(index, after->scheduledAtUtcMs);
+  }
+}
+
+void MonthAggregates::touchDay(const NoteIndex& index, int64_t atUtcMs) {
+  const Civil::Date date = TimeUtils::localDate(atUtcMs);
+  auto it = m_months.find(monthKey(date.year, date.month));
+  if (it == m_months.end()) {
+    return;
+  }
+  it->second[date.day] = buildDay(index, date.year, date.month, date.day);
+}
+
+CalendarDayMeta MonthAggregates::buildDay(const NoteIndex& index, int year, int month, int day) {
+  CalendarDayMeta d;
+  const int64_t from = TimeUtils::localMidnightToUnixMsUtc(year, month, day);
+  const int64_t to = TimeUtils::localMidnightToUnixMsUtc(year, month, day + 1);
+  index.forRange(from, to, [&](const NoteSummary& n) {
+    addToDay(d, n);
+    return true;
+  });
+  return d;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "model/CalendarDayMeta.h"
+#include "model/Note.h"
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class NoteIndex;
+
+// Calendar badges (count, max importance, preview) per local day, cached per month.
+// A month is built with one range scan the first time it is shown; afterwards a
+// note change only recomputes the day cells it left and entered.
+class MonthAggregates {
+public:
+  using Month = std::array<CalendarDayMeta, 32>; // [1..31]
+
+  void clear() { m_months.clear(); }
+  bool empty() const { return m_months.empty(); }
+
+  const Month& month(const NoteIndex& index, int year, int month);
+
+  // Call after the index was updated. before/after are the note's summaries around
+  // the change (nullptr for insert/remove). Days whose month isn't cached are skipped.
+  void noteChanged(const NoteIndex& index, const NoteSummary* before, const NoteSummary* after);
+
+private:
+  static int monthKey(int year, int month) { return year * 12 + (month - 1); }
+
+  void touchDay(const NoteIndex& index, int64_t atUtcMs);
+  static CalendarDayMeta buildDay(const NoteIndex& index, int year, int month, int day);
+
+  std::unordered_map<int, Month> m_months;
+
+  // Scratch buffers of month(), kept to reuse their capacity.
+  std::vector<const NoteSummary*> m_notes;
+  std::vector<int64_t> m_times;
+  std::vector<int32_t> m_days;
+};
@@ -1,3 +1,34 @@
 #include "Note.h"
 
+#include "core/Hash64.h"
+#include "core/PlainText.h"
+#include "model/NoteSchema.h"
 
+NoteSummary makeSummary(const Note& note) {
+  NoteSummary s;
+  s.id = note.id;
+  s.title = note.title;
+  NoteSchema::copyFields(s, note);
+  return s;
+}
+
+void applySummary(Note& note, const NoteSummary& summary) {
+  note.id = summary.id;
+  note.title = summary.title;
+  NoteSchema::copyFields(note, summary);
+}
+
+uint64_t contentHash(const Note& note) {
+  auto add = [](uint64_t seed, const std::wstring& text) {
+    return Hash64::compute(text.data(), text.size() * sizeof(wchar_t), seed);
+  };
+  uint64_t h = add(0, note.contentRtf);
+  h = add(h, note.contentHtml);
+  return add(h, note.contentMarkdown);
+}
+
+std::wstring noteText(const Note& note) {
+  if (!note.contentRtf.empty()) return PlainText::fromRtf(note.contentRtf);
+  if (!note.contentMarkdown.empty()) return PlainText::fromMarkdown(note.contentMarkdown);
+  return PlainText::fromHtml(note.contentHtml);
+}
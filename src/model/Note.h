@@ -35,3 +35,39 @@ struct Note {
 };
 
 
+
+// Metadata-only projection of a Note: everything except content.
+// Used by list/calendar/due queries, so scans never touch content.* files.
+struct NoteSummary {
+  std::wstring id;
+  std::wstring title;
+
+  int64_t scheduledAtUtcMs = 0;
+  int importance = 0;
+
+  NoteContentMode contentMode = NoteContentMode::VisualRtf;
+
+  bool autoHideEnabled = false;
+  int autoHideSeconds = 0;
+
+  bool hasFired = false;
+  int64_t firedAtUtcMs = 0;
+
+  bool dismissed = false;
+  int64_t dismissedAtUtcMs = 0;
+
+  int64_t createdAtUtcMs = 0;
+  int64_t updatedAtUtcMs = 0;
+
+  bool operator==(const NoteSummary&) const = default;
+};
+
+NoteSummary makeSummary(const Note& note);
+// Copies all metadata fields of summary into note (content is left untouched).
+void applySummary(Note& note, const NoteSummary& summary);
+// Hash64 over the content fields (rtf, html, markdown); detects saves that don't
+// change the content.
+uint64_t contentHash(const Note& note);
+// Plain text of the content the editor shows (contentRtf, else markdown, else
+// html); older formats left behind by an RTF edit are stale and not included.
+std::wstring noteText(const Note& note);
@@ -0,0 +1,81 @@
+#include "NoteBinary.h"
+
+#include "core/Utf8.h"
+
+namespace NoteBinary {
+void putU32(std::string& b, uint32_t v) {
+  for (int i = 0; i < 4; ++i) b.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+}
+
+void putI64(std::string& b, int64_t v) {
+  const auto u = static_cast<uint64_t>(v);
+  for (int i = 0; i < 8; ++i) b.push_back(static_cast<char>((u >> (8 * i)) & 0xFF));
+}
+
+void putStr(std::string& b, const std::wstring& s) {
+  const size_t lengthAt = b.size();
+  putU32(b, 0);
+  Utf8::appendUtf8(s, b);
+  const auto n = static_cast<uint32_t>(b.size() - lengthAt - 4);
+  for (int i = 0; i < 4; ++i) b[lengthAt + i] = static_cast<char>((n >> (8 * i)) & 0xFF);
+}
+
+uint32_t loadU32(const char* p) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+  return v;
+}
+
+int64_t loadI64(const char* p) {
+  uint64_t u = 0;
+  for (int i = 0; i < 8; ++i) u |= static_cast<uint64_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+  return static_cast<int64_t>(u);
+}
+
+bool Reader::u32(uint32_t& v) {
+  if (m_end - m_p < 4) return false;
+  v = loadU32(m_p);
+  m_p += 4;
+  return true;
+}
+
+bool Reader::i32(int& v) {
+  uint32_t u = 0;
+  if (!u32(u)) return false;
+  v = static_cast<int>(u);
+  return true;
+}
+
+bool Reader::i64(int64_t& v) {
+  if (m_end - m_p < 8) return false;
+  v = loadI64(m_p);
+  m_p += 8;
+  return true;
+}
+
+bool Reader::str(std::wstring& s) {
+  uint32_t n = 0;
+  if (!u32(n) || static_cast<size_t>(m_end - m_p) < n) return false;
+  Utf8::toWide(std::string_view(m_p, n), s);
+  m_p += n;
+  return true;
+}
+
+bool readSummary(Reader& r, NoteSummary& out) {
+  out = NoteSummary{};
+  bool ok = r.str(out.id) && r.str(out.title);
+  NoteSchema::forEach([&](const auto& field) {
+    if (!ok) return;
+    if constexpr (NoteSchema::wireOf<decltype(field)> == NoteSchema::Wire::I64) {
+      int64_t v = 0;
+      ok = r.i64(v);
+      field.set(out, v);
+    } else {
+      int v = 0;
+      ok = r.i32(v);
+      field.set(out, v);
+    }
+  });
+  return ok;
+}
+}
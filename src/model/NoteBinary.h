@@ -0,0 +1,52 @@
+#pragma once
+
+#include "model/Note.h"
+#include "model/NoteSchema.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Little-endian binary encoding of note metadata, shared by the log store and the
+// index snapshot. Strings are u32 byte length + UTF-8.
+namespace NoteBinary {
+void putU32(std::string& b, uint32_t v);
+void putI64(std::string& b, int64_t v);
+void putStr(std::string& b, const std::wstring& s);
+
+uint32_t loadU32(const char* p);
+int64_t loadI64(const char* p);
+
+// id, title, then the NoteSchema fields in order; T is Note or NoteSummary.
+template <class T>
+void putSummary(std::string& b, const T& n) {
+  putStr(b, n.id);
+  putStr(b, n.title);
+  NoteSchema::forEach([&](const auto& field) {
+    if constexpr (NoteSchema::wireOf<decltype(field)> == NoteSchema::Wire::I64) {
+      putI64(b, field.get(n));
+    } else {
+      putU32(b, static_cast<uint32_t>(field.get(n)));
+    }
+  });
+}
+
+// Bounds-checked cursor; every getter returns false once the input runs out.
+class Reader {
+public:
+  Reader(const char* p, size_t n) : m_p(p), m_end(p + n) {}
+
+  bool u32(uint32_t& v);
+  bool i32(int& v);
+  bool i64(int64_t& v);
+  bool str(std::wstring& s);
+
+  size_t remaining() const { return static_cast<size_t>(m_end - m_p); }
+
+private:
+  const char* m_p;
+  const char* m_end;
+};
+
+bool readSummary(Reader& r, NoteSummary& out);
+}
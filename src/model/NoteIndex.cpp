@@ -0,0 +1,42 @@
+#include "NoteIndex.h"
+
+#include <utility>
+
+void NoteIndex::clear() {
+  m_byId.clear();
+  m_byTime.clear();
+}
+
+void NoteIndex::put(NoteSummary summary) {
+  auto it = m_byId.find(summary.id);
+  if (it != m_byId.end()) {
+    if (it->second.scheduledAtUtcMs != summary.scheduledAtUtcMs) {
+      if (it->second.scheduledAtUtcMs != 0) m_byTime.erase(it->second.scheduledAtUtcMs, summary.id);
+      if (summary.scheduledAtUtcMs != 0) m_byTime.insert(summary.scheduledAtUtcMs, summary.id);
+    }
+    it->second = std::move(summary);
+    return;
+  }
+
+  if (summary.scheduledAtUtcMs != 0) {
+    m_byTime.insert(summary.scheduledAtUtcMs, summary.id);
+  }
+  std::wstring id = summary.id;
+  m_byId.emplace(std::move(id), std::move(summary));
+}
+
+void NoteIndex::erase(const std::wstring& id) {
+  auto it = m_byId.find(id);
+  if (it == m_byId.end()) {
+    return;
+  }
+  if (it->second.scheduledAtUtcMs != 0) {
+    m_byTime.erase(it->second.scheduledAtUtcMs, id);
+  }
+  m_byId.erase(it);
+}
+
+const NoteSummary* NoteIndex::find(const std::wstring& id) const {
+  auto it = m_byId.find(id);
+  return it == m_byId.end() ? nullptr : &it->second;
+}
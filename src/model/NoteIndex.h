@@ -0,0 +1,44 @@
+#pragma once
+
+#include "model/Note.h"
+#include "model/NoteTimeIndex.h"
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+// Resident metadata (NoteSummary) of all stored notes.
+// Loaded once from disk by NoteRepository and kept in sync by its write paths,
+// so list/calendar/due queries don't have to walk the notes directory.
+class NoteIndex {
+public:
+  void clear();
+
+  // Inserts or replaces the entry for summary.id.
+  void put(NoteSummary summary);
+  void erase(const std::wstring& id);
+
+  const NoteSummary* find(const std::wstring& id) const;
+  size_t size() const { return m_byId.size(); }
+
+  template <class Fn>
+  void forEach(Fn&& fn) const {
+    for (const auto& [id, n] : m_byId) {
+      fn(n);
+    }
+  }
+
+  // Scheduled notes with fromUtcMs <= scheduledAtUtcMs < toUtcMs, earliest first.
+  // fn(const NoteSummary&) returns false to stop early.
+  template <class Fn>
+  void forRange(int64_t fromUtcMs, int64_t toUtcMs, Fn&& fn) const {
+    m_byTime.forRange(fromUtcMs, toUtcMs, [&](int64_t, const std::wstring& id) {
+      const NoteSummary* n = find(id);
+      return n ? fn(*n) : true;
+    });
+  }
+
+private:
+  std::unordered_map<std::wstring, NoteSummary> m_byId;
+  NoteTimeIndex m_byTime; // notes with scheduledAtUtcMs != 0
+};
@@ -0,0 +1,228 @@
+#include "NoteJson.h"
+
+#include "core/Utf8.h"
+#include "model/NoteSchema.h"
+
+#include <charconv>
+#include <cstdint>
+
+namespace {
+void appendKey(std::string& out, std::string_view key) {
+  out += '"';
+  out += key;
+  out += "\":";
+}
+
+void appendString(std::string& out, const std::wstring& s) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  out += '"';
+  size_t run = 0; // start of the pending run that needs no escaping
+  for (size_t i = 0; i < s.size(); ++i) {
+    const wchar_t c = s[i];
+    if (c >= 0x20 && c != L'"' && c != L'\\') continue;
+    Utf8::appendUtf8(std::wstring_view(s).substr(run, i - run), out);
+    run = i + 1;
+    switch (c) {
+      case L'"': out += "\\\""; break;
+      case L'\\': out += "\\\\"; break;
+      case L'\n': out += "\\n"; break;
+      case L'\r': out += "\\r"; break;
+      case L'\t': out += "\\t"; break;
+      default:
+        out += "\\u00";
+        out += kHex[(c >> 4) & 0xF];
+        out += kHex[c & 0xF];
+        break;
+    }
+  }
+  Utf8::appendUtf8(std::wstring_view(s).substr(run), out);
+  out += '"';
+}
+
+void appendInt(std::string& out, int64_t v) {
+  char buf[24];
+  out.append(buf, std::to_chars(buf, buf + sizeof buf, v).ptr);
+}
+
+int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+class Parser {
+public:
+  explicit Parser(std::string_view json) : m_p(json.data()), m_end(json.data() + json.size()) {}
+
+  bool object(NoteSummary& out) {
+    if (!consume('{')) return false;
+    if (consume('}')) return atEnd();
+    do {
+      std::string_view key;
+      if (!rawString(key) || !consume(':')) return false;
+      if (key == "id" || key == "title") {
+        if (!string(key == "id" ? out.id : out.title)) return false;
+      } else {
+        bool ok = true;
+        const bool known = NoteSchema::findIf([&](const auto& field) {
+          if (field.key != key) return false;
+          int64_t v = 0;
+          ok = integer(v);
+          field.set(out, v);
+          return true;
+        });
+        if (!ok || (!known && !skipValue(0))) return false;
+      }
+    } while (consume(','));
+    return consume('}') && atEnd();
+  }
+
+private:
+  void skipSpace() {
+    while (m_p < m_end && (*m_p == ' ' || *m_p == '\t' || *m_p == '\n' || *m_p == '\r')) ++m_p;
+  }
+
+  bool consume(char c) {
+    skipSpace();
+    if (m_p == m_end || *m_p != c) return false;
+    ++m_p;
+    return true;
+  }
+
+  bool atEnd() {
+    skipSpace();
+    return m_p == m_end;
+  }
+
+  // A string token as it appears in the input (escapes not decoded): keys are
+  // compared raw, which is exact for the plain ASCII keys this format uses.
+  bool rawString(std::string_view& s) {
+    if (!consume('"')) return false;
+    const char* begin = m_p;
+    while (m_p < m_end && *m_p != '"') {
+      if (*m_p == '\\' && ++m_p == m_end) return false;
+      ++m_p;
+    }
+    if (m_p == m_end) return false;
+    s = std::string_view(begin, static_cast<size_t>(m_p - begin));
+    ++m_p;
+    return true;
+  }
+
+  bool string(std::wstring& out) {
+    std::string_view raw;
+    if (!rawString(raw)) return false;
+    out.clear();
+    size_t run = 0;
+    for (size_t i = 0; i < raw.size(); ++i) {
+      if (raw[i] != '\\') continue;
+      Utf8::appendWide(raw.substr(run, i - run), out);
+      const char e = raw[++i];
+      switch (e) {
+        case '"': case '\\': case '/': out += static_cast<wchar_t>(e); break;
+        case 'b': out += L'\b'; break;
+        case 'f': out += L'\f'; break;
+        case 'n': out += L'\n'; break;
+        case 'r': out += L'\r'; break;
+        case 't': out += L'\t'; break;
+        case 'u': {
+          if (raw.size() - i < 5) return false;
+          unsigned unit = 0;
+          for (size_t k = 1; k <= 4; ++k) {
+            const int h = hexValue(raw[i + k]);
+            if (h < 0) return false;
+            unit = (unit << 4) | static_cast<unsigned>(h);
+          }
+          i += 4;
+          if constexpr (sizeof(wchar_t) == 4) {
+            // join a surrogate pair written as two escapes
+            if (unit >= 0xDC00 && unit <= 0xDFFF && !out.empty() && out.back() >= 0xD800 && out.back() <= 0xDBFF) {
+              out.back() = static_cast<wchar_t>(0x10000 + ((out.back() - 0xD800) << 10) + (unit - 0xDC00));
+              break;
+            }
+          }
+          out += static_cast<wchar_t>(unit);
+          break;
+        }
+        default:
+          return false;
+      }
+      run = i + 1;
+    }
+    Utf8::appendWide(raw.substr(run), out);
+    return true;
+  }
+
+  bool integer(int64_t& v) {
+    skipSpace();
+    const auto [ptr, ec] = std::from_chars(m_p, m_end, v);
+    if (ec != std::errc{}) return false;
+    m_p = ptr;
+    return m_p == m_end || (*m_p != '.' && *m_p != 'e' && *m_p != 'E');
+  }
+
+  bool literal(std::string_view word) {
+    if (static_cast<size_t>(m_end - m_p) < word.size() || std::string_view(m_p, word.size()) != word) return false;
+    m_p += word.size();
+    return true;
+  }
+
+  bool skipValue(int depth) {
+    if (depth > 64) return false;
+    skipSpace();
+    if (m_p == m_end) return false;
+    std::string_view s;
+    switch (*m_p) {
+      case '"':
+        return rawString(s);
+      case '{':
+      case '[': {
+        const char close = *m_p == '{' ? '}' : ']';
+        ++m_p;
+        if (consume(close)) return true;
+        do {
+          if (close == '}' && (!rawString(s) || !consume(':'))) return false;
+          if (!skipValue(depth + 1)) return false;
+        } while (consume(','));
+        return consume(close);
+      }
+      case 't': return literal("true");
+      case 'f': return literal("false");
+      case 'n': return literal("null");
+      default: {
+        double d = 0;
+        const auto [ptr, ec] = std::from_chars(m_p, m_end, d);
+        if (ec != std::errc{}) return false;
+        m_p = ptr;
+        return true;
+      }
+    }
+  }
+
+  const char* m_p;
+  const char* m_end;
+};
+} // namespace
+
+namespace NoteJson {
+void append(std::string& out, const NoteSummary& n) {
+  out += '{';
+  appendKey(out, "id");
+  appendString(out, n.id);
+  out += ',';
+  appendKey(out, "title");
+  appendString(out, n.title);
+  NoteSchema::forEach([&](const auto& field) {
+    out += ',';
+    appendKey(out, field.key);
+    appendInt(out, field.get(n));
+  });
+  out += '}';
+}
+
+bool parse(std::string_view json, NoteSummary& out) {
+  out = NoteSummary{};
+  return Parser(json).object(out);
+}
+}
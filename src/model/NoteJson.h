@@ -0,0 +1,18 @@
+#pragma once
+
+#include "model/Note.h"
+
+#include <string>
+#include <string_view>
+
+// JSON form of note metadata, for export and tooling (storage keeps meta.txt and
+// the binary record): {"id":"…","title":"…","scheduledAtUtcMs":…, …} with every
+// NoteSchema field as an integer, in schema order.
+namespace NoteJson {
+// Appends the object to out (UTF-8).
+void append(std::string& out, const NoteSummary& n);
+
+// Reads one object: keys in any order, unknown keys (of any JSON type) skipped,
+// missing fields left at 0. False on malformed JSON or a non-integer field value.
+bool parse(std::string_view json, NoteSummary& out);
+}
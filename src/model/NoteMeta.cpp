@@ -0,0 +1,65 @@
+#include "NoteMeta.h"
+
+#include "model/NoteSchema.h"
+
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+constexpr size_t maxFormattedSize() {
+  size_t n = 0;
+  NoteSchema::forEach([&](const auto& field) { n += field.key.size() + 1 + 20 + 1; }); // key=-9223372036854775808\n
+  return n;
+}
+static_assert(maxFormattedSize() <= NoteMeta::kMaxSize);
+
+// Same leniency as the std::stoll it replaces: leading whitespace and '+' are
+// accepted and trailing garbage ("12\r", "5s") is ignored. Values of 32-bit
+// fields outside the int range read as 0, like std::stoi failing.
+int64_t parseValue(const char* p, const char* end, NoteSchema::Wire wire) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\v' || *p == '\f')) ++p;
+  if (p < end && *p == '+') {
+    ++p;
+    if (p < end && *p == '-') return 0;
+  }
+  int64_t v = 0;
+  if (std::from_chars(p, end, v).ec != std::errc{}) return 0;
+  if (wire == NoteSchema::Wire::I32 && (v < INT_MIN || v > INT_MAX)) return 0;
+  return v;
+}
+} // namespace
+
+namespace NoteMeta {
+void parse(std::string_view text, NoteSummary& out) {
+  NoteSchema::forEach([&](const auto& field) { field.set(out, 0); });
+  const char* p = text.data();
+  const char* const end = p + text.size();
+  while (p < end) {
+    const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+    if (!eol) eol = end;
+    if (const char* eq = static_cast<const char*>(std::memchr(p, '=', static_cast<size_t>(eol - p)))) {
+      const std::string_view key(p, static_cast<size_t>(eq - p));
+      NoteSchema::findIf([&](const auto& field) {
+        if (field.key != key) return false;
+        field.set(out, parseValue(eq + 1, eol, NoteSchema::wireOf<decltype(field)>));
+        return true;
+      });
+    }
+    p = eol + (eol < end ? 1 : 0);
+  }
+}
+
+size_t format(const NoteSummary& n, char* out) {
+  char* p = out;
+  NoteSchema::forEach([&](const auto& field) {
+    std::memcpy(p, field.key.data(), field.key.size());
+    p += field.key.size();
+    *p++ = '=';
+    p = std::to_chars(p, out + kMaxSize, field.get(n)).ptr;
+    *p++ = '\n';
+  });
+  return static_cast<size_t>(p - out);
+}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "model/Note.h"
+
+#include <cstddef>
+#include <string_view>
+
+// meta.txt of the directory store: "key=value" lines with integer values, one per
+// NoteSchema field. Parsed and formatted in one pass without allocating; files
+// written by earlier versions (any key order, unknown keys, CRLF, blank or
+// malformed values) read as before.
+namespace NoteMeta {
+// Enough for format() of any summary.
+constexpr size_t kMaxSize = 384;
+
+// Fills the metadata fields of out (not id and title). Missing keys and values
+// that are not a number in range read as 0; of duplicate keys the last one wins.
+void parse(std::string_view text, NoteSummary& out);
+
+// Writes the file into out (at least kMaxSize bytes) and returns its length.
+size_t format(const NoteSummary& n, char* out);
+}
@@ -1,226 +1,690 @@
 #include "NoteRepository.h"
 
 #include "app/AppPaths.h"
+#include "core/FileIo.h"
 #include "core/TimeUtils.h"
+#include "model/DirectoryNoteStore.h"
+#include "model/IndexSnapshot.h"
+#include "model/LogNoteStore.h"
+#include "model/MediaNoteStore.h"
+#include "model/MonthAggregates.h"
+#include "model/NoteIndex.h"
+#include "model/NoteSchema.h"
+#include "model/ReminderQueue.h"
+#include "model/SearchIndex.h"
+#include "model/StorageWorker.h"
+#include "core/Utf8.h"
+
+#ifdef _WIN32
 #include "win/WinUtil.h"
+#endif
 
 #include <algorithm>
+#include <atomic>
 #include <filesystem>
-#include <fstream>
-#include <sstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace fs = std::filesystem;
 
 namespace {
-fs::path noteDirNoCreate(const std::wstring& id) {
-  return AppPaths::notesRootDir() / id;
+struct RepoState {
+  std::unique_ptr<MediaNoteStore> store; // backend behind the picture blob layer
+  NoteStorageKind kind = NoteStorageKind::Directory;
+  NoteIndex index;
+  ReminderQueue reminders;
+  MonthAggregates months; // calendar badges, derived from index
+  bool loaded = false;
+
+  // Warm start (stores with supportsSnapshot): stamps of notes unchanged since they
+  // were last scanned. Written notes drop out and are re-stamped when saving.
+  std::unordered_map<std::wstring, int64_t> stamps;
+
+  // contentHash of each note as last written or read in this session, so an
+  // autosave that changes nothing is dropped before it reaches the store.
+  std::unordered_map<std::wstring, uint64_t> contentHashes;
+
+  // Background reconcile of a snapshot-loaded index. The worker only touches the
+  // reconcile* fields (under reconcileMutex); the index stays on the UI thread.
+  std::thread reconciler;
+  bool reconciling = false;
+  std::unordered_set<std::wstring> touched; // written while reconciling: keep ours
+  std::mutex reconcileMutex;
+  bool reconcileDone = false;
+  bool reconcileOk = false;
+  std::vector<StampedSummary> reconciled;
+
+  // Saves queued by upsertAsync. pending holds the newest queued snapshot per note
+  // until its write is dispatched, so reads see it and sync writes know to wait.
+  struct PendingSave {
+    uint64_t seq = 0;
+    std::shared_ptr<const Note> note;
+  };
+  std::unique_ptr<StorageWorker> writer;
+  std::unordered_map<std::wstring, PendingSave> pending;
+  std::unordered_map<uint64_t, NoteRepository::SaveCallback> saveCallbacks;
+
+  // Full-text index, built by a background pass over all note content on the first
+  // search() and kept current by the write paths from then on. The builder shares
+  // it under searchMutex; searchStarted and the thread handle stay on the UI thread.
+  bool searchStarted = false;
+  std::thread searchBuilder;
+  std::atomic<bool> searchCancel{ false };
+  std::mutex searchMutex;
+  SearchIndex search;
+  bool searchBuilding = false;
+  std::unordered_set<std::wstring> searchTouched; // written while building: keep ours
+};
+
+RepoState& repoState() {
+  static RepoState s;
+  return s;
 }
 
-fs::path metaPath(const std::wstring& id) {
-  return noteDirNoCreate(id) / L"meta.txt";
+std::function<void()>& remindersChangedHandler() {
+  static std::function<void()> handler;
+  return handler;
 }
 
-fs::path titlePath(const std::wstring& id) {
-  return noteDirNoCreate(id) / L"title.txt";
+void notifyRemindersChanged() {
+  const auto& handler = remindersChangedHandler();
+  if (handler) {
+    handler();
+  }
 }
 
-fs::path contentRtfPath(const std::wstring& id) {
-  return noteDirNoCreate(id) / L"content.rtf";
+// Set on the UI thread, invoked from the reconcile worker.
+std::mutex& indexChangedMutex() {
+  static std::mutex m;
+  return m;
 }
 
-fs::path contentHtmlPath(const std::wstring& id) {
-  return noteDirNoCreate(id) / L"content.html";
+std::function<void()>& indexChangedHandler() {
+  static std::function<void()> handler;
+  return handler;
 }
 
-fs::path contentMdPath(const std::wstring& id) {
-  return noteDirNoCreate(id) / L"content.md";
+void notifyIndexChanged() {
+  std::lock_guard<std::mutex> lock(indexChangedMutex());
+  if (indexChangedHandler()) {
+    indexChangedHandler()();
+  }
 }
 
-bool readFileUtf8(const fs::path& p, std::wstring* out, std::wstring* errorOut) {
-  (void)errorOut;
-  out->clear();
-  std::ifstream f(p, std::ios::binary);
-  if (!f.is_open()) {
-    return false;
+// Set on the UI thread, invoked from the storage worker.
+std::mutex& writesCompletedMutex() {
+  static std::mutex m;
+  return m;
+}
+
+std::function<void()>& writesCompletedHandler() {
+  static std::function<void()> handler;
+  return handler;
+}
+
+void notifyWritesCompleted() {
+  std::lock_guard<std::mutex> lock(writesCompletedMutex());
+  if (writesCompletedHandler()) {
+    writesCompletedHandler()();
   }
-  std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
-  *out = WinUtil::fromUtf8(data);
-  return true;
 }
 
-bool writeFileUtf8(const fs::path& p, const std::wstring& text, std::wstring* errorOut) {
-  std::ofstream f(p, std::ios::binary | std::ios::trunc);
-  if (!f.is_open()) {
-    if (errorOut) {
-      *errorOut = L"Не удалось открыть файл для записи: " + p.wstring();
-    }
-    return false;
+// A synchronous write must not be overtaken by an older queued save of the same note.
+// Once drained, the queued snapshot is on disk (or failed) and the write that
+// follows supersedes it, so reads go to the store again. Its content hash is
+// forgotten: the sync write sets it again if it succeeds.
+void waitForQueuedSave(RepoState& s, const std::wstring& id) {
+  const auto queued = s.pending.find(id);
+  if (s.writer && queued != s.pending.end()) {
+    s.writer->drain();
+    s.pending.erase(queued);
+    s.contentHashes.erase(id);
   }
-  const std::string data = WinUtil::toUtf8(text);
-  f.write(data.data(), static_cast<std::streamsize>(data.size()));
-  return true;
 }
 
-std::unordered_map<std::string, std::string> parseMeta(const std::string& meta) {
-  std::unordered_map<std::string, std::string> m;
-  std::istringstream ss(meta);
-  std::string line;
-  while (std::getline(ss, line)) {
-    if (line.empty()) continue;
-    const auto pos = line.find('=');
-    if (pos == std::string::npos) continue;
-    const std::string key = line.substr(0, pos);
-    const std::string val = line.substr(pos + 1);
-    m[key] = val;
+// Writes out everything queued and drops undelivered completions.
+void stopWriter(RepoState& s) {
+  s.writer.reset();
+  s.pending.clear();
+  s.saveCallbacks.clear();
+}
+
+// Full-text index updates from the write paths (nothing to do before the first search).
+void searchPut(RepoState& s, const Note& note) {
+  if (!s.searchStarted) return;
+  const std::wstring text = noteText(note);
+  std::lock_guard<std::mutex> lock(s.searchMutex);
+  s.search.put(note.id, note.title, text);
+  if (s.searchBuilding) {
+    s.searchTouched.insert(note.id);
   }
-  return m;
 }
 
-bool readMeta(const std::wstring& id, Note& out, std::wstring* errorOut) {
-  (void)errorOut;
-  out = Note{};
-  out.id = id;
+void searchErase(RepoState& s, const std::wstring& id) {
+  if (!s.searchStarted) return;
+  std::lock_guard<std::mutex> lock(s.searchMutex);
+  s.search.erase(id);
+  if (s.searchBuilding) {
+    s.searchTouched.insert(id);
+  }
+}
 
-  // title
-  {
-    std::wstring title;
-    readFileUtf8(titlePath(id), &title, nullptr);
-    out.title = title;
+// Drops the full-text index; the next search() builds it again.
+void resetSearch(RepoState& s) {
+  if (s.searchBuilder.joinable()) {
+    s.searchCancel = true;
+    s.searchBuilder.join();
   }
+  s.searchCancel = false;
+  s.searchStarted = false;
+  std::lock_guard<std::mutex> lock(s.searchMutex);
+  s.search.clear();
+  s.searchBuilding = false;
+  s.searchTouched.clear();
+}
 
-  // meta
-  std::ifstream f(metaPath(id), std::ios::binary);
-  if (!f.is_open()) {
-    // treat missing meta as missing note
-    return false;
+void startSearchBuild(RepoState& s) {
+  std::vector<std::wstring> ids;
+  ids.reserve(s.index.size());
+  s.index.forEach([&](const NoteSummary& n) { ids.push_back(n.id); });
+  {
+    std::lock_guard<std::mutex> lock(s.searchMutex);
+    s.searchBuilding = true;
+  }
+  s.searchStarted = true;
+  for (const auto& [id, queued] : s.pending) {
+    searchPut(s, *queued.note); // not on disk yet
   }
-  const std::string meta((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
-  const auto m = parseMeta(meta);
 
-  auto getI64 = [&](const char* key, int64_t def = 0) -> int64_t {
-    auto it = m.find(key);
-    if (it == m.end() || it->second.empty()) return def;
-    try { return std::stoll(it->second); } catch (...) { return def; }
-  };
+  MediaNoteStore* store = s.store.get();
+  s.searchBuilder = std::thread([&s, store, ids = std::move(ids)]() {
+    for (const auto& id : ids) {
+      if (s.searchCancel) return;
+      Note n;
+      if (!store->readWithoutPictures(id, n, nullptr)) continue;
+      const std::wstring text = noteText(n);
+      std::lock_guard<std::mutex> lock(s.searchMutex);
+      if (!s.searchTouched.count(id)) {
+        s.search.put(id, n.title, text);
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(s.searchMutex);
+      s.searchBuilding = false;
+      s.searchTouched.clear();
+    }
+    notifyIndexChanged();
+  });
+}
 
-  auto getI = [&](const char* key, int def = 0) -> int {
-    auto it = m.find(key);
-    if (it == m.end() || it->second.empty()) return def;
-    try { return std::stoi(it->second); } catch (...) { return def; }
-  };
+void populate(RepoState& s, std::vector<StampedSummary>&& entries) {
+  s.index.clear();
+  s.reminders.clear();
+  s.months.clear();
+  s.contentHashes.clear();
+  s.stamps.clear();
+  s.stamps.reserve(entries.size());
+  for (auto& e : entries) {
+    s.stamps[e.summary.id] = e.stamp;
+    s.reminders.track(e.summary);
+    s.index.put(std::move(e.summary));
+  }
+}
 
-  out.scheduledAtUtcMs = getI64("scheduledAtUtcMs", 0);
-  out.importance = getI("importance", 0);
-  out.contentMode = static_cast<NoteContentMode>(getI("contentMode", 0));
-  out.autoHideEnabled = getI("autoHideEnabled", 0) != 0;
-  out.autoHideSeconds = getI("autoHideSeconds", 0);
+// Folds a finished background scan into the index: notes written since the scan
+// started keep their in-memory version, everything else follows the disk.
+void applyReconciled(RepoState& s) {
+  std::vector<StampedSummary> fresh;
+  {
+    std::lock_guard<std::mutex> lock(s.reconcileMutex);
+    if (!s.reconcileDone) return;
+    s.reconcileDone = false;
+    if (s.reconcileOk) {
+      fresh.swap(s.reconciled);
+    }
+  }
+  if (s.reconciler.joinable()) {
+    s.reconciler.join();
+  }
 
-  const int64_t fired = getI64("firedAtUtcMs", 0);
-  if (fired != 0) {
-    out.hasFired = true;
-    out.firedAtUtcMs = fired;
+  bool remindersChanged = false;
+  bool contentChanged = false;
+  if (s.reconcileOk) {
+    std::unordered_set<std::wstring> seen;
+    seen.reserve(fresh.size());
+    for (auto& e : fresh) {
+      seen.insert(e.summary.id);
+      if (s.touched.count(e.summary.id)) continue;
+      auto old = s.stamps.find(e.summary.id);
+      if (old == s.stamps.end() || old->second != e.stamp) {
+        s.contentHashes.erase(e.summary.id); // changed outside the app
+        contentChanged = true;
+      }
+      s.stamps[e.summary.id] = e.stamp;
+      remindersChanged |= s.reminders.track(e.summary);
+      s.index.put(std::move(e.summary));
+    }
+
+    std::vector<std::wstring> gone;
+    s.index.forEach([&](const NoteSummary& n) {
+      if (!seen.count(n.id) && !s.touched.count(n.id)) gone.push_back(n.id);
+    });
+    for (const auto& id : gone) {
+      s.index.erase(id);
+      s.stamps.erase(id);
+      s.contentHashes.erase(id);
+      remindersChanged |= s.reminders.remove(id);
+    }
+    contentChanged |= !gone.empty();
+  }
+  if (contentChanged) {
+    resetSearch(s); // rare: rebuilding beats reading changed notes here
   }
 
-  const int64_t dismissed = getI64("dismissedAtUtcMs", 0);
-  if (dismissed != 0) {
-    out.dismissed = true;
-    out.dismissedAtUtcMs = dismissed;
+  s.months.clear();
+  s.touched.clear();
+  s.reconciling = false;
+  if (remindersChanged) {
+    notifyRemindersChanged();
   }
+}
 
-  out.createdAtUtcMs = getI64("createdAtUtcMs", 0);
-  out.updatedAtUtcMs = getI64("updatedAtUtcMs", 0);
+void startReconcile(RepoState& s, std::unordered_map<std::wstring, StampedSummary> known) {
+  s.reconciling = true;
+  s.reconcileDone = false;
+  NoteStore* store = s.store.get();
+  s.reconciler = std::thread([&s, store, known = std::move(known)]() {
+    std::vector<StampedSummary> fresh;
+    const bool ok = store->scan(known, fresh, nullptr);
 
-  // content (optional)
-  {
-    std::wstring rtf;
-    if (readFileUtf8(contentRtfPath(id), &rtf, nullptr)) {
-      out.contentRtf = rtf;
+    bool changed = false;
+    if (ok) {
+      changed = fresh.size() != known.size();
+      for (size_t i = 0; !changed && i < fresh.size(); ++i) {
+        auto k = known.find(fresh[i].summary.id);
+        changed = k == known.end() || k->second.stamp != fresh[i].stamp;
+      }
     }
-    std::wstring html;
-    if (readFileUtf8(contentHtmlPath(id), &html, nullptr)) {
-      out.contentHtml = html;
+
+    {
+      std::lock_guard<std::mutex> lock(s.reconcileMutex);
+      s.reconcileDone = true;
+      s.reconcileOk = ok;
+      s.reconciled = std::move(fresh);
     }
-    std::wstring md;
-    if (readFileUtf8(contentMdPath(id), &md, nullptr)) {
-      out.contentMarkdown = md;
+    if (changed) {
+      notifyIndexChanged();
     }
+  });
+}
+
+// Stops a running reconcile and drops the resident index.
+void resetIndex(RepoState& s) {
+  if (s.reconciler.joinable()) {
+    s.reconciler.join();
   }
+  s.reconciling = false;
+  s.reconcileDone = false;
+  s.reconciled.clear();
+  s.touched.clear();
+  s.stamps.clear();
+  s.contentHashes.clear();
+  resetSearch(s);
+  s.index.clear();
+  s.reminders.clear();
+  s.months.clear();
+  s.loaded = false;
+}
+
+// Single-note index updates, keeping the derived reminder queue and month
+// aggregates in step. Return whether the pending reminders changed.
+bool indexPut(RepoState& s, NoteSummary summary) {
+  std::optional<NoteSummary> before;
+  if (!s.months.empty()) {
+    if (const NoteSummary* cur = s.index.find(summary.id)) before = *cur;
+  }
+  const bool remindersChanged = s.reminders.track(summary);
+  const std::wstring id = summary.id;
+  s.index.put(std::move(summary));
+  s.months.noteChanged(s.index, before ? &*before : nullptr, s.index.find(id));
+  return remindersChanged;
+}
 
-  return true;
+bool indexErase(RepoState& s, const std::wstring& id) {
+  std::optional<NoteSummary> before;
+  if (!s.months.empty()) {
+    if (const NoteSummary* cur = s.index.find(id)) before = *cur;
+  }
+  s.index.erase(id);
+  if (before) {
+    s.months.noteChanged(s.index, &*before, nullptr);
+  }
+  return s.reminders.remove(id);
 }
 
-bool writeMeta(const Note& n, std::wstring* errorOut) {
-  const fs::path dir = AppPaths::noteDir(n.id); // creates dir
+void noteTouched(RepoState& s, const std::wstring& id) {
+  s.stamps.erase(id);
+  if (s.reconciling) {
+    s.touched.insert(id);
+  }
+}
 
-  // title
-  if (!writeFileUtf8(dir / L"title.txt", n.title, errorOut)) {
+// True if writing note would only move updatedAtUtcMs: same metadata as indexed
+// and same content as last written/read.
+bool unchangedSave(const RepoState& s, const Note& note, uint64_t hash) {
+  const NoteSummary* current = s.index.find(note.id);
+  auto known = s.contentHashes.find(note.id);
+  if (!current || known == s.contentHashes.end() || known->second != hash) {
     return false;
   }
+  NoteSummary next = makeSummary(note);
+  next.updatedAtUtcMs = current->updatedAtUtcMs;
+  return next == *current;
+}
 
-  std::ostringstream ss;
-  ss << "scheduledAtUtcMs=" << n.scheduledAtUtcMs << "\n";
-  ss << "importance=" << n.importance << "\n";
-  ss << "contentMode=" << static_cast<int>(n.contentMode) << "\n";
-  ss << "autoHideEnabled=" << (n.autoHideEnabled ? 1 : 0) << "\n";
-  ss << "autoHideSeconds=" << n.autoHideSeconds << "\n";
-  ss << "firedAtUtcMs=" << (n.hasFired ? n.firedAtUtcMs : 0) << "\n";
-  ss << "dismissedAtUtcMs=" << (n.dismissed ? n.dismissedAtUtcMs : 0) << "\n";
-  ss << "createdAtUtcMs=" << n.createdAtUtcMs << "\n";
-  ss << "updatedAtUtcMs=" << n.updatedAtUtcMs << "\n";
-
-  const std::string meta = ss.str();
-  std::ofstream f(dir / L"meta.txt", std::ios::binary | std::ios::trunc);
-  if (!f.is_open()) {
-    if (errorOut) {
-      *errorOut = L"Не удалось открыть meta.txt для записи.";
+const std::wstring& changeId(const NoteChange& c) {
+  switch (c.kind) {
+    case NoteChange::Kind::Write: return c.note.id;
+    case NoteChange::Kind::WriteSummary: return c.summary.id;
+    case NoteChange::Kind::Remove: break;
+  }
+  return c.id;
+}
+
+// Index entries with a known stamp (notes unchanged since the last scan).
+std::unordered_map<std::wstring, StampedSummary> stampedIndex(const RepoState& s) {
+  std::unordered_map<std::wstring, StampedSummary> out;
+  out.reserve(s.stamps.size());
+  s.index.forEach([&](const NoteSummary& n) {
+    auto it = s.stamps.find(n.id);
+    if (it != s.stamps.end()) {
+      out.emplace(n.id, StampedSummary{ n, it->second });
     }
-    return false;
+  });
+  return out;
+}
+
+void saveSnapshot(RepoState& s) {
+  if (!s.loaded || !s.store || !s.store->supportsSnapshot()) {
+    return;
+  }
+  if (s.reconciler.joinable()) {
+    s.reconciler.join();
   }
-  f.write(meta.data(), static_cast<std::streamsize>(meta.size()));
+  applyReconciled(s);
 
-  // content files: сохраняем то, что передано
-  // Important: if content becomes empty, we must clear old files, otherwise "old text comes back".
-  auto writeOrDelete = [&](const fs::path& p, const std::wstring& text) -> bool {
-    if (text.empty()) {
-      std::error_code ec;
-      fs::remove(p, ec);
-      return true;
+  std::vector<StampedSummary> entries;
+  entries.reserve(s.index.size());
+  s.index.forEach([&](const NoteSummary& n) {
+    auto it = s.stamps.find(n.id);
+    const int64_t stamp = it != s.stamps.end() ? it->second : s.store->stamp(n.id);
+    if (stamp != 0) {
+      entries.push_back(StampedSummary{ n, stamp });
     }
-    return writeFileUtf8(p, text, errorOut);
-  };
+  });
+  IndexSnapshot::save(AppPaths::indexSnapshotPath(), entries, nullptr);
+}
+
+std::unique_ptr<MediaNoteStore> withMedia(std::unique_ptr<NoteStore> backend) {
+  return std::make_unique<MediaNoteStore>(std::move(backend), AppPaths::mediaRootDir());
+}
+
+// The backend not in use, if it has data on disk (read only by blob collection).
+std::unique_ptr<NoteStore> inactiveStore(NoteStorageKind active) {
+  std::error_code ec;
+  if (active == NoteStorageKind::Log) {
+    const fs::path root = AppPaths::notesRootDir();
+    return fs::is_directory(root, ec) ? std::make_unique<DirectoryNoteStore>(root) : nullptr;
+  }
+  const fs::path logPath = AppPaths::notesLogPath();
+  return fs::exists(logPath, ec) ? std::make_unique<LogNoteStore>(logPath) : nullptr;
+}
+
+// Returns the repository with its store opened and resident index loaded.
+// Throws on storage errors (callers already translate exceptions to errorOut).
+RepoState& loadedState() {
+  RepoState& s = repoState();
+  if (s.loaded) {
+    if (s.reconciling) {
+      applyReconciled(s);
+    }
+    return s;
+  }
+  if (!s.store) {
+    s.store = withMedia(std::make_unique<DirectoryNoteStore>(AppPaths::notesRootDir()));
+    s.kind = NoteStorageKind::Directory;
+  }
 
-  if (!writeOrDelete(dir / L"content.rtf", n.contentRtf)) return false;
-  if (!writeOrDelete(dir / L"content.html", n.contentHtml)) return false;
-  if (!writeOrDelete(dir / L"content.md", n.contentMarkdown)) return false;
+  std::wstring err;
+  if (s.store->supportsSnapshot()) {
+    std::vector<StampedSummary> entries;
+    if (IndexSnapshot::load(AppPaths::indexSnapshotPath(), entries)) {
+      // Warm start: serve the snapshot right away and verify it in the background.
+      std::unordered_map<std::wstring, StampedSummary> known;
+      known.reserve(entries.size());
+      for (const auto& e : entries) {
+        known.emplace(e.summary.id, e);
+      }
+      populate(s, std::move(entries));
+      s.loaded = true;
+      startReconcile(s, std::move(known));
+      return s;
+    }
 
-  return true;
+    // Cold start: one full scan, which also stamps every note for the next snapshot.
+    if (!s.store->scan({}, entries, &err)) {
+      throw std::runtime_error(Utf8::toUtf8(err));
+    }
+    populate(s, std::move(entries));
+    s.loaded = true;
+    return s;
+  }
+
+  std::vector<NoteSummary> all;
+  if (!s.store->loadAll(all, &err)) {
+    throw std::runtime_error(Utf8::toUtf8(err));
+  }
+
+  s.index.clear();
+  s.reminders.clear();
+  s.months.clear();
+  for (auto& n : all) {
+    s.reminders.track(n);
+    s.index.put(std::move(n));
+  }
+  s.loaded = true;
+  return s;
 }
 
-bool isSameLocalDate(const SYSTEMTIME& a, const SYSTEMTIME& b) {
-  return a.wYear == b.wYear && a.wMonth == b.wMonth && a.wDay == b.wDay;
+// One-time import of the per-directory layout into a fresh log store, as a single
+// batch: one durability barrier, and a failed import leaves nothing behind.
+bool importDirectoryStore(const fs::path& notesRoot, NoteStore& target, std::wstring* errorOut) {
+  DirectoryNoteStore source(notesRoot);
+  std::vector<NoteSummary> all;
+  std::vector<NoteSummary> existing;
+  if (!source.loadAll(all, errorOut) || !target.loadAll(existing, errorOut)) {
+    return false;
+  }
+  std::vector<NoteChange> changes;
+  changes.reserve(all.size());
+  for (const auto& summary : all) {
+    NoteChange c;
+    if (source.read(summary.id, c.note, nullptr)) {
+      changes.push_back(std::move(c));
+    }
+  }
+  return target.apply(changes, errorOut);
+}
+
+// A random (version 4) GUID as text, without braces.
+std::wstring newNoteId() {
+#ifdef _WIN32
+  return WinUtil::guidString();
+#else
+  static std::mutex m;
+  static std::mt19937_64 rng = [] {
+    std::random_device rd;
+    std::seed_seq seed{ rd(), rd(), rd(), rd() };
+    return std::mt19937_64(seed);
+  }();
+  uint64_t hi, lo;
+  {
+    std::lock_guard<std::mutex> lock(m);
+    hi = rng();
+    lo = rng();
+  }
+  hi = (hi & ~0xF000ull) | 0x4000ull;                // version 4
+  lo = (lo & ~(0xC000ull << 48)) | (0x8000ull << 48); // RFC 4122 variant
+  wchar_t buf[40];
+  swprintf(buf, 40, L"%08X-%04X-%04X-%04X-%012llX", static_cast<unsigned>(hi >> 32),
+           static_cast<unsigned>((hi >> 16) & 0xFFFF), static_cast<unsigned>(hi & 0xFFFF),
+           static_cast<unsigned>(lo >> 48), static_cast<unsigned long long>(lo & 0xFFFFFFFFFFFFull));
+  return buf;
+#endif
+}
+
+void stampNote(Note& note, int64_t nowUtcMs) {
+  if (note.id.empty()) {
+    note.id = newNoteId();
+  }
+  if (note.createdAtUtcMs == 0) {
+    note.createdAtUtcMs = nowUtcMs;
+  }
+  note.updatedAtUtcMs = nowUtcMs;
+}
+
+// T is Note or NoteSummary.
+template <class T>
+void applyPatch(T& n, const std::optional<int64_t>& scheduledAtUtcMs, const std::optional<int64_t>& firedAtUtcMs,
+                const std::optional<int64_t>& dismissedAtUtcMs, int64_t nowUtcMs) {
+  if (scheduledAtUtcMs) {
+    n.scheduledAtUtcMs = *scheduledAtUtcMs;
+  }
+  if (firedAtUtcMs) {
+    NoteSchema::kFiredAt.set(n, *firedAtUtcMs);
+  }
+  if (dismissedAtUtcMs) {
+    NoteSchema::kDismissedAt.set(n, *dismissedAtUtcMs);
+  }
+  n.updatedAtUtcMs = nowUtcMs;
+}
+
+// Metadata-only update of an indexed note: one small store write, no content I/O.
+template <class Fn>
+bool updateSummary(const std::wstring& id, Fn&& apply, std::wstring* errorOut) {
+  try {
+    RepoState& s = loadedState();
+    const NoteSummary* current = s.index.find(id);
+    if (!current) {
+      if (errorOut) {
+        *errorOut = L"Заметка не найдена: " + id;
+      }
+      return false;
+    }
+
+    waitForQueuedSave(s, id);
+
+    NoteSummary n = *current;
+    apply(n);
+    n.updatedAtUtcMs = TimeUtils::unixMsNowUtc();
+    if (!s.store->writeSummary(n, errorOut)) {
+      return false;
+    }
+    noteTouched(s, id);
+
+    if (indexPut(s, std::move(n))) {
+      notifyRemindersChanged();
+    }
+    return true;
+  } catch (const std::exception& e) {
+    if (errorOut) {
+      *errorOut = L"Ошибка обновления заметки: " + Utf8::toWide(e.what());
+    }
+    return false;
+  }
 }
 } // namespace
 
-bool NoteRepository::upsert(Note note, std::wstring* errorOut) {
+bool NoteRepository::open(NoteStorageKind kind, std::wstring* errorOut) {
   try {
-    if (note.id.empty()) {
-      note.id = WinUtil::guidString();
+    RepoState& s = repoState();
+    stopWriter(s);
+    resetIndex(s);
+    s.store.reset();
+
+    if (kind == NoteStorageKind::Log) {
+      const fs::path logPath = AppPaths::notesLogPath();
+      const bool fresh = !fs::exists(logPath);
+      auto store = std::make_unique<LogNoteStore>(logPath);
+      if (fresh && !importDirectoryStore(AppPaths::notesRootDir(), *store, errorOut)) {
+        std::error_code ec;
+        store.reset();
+        fs::remove(logPath, ec);
+        return false;
+      }
+      s.store = withMedia(std::move(store));
+    } else {
+      s.store = withMedia(std::make_unique<DirectoryNoteStore>(AppPaths::notesRootDir()));
     }
+    s.kind = kind;
 
-    const int64_t now = TimeUtils::unixMsNowUtc();
-    if (note.createdAtUtcMs == 0) {
-      note.createdAtUtcMs = now;
+    loadedState();
+    notifyRemindersChanged();
+    return true;
+  } catch (const std::exception& e) {
+    if (errorOut) {
+      *errorOut = L"Ошибка открытия хранилища заметок: " + Utf8::toWide(e.what());
     }
-    note.updatedAtUtcMs = now;
+    return false;
+  }
+}
 
-    if (!writeMeta(note, errorOut)) {
+void NoteRepository::close() {
+  RepoState& s = repoState();
+  stopWriter(s);
+  saveSnapshot(s);
+  resetIndex(s);
+  if (s.store) {
+    // No writers left. The other backend's notes (the directory kept as the
+    // migration backup, or a log from before switching back) share the blobs.
+    std::vector<NoteStore*> others;
+    std::unique_ptr<NoteStore> inactive = inactiveStore(s.kind);
+    if (inactive) others.push_back(inactive.get());
+    s.store->collectGarbage(others);
+  }
+  s.store.reset();
+  FileIo::shutdown();
+}
+
+bool NoteRepository::upsert(Note note, std::wstring* errorOut) {
+  try {
+    RepoState& s = loadedState();
+    const uint64_t hash = contentHash(note);
+    if (unchangedSave(s, note, hash)) {
+      return true;
+    }
+    stampNote(note, TimeUtils::unixMsNowUtc());
+
+    waitForQueuedSave(s, note.id);
+    if (!s.store->write(note, errorOut)) {
       return false;
     }
+    noteTouched(s, note.id);
+    s.contentHashes[note.id] = hash;
+    searchPut(s, note);
+
+    if (indexPut(s, makeSummary(note))) {
+      notifyRemindersChanged();
+    }
     return true;
   } catch (const std::exception& e) {
     if (errorOut) {
-      *errorOut = L"Ошибка upsert: " + WinUtil::fromUtf8(e.what());
+      *errorOut = L"Ошибка upsert: " + Utf8::toWide(e.what());
     }
     return false;
   }
@@ -228,15 +692,21 @@ bool NoteRepository::upsert(Note note, std::wstring* errorOut) {
 
 bool NoteRepository::removeById(const std::wstring& id, std::wstring* errorOut) {
   try {
-    const fs::path dir = noteDirNoCreate(id);
-    if (!fs::exists(dir)) {
-      return true;
+    RepoState& s = loadedState();
+    waitForQueuedSave(s, id);
+    if (!s.store->remove(id, errorOut)) {
+      return false;
+    }
+    noteTouched(s, id);
+    s.contentHashes.erase(id);
+    searchErase(s, id);
+    if (indexErase(s, id)) {
+      notifyRemindersChanged();
     }
-    fs::remove_all(dir);
     return true;
   } catch (const std::exception& e) {
     if (errorOut) {
-      *errorOut = L"Ошибка удаления заметки: " + WinUtil::fromUtf8(e.what());
+      *errorOut = L"Ошибка удаления заметки: " + Utf8::toWide(e.what());
     }
     return false;
   }
@@ -244,155 +714,389 @@ bool NoteRepository::removeById(const std::wstring& id, std::wstring* errorOut)
 
 std::optional<Note> NoteRepository::getById(const std::wstring& id, std::wstring* errorOut) {
   try {
+    RepoState& s = loadedState();
+    auto queued = s.pending.find(id);
+    if (queued != s.pending.end()) {
+      return *queued->second.note;
+    }
     Note n;
-    if (!readMeta(id, n, errorOut)) {
+    if (!s.store->read(id, n, errorOut)) {
       return std::nullopt;
     }
+    s.contentHashes[id] = contentHash(n);
     return n;
   } catch (const std::exception& e) {
     if (errorOut) {
-      *errorOut = L"Ошибка чтения заметки: " + WinUtil::fromUtf8(e.what());
+      *errorOut = L"Ошибка чтения заметки: " + Utf8::toWide(e.what());
     }
     return std::nullopt;
   }
 }
 
-std::vector<Note> NoteRepository::listForDate(const SYSTEMTIME& localDate, std::wstring* errorOut) {
-  std::vector<Note> out;
+bool NoteRepository::upsertAsync(Note note, SaveCallback done, std::wstring* errorOut) {
   try {
-    const fs::path root = AppPaths::notesRootDir();
-    for (const auto& entry : fs::directory_iterator(root)) {
-      if (!entry.is_directory()) continue;
-      const std::wstring id = entry.path().filename().wstring();
-
-      Note n;
-      if (!readMeta(id, n, nullptr)) {
-        continue;
+    RepoState& s = loadedState();
+    const uint64_t hash = contentHash(note);
+    if (unchangedSave(s, note, hash)) {
+      if (done) {
+        done(true, {});
       }
+      return true;
+    }
+    stampNote(note, TimeUtils::unixMsNowUtc());
+
+    if (!s.writer) {
+      s.writer = std::make_unique<StorageWorker>(*s.store, notifyWritesCompleted);
+    }
+    auto snapshot = std::make_shared<const Note>(std::move(note));
+    const uint64_t seq = s.writer->post(snapshot);
+    s.pending[snapshot->id] = RepoState::PendingSave{ seq, snapshot };
+    if (done) {
+      s.saveCallbacks.emplace(seq, std::move(done));
+    }
+    noteTouched(s, snapshot->id);
+    s.contentHashes[snapshot->id] = hash;
+    searchPut(s, *snapshot);
 
-      const SYSTEMTIME stLocal = TimeUtils::unixMsToSystemTimeLocal(n.scheduledAtUtcMs);
-      if (isSameLocalDate(stLocal, localDate)) {
-        out.push_back(std::move(n));
+    if (indexPut(s, makeSummary(*snapshot))) {
+      notifyRemindersChanged();
+    }
+    return true;
+  } catch (const std::exception& e) {
+    if (errorOut) {
+      *errorOut = L"Ошибка upsert: " + Utf8::toWide(e.what());
+    }
+    return false;
+  }
+}
+
+void NoteRepository::setWritesCompletedHandler(std::function<void()> handler) {
+  std::lock_guard<std::mutex> lock(writesCompletedMutex());
+  writesCompletedHandler() = std::move(handler);
+}
+
+void NoteRepository::dispatchCompletedWrites() {
+  RepoState& s = repoState();
+  if (!s.writer) return;
+  for (auto& r : s.writer->takeResults()) {
+    auto queued = s.pending.find(r.id);
+    if (queued != s.pending.end() && queued->second.seq == r.seq) {
+      s.pending.erase(queued);
+      if (!r.ok) {
+        s.contentHashes.erase(r.id); // not on disk: an identical retry must write
       }
     }
+    auto cb = s.saveCallbacks.find(r.seq);
+    if (cb != s.saveCallbacks.end()) {
+      SaveCallback done = std::move(cb->second);
+      s.saveCallbacks.erase(cb);
+      done(r.ok, r.error);
+    }
+  }
+}
 
-    std::sort(out.begin(), out.end(), [](const Note& a, const Note& b) {
-      return a.scheduledAtUtcMs < b.scheduledAtUtcMs;
-    });
+std::vector<NoteSummary> NoteRepository::listForDate(const Civil::Date& localDate, std::wstring* errorOut) {
+  const auto zone = TimeUtils::localZone();
+  const int32_t day = Civil::toDays(localDate);
+  return listRange(zone->dayStartUtc(day), zone->dayStartUtc(day + 1), errorOut);
+}
 
+std::vector<NoteSummary> NoteRepository::listRange(int64_t fromUtcMs, int64_t toUtcMs, std::wstring* errorOut) {
+  std::vector<NoteSummary> out;
+  try {
+    loadedState().index.forRange(fromUtcMs, toUtcMs, [&](const NoteSummary& n) {
+      out.push_back(n);
+      return true;
+    });
     return out;
   } catch (const std::exception& e) {
     if (errorOut) {
-      *errorOut = L"Ошибка listForDate: " + WinUtil::fromUtf8(e.what());
+      *errorOut = L"Ошибка listRange: " + Utf8::toWide(e.what());
     }
     return {};
   }
 }
 
 std::array<CalendarDayMeta, 32> NoteRepository::monthMeta(int year, int month, std::wstring* errorOut) {
-  std::array<CalendarDayMeta, 32> meta{};
-  for (auto& d : meta) d = CalendarDayMeta{};
-
   try {
-    // Track earliest note per day for preview
-    std::array<int64_t, 32> earliest{};
-    earliest.fill(0);
+    RepoState& s = loadedState();
+    return s.months.month(s.index, year, month);
+  } catch (const std::exception& e) {
+    if (errorOut) {
+      *errorOut = L"Ошибка monthMeta: " + Utf8::toWide(e.what());
+    }
+    return {};
+  }
+}
 
-    const fs::path root = AppPaths::notesRootDir();
-    for (const auto& entry : fs::directory_iterator(root)) {
-      if (!entry.is_directory()) continue;
-      const std::wstring id = entry.path().filename().wstring();
+void NoteRepository::invalidateMonthMeta() {
+  repoState().months.clear();
+}
 
-      Note n;
-      if (!readMeta(id, n, nullptr)) {
-        continue;
+std::vector<NoteSummary> NoteRepository::listDue(int64_t nowUtcMs, int limit, std::wstring* errorOut) {
+  std::vector<NoteSummary> out;
+  try {
+    const RepoState& s = loadedState();
+    for (const auto& id : s.reminders.due(nowUtcMs, static_cast<size_t>(std::max(0, limit)))) {
+      if (const NoteSummary* n = s.index.find(id)) {
+        out.push_back(*n);
       }
+    }
+    return out;
+  } catch (const std::exception& e) {
+    if (errorOut) {
+      *errorOut = L"Ошибка listDue: " + Utf8::toWide(e.what());
+    }
+    return {};
+  }
+}
 
-      if (n.scheduledAtUtcMs == 0) continue;
-      const SYSTEMTIME stLocal = TimeUtils::unixMsToSystemTimeLocal(n.scheduledAtUtcMs);
-      if (stLocal.wYear != year || stLocal.wMonth != month) continue;
-      if (stLocal.wDay < 1 || stLocal.wDay > 31) continue;
-
-      auto& d = meta[stLocal.wDay];
-      d.count += 1;
-      d.maxImportance = std::max(d.maxImportance, n.importance);
-
-      // Preview: earliest scheduled time + title
-      const int64_t prev = earliest[stLocal.wDay];
-      if (prev == 0 || n.scheduledAtUtcMs < prev) {
-        earliest[stLocal.wDay] = n.scheduledAtUtcMs;
-        const std::wstring time = WinUtil::formatHHMM(stLocal);
-        std::wstring title = n.title.empty() ? L"(без названия)" : n.title;
-        // truncate a bit for cell
-        if (title.size() > 22) {
-          title.resize(22);
-          title += L"…";
-        }
-        d.preview = time + L" " + title;
+std::vector<NoteSummary> NoteRepository::search(const std::wstring& query, int limit, std::wstring* errorOut) {
+  std::vector<NoteSummary> out;
+  try {
+    RepoState& s = loadedState();
+    if (!s.searchStarted) {
+      startSearchBuild(s);
+    }
+    std::vector<SearchIndex::Hit> hits;
+    {
+      std::lock_guard<std::mutex> lock(s.searchMutex);
+      hits = s.search.search(query, static_cast<size_t>(std::max(0, limit)));
+    }
+    out.reserve(hits.size());
+    for (const auto& hit : hits) {
+      if (const NoteSummary* n = s.index.find(hit.id)) {
+        out.push_back(*n);
       }
     }
-    return meta;
+    return out;
   } catch (const std::exception& e) {
     if (errorOut) {
-      *errorOut = L"Ошибка monthMeta: " + WinUtil::fromUtf8(e.what());
+      *errorOut = L"Ошибка поиска: " + Utf8::toWide(e.what());
     }
-    return meta;
+    return {};
   }
 }
 
-std::vector<Note> NoteRepository::listDue(int64_t nowUtcMs, int limit, std::wstring* errorOut) {
-  std::vector<Note> out;
+std::optional<int64_t> NoteRepository::nextReminderUtcMs(std::wstring* errorOut) {
   try {
-    const fs::path root = AppPaths::notesRootDir();
-    for (const auto& entry : fs::directory_iterator(root)) {
-      if (!entry.is_directory()) continue;
-      const std::wstring id = entry.path().filename().wstring();
+    return loadedState().reminders.nextDueUtcMs();
+  } catch (const std::exception& e) {
+    if (errorOut) {
+      *errorOut = L"Ошибка nextReminderUtcMs: " + Utf8::toWide(e.what());
+    }
+    return std::nullopt;
+  }
+}
 
-      Note n;
-      if (!readMeta(id, n, nullptr)) {
-        continue;
-      }
+void NoteRepository::dropReminder(const std::wstring& id) {
+  RepoState& s = repoState();
+  if (s.loaded && s.reminders.remove(id)) {
+    notifyRemindersChanged();
+  }
+}
 
-      if (n.hasFired) continue;
-      if (n.scheduledAtUtcMs == 0) continue;
-      if (n.scheduledAtUtcMs <= nowUtcMs) {
-        out.push_back(std::move(n));
-      }
-    }
+void NoteRepository::setRemindersChangedHandler(std::function<void()> handler) {
+  remindersChangedHandler() = std::move(handler);
+}
 
-    std::sort(out.begin(), out.end(), [](const Note& a, const Note& b) {
-      return a.scheduledAtUtcMs < b.scheduledAtUtcMs;
-    });
+void NoteRepository::setIndexChangedHandler(std::function<void()> handler) {
+  std::lock_guard<std::mutex> lock(indexChangedMutex());
+  indexChangedHandler() = std::move(handler);
+}
 
-    if (static_cast<int>(out.size()) > limit) {
-      out.resize(static_cast<size_t>(limit));
+void NoteRepository::reload() {
+  RepoState& s = repoState();
+  if (s.writer) {
+    s.writer->drain(); // the rescan must see queued saves
+  }
+  if (s.loaded && s.store && s.store->supportsSnapshot()) {
+    // Rescan, re-reading only notes whose stamp moved.
+    if (s.reconciler.joinable()) {
+      s.reconciler.join();
     }
-
-    return out;
-  } catch (const std::exception& e) {
-    if (errorOut) {
-      *errorOut = L"Ошибка listDue: " + WinUtil::fromUtf8(e.what());
+    applyReconciled(s);
+    std::vector<StampedSummary> entries;
+    if (s.store->scan(stampedIndex(s), entries, nullptr)) {
+      resetSearch(s);
+      populate(s, std::move(entries));
+      notifyRemindersChanged();
+      return;
     }
-    return {};
   }
+  resetIndex(s);
+  notifyRemindersChanged();
+}
+
+bool NoteRepository::updateSchedule(const std::wstring& id, int64_t scheduledAtUtcMs, std::wstring* errorOut) {
+  return updateSummary(id, [&](NoteSummary& n) {
+    n.scheduledAtUtcMs = scheduledAtUtcMs;
+    NoteSchema::kFiredAt.set(n, 0);
+    NoteSchema::kDismissedAt.set(n, 0);
+  }, errorOut);
+}
+
+bool NoteRepository::updateState(const std::wstring& id, int64_t firedAtUtcMs, int64_t dismissedAtUtcMs,
+                                 std::wstring* errorOut) {
+  return updateSummary(id, [&](NoteSummary& n) {
+    NoteSchema::kFiredAt.set(n, firedAtUtcMs);
+    NoteSchema::kDismissedAt.set(n, dismissedAtUtcMs);
+  }, errorOut);
 }
 
 bool NoteRepository::markFired(const std::wstring& id, int64_t firedAtUtcMs, std::wstring* errorOut) {
-  auto opt = getById(id, errorOut);
-  if (!opt) return false;
-  Note n = *opt;
-  n.hasFired = true;
-  n.firedAtUtcMs = firedAtUtcMs;
-  return upsert(std::move(n), errorOut);
+  return updateSummary(id, [&](NoteSummary& n) {
+    NoteSchema::kFiredAt.set(n, firedAtUtcMs);
+  }, errorOut);
 }
 
 bool NoteRepository::markDismissed(const std::wstring& id, int64_t dismissedAtUtcMs, std::wstring* errorOut) {
-  auto opt = getById(id, errorOut);
-  if (!opt) return false;
-  Note n = *opt;
-  n.dismissed = true;
-  n.dismissedAtUtcMs = dismissedAtUtcMs;
-  return upsert(std::move(n), errorOut);
+  return updateSummary(id, [&](NoteSummary& n) {
+    NoteSchema::kDismissedAt.set(n, dismissedAtUtcMs);
+  }, errorOut);
+}
+
+std::wstring NoteRepository::Batch::upsert(Note note) {
+  if (note.id.empty()) {
+    note.id = newNoteId();
+  }
+  std::wstring id = note.id;
+  Op op;
+  op.kind = Op::Kind::Upsert;
+  op.note = std::move(note);
+  m_ops.push_back(std::move(op));
+  return id;
 }
 
+void NoteRepository::Batch::remove(const std::wstring& id) {
+  Op op;
+  op.kind = Op::Kind::Remove;
+  op.note.id = id;
+  m_ops.push_back(std::move(op));
+}
 
+NoteRepository::Batch::Op& NoteRepository::Batch::patch(const std::wstring& id) {
+  Op op;
+  op.kind = Op::Kind::Patch;
+  op.note.id = id;
+  m_ops.push_back(std::move(op));
+  return m_ops.back();
+}
+
+void NoteRepository::Batch::updateSchedule(const std::wstring& id, int64_t scheduledAtUtcMs) {
+  Op& op = patch(id);
+  op.scheduledAtUtcMs = scheduledAtUtcMs;
+  op.firedAtUtcMs = 0;
+  op.dismissedAtUtcMs = 0;
+}
+
+void NoteRepository::Batch::updateState(const std::wstring& id, int64_t firedAtUtcMs, int64_t dismissedAtUtcMs) {
+  Op& op = patch(id);
+  op.firedAtUtcMs = firedAtUtcMs;
+  op.dismissedAtUtcMs = dismissedAtUtcMs;
+}
+
+void NoteRepository::Batch::markFired(const std::wstring& id, int64_t firedAtUtcMs) {
+  patch(id).firedAtUtcMs = firedAtUtcMs;
+}
+
+void NoteRepository::Batch::markDismissed(const std::wstring& id, int64_t dismissedAtUtcMs) {
+  patch(id).dismissedAtUtcMs = dismissedAtUtcMs;
+}
+
+bool NoteRepository::Batch::commit(std::wstring* errorOut) {
+  try {
+    RepoState& s = loadedState();
+    const int64_t now = TimeUtils::unixMsNowUtc();
+    for (const auto& op : m_ops) {
+      waitForQueuedSave(s, op.note.id);
+    }
+
+    // 1. Resolve ops into store changes. A patch folds into an earlier change of the
+    //    same note, so "upsert + markFired" or repeated patches cost one record.
+    constexpr size_t kRemoved = static_cast<size_t>(-1);
+    std::vector<NoteChange> changes;
+    changes.reserve(m_ops.size());
+    std::unordered_map<std::wstring, size_t> lastChange; // id -> index in changes, or kRemoved
+
+    for (auto& op : m_ops) {
+      const std::wstring id = op.note.id;
+      const auto staged = lastChange.find(id);
+
+      if (op.kind == Op::Kind::Upsert) {
+        stampNote(op.note, now);
+        NoteChange c;
+        c.kind = NoteChange::Kind::Write;
+        c.note = std::move(op.note);
+        changes.push_back(std::move(c));
+        lastChange[id] = changes.size() - 1;
+      } else if (op.kind == Op::Kind::Remove) {
+        NoteChange c;
+        c.kind = NoteChange::Kind::Remove;
+        c.id = id;
+        changes.push_back(std::move(c));
+        lastChange[id] = kRemoved;
+      } else if (staged != lastChange.end() && staged->second != kRemoved) {
+        NoteChange& c = changes[staged->second];
+        if (c.kind == NoteChange::Kind::Write) {
+          applyPatch(c.note, op.scheduledAtUtcMs, op.firedAtUtcMs, op.dismissedAtUtcMs, now);
+        } else {
+          applyPatch(c.summary, op.scheduledAtUtcMs, op.firedAtUtcMs, op.dismissedAtUtcMs, now);
+        }
+      } else {
+        const NoteSummary* current = staged == lastChange.end() ? s.index.find(id) : nullptr;
+        if (!current) {
+          if (m_skipMissing) {
+            continue;
+          }
+          if (errorOut) {
+            *errorOut = L"Заметка не найдена: " + id;
+          }
+          return false;
+        }
+        NoteChange c;
+        c.kind = NoteChange::Kind::WriteSummary;
+        c.summary = *current;
+        applyPatch(c.summary, op.scheduledAtUtcMs, op.firedAtUtcMs, op.dismissedAtUtcMs, now);
+        changes.push_back(std::move(c));
+        lastChange[id] = changes.size() - 1;
+      }
+    }
+
+    // 2. One store pass.
+    if (!s.store->apply(changes, errorOut)) {
+      return false;
+    }
+
+    // 3. One index update, one notification.
+    bool remindersChanged = false;
+    for (auto& c : changes) {
+      noteTouched(s, changeId(c));
+      switch (c.kind) {
+        case NoteChange::Kind::Write:
+          s.contentHashes[c.note.id] = contentHash(c.note);
+          searchPut(s, c.note);
+          remindersChanged |= indexPut(s, makeSummary(c.note));
+          break;
+        case NoteChange::Kind::WriteSummary:
+          remindersChanged |= indexPut(s, std::move(c.summary));
+          break;
+        case NoteChange::Kind::Remove:
+          s.contentHashes.erase(c.id);
+          searchErase(s, c.id);
+          remindersChanged |= indexErase(s, c.id);
+          break;
+      }
+    }
+    m_ops.clear();
+    if (remindersChanged) {
+      notifyRemindersChanged();
+    }
+    return true;
+  } catch (const std::exception& e) {
+    if (errorOut) {
+      *errorOut = L"Ошибка пакетной записи: " + Utf8::toWide(e.what());
+    }
+    return false;
+  }
+}
@@ -1,29 +1,134 @@
 #pragma once
 
+#include "core/Civil.h"
 #include "model/Note.h"
 #include "model/CalendarDayMeta.h"
 
-#include <windows.h>
-
 #include <array>
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 #include <optional>
 
+enum class NoteStorageKind : int {
+  Directory = 0, // notes/<id>/{title.txt, meta.txt, content.*}
+  Log = 1        // single append-only notes.log
+};
+
 class NoteRepository {
 public:
+  // Staged writes committed in one pass: a single store call (one append/flush for
+  // the log backend), one index update and at most one reminders-changed callback.
+  // Use for reminder bursts, imports and multi-note edits.
+  class Batch {
+  public:
+    // Returns the note id (a new one is assigned if empty).
+    std::wstring upsert(Note note);
+    void remove(const std::wstring& id);
+    // Same semantics as the NoteRepository field-level updates.
+    void updateSchedule(const std::wstring& id, int64_t scheduledAtUtcMs);
+    void updateState(const std::wstring& id, int64_t firedAtUtcMs, int64_t dismissedAtUtcMs);
+    void markFired(const std::wstring& id, int64_t firedAtUtcMs);
+    void markDismissed(const std::wstring& id, int64_t dismissedAtUtcMs);
+
+    // Field-level updates of notes that no longer exist are dropped instead of
+    // failing the commit (lifecycle actions on notes deleted in the meantime).
+    void setSkipMissing(bool skip) { m_skipMissing = skip; }
+
+    size_t size() const { return m_ops.size(); }
+    bool empty() const { return m_ops.empty(); }
+
+    // All-or-nothing validation (unknown ids fail before anything is written);
+    // the batch is cleared on success.
+    bool commit(std::wstring* errorOut = nullptr);
+
+  private:
+    struct Op {
+      enum class Kind { Upsert, Remove, Patch };
+      Kind kind = Kind::Upsert;
+      Note note; // Upsert: the note; Remove/Patch: note.id only
+      std::optional<int64_t> scheduledAtUtcMs;
+      std::optional<int64_t> firedAtUtcMs;     // 0 clears
+      std::optional<int64_t> dismissedAtUtcMs; // 0 clears
+    };
+
+    Op& patch(const std::wstring& id);
+
+    std::vector<Op> m_ops;
+    bool m_skipMissing = false;
+  };
+
+  // Selects the storage backend (call once at startup; defaults to Directory).
+  // Switching to Log for the first time imports existing directory notes.
+  static bool open(NoteStorageKind kind, std::wstring* errorOut = nullptr);
+  // Finishes queued saves, saves the index snapshot, drops picture blobs no note
+  // uses any more, releases the backend (waits for background compaction to finish)
+  // and issues any pending grouped fsync.
+  static void close();
+
+  // A save that changes neither metadata nor content (same content hash as last
+  // written/read) is skipped, including the updatedAtUtcMs bump.
   static bool upsert(Note note, std::wstring* errorOut = nullptr);
+  // Saves on the background storage thread (editor autosave): the index, and thus
+  // lists, calendar and reminders, reflect the note right away and getById returns
+  // the queued version until it is on disk. Saves of the same note still waiting for
+  // the disk are coalesced. done runs on the UI thread from dispatchCompletedWrites()
+  // (right away for a skipped no-op save).
+  // Synchronous writes to a note wait for its queued save first.
+  using SaveCallback = std::function<void(bool ok, const std::wstring& error)>;
+  static bool upsertAsync(Note note, SaveCallback done = nullptr, std::wstring* errorOut = nullptr);
+  // Called on the storage thread when queued saves finished; post to the UI thread
+  // and call dispatchCompletedWrites() there.
+  static void setWritesCompletedHandler(std::function<void()> handler);
+  static void dispatchCompletedWrites();
   static bool removeById(const std::wstring& id, std::wstring* errorOut = nullptr);
   static std::optional<Note> getById(const std::wstring& id, std::wstring* errorOut = nullptr);
 
-  // date is interpreted as LOCAL date (year/month/day) from Windows calendar control.
-  static std::vector<Note> listForDate(const SYSTEMTIME& localDate, std::wstring* errorOut = nullptr);
+  // Queries below are answered from a resident metadata index (loaded on first use)
+  // and return summaries only; use getById to load content for the editor/popup.
+  // Notes on a LOCAL calendar date (as selected in the calendar view).
+  static std::vector<NoteSummary> listForDate(const Civil::Date& localDate, std::wstring* errorOut = nullptr);
+  // Notes with fromUtcMs <= scheduledAtUtcMs < toUtcMs, earliest first (week/agenda views).
+  static std::vector<NoteSummary> listRange(int64_t fromUtcMs, int64_t toUtcMs, std::wstring* errorOut = nullptr);
+  // Cached per month and updated per day cell on writes, so calling it after every
+  // save is cheap.
   static std::array<CalendarDayMeta, 32> monthMeta(int year, int month, std::wstring* errorOut = nullptr);
-  static std::vector<Note> listDue(int64_t nowUtcMs, int limit = 50, std::wstring* errorOut = nullptr);
+  // Local day boundaries moved (time zone / DST change): rebuild months on next use.
+  static void invalidateMonthMeta();
+  static std::vector<NoteSummary> listDue(int64_t nowUtcMs, int limit = 50, std::wstring* errorOut = nullptr);
+  // Full-text search over titles and content text (see SearchIndex), best match
+  // first. The first call starts reading all note content on a background thread;
+  // until that finishes results cover the notes indexed so far, and the
+  // index-changed handler fires once it is done.
+  static std::vector<NoteSummary> search(const std::wstring& query, int limit = 100, std::wstring* errorOut = nullptr);
 
+  // Earliest scheduledAtUtcMs among notes that haven't fired yet (nullopt if none).
+  static std::optional<int64_t> nextReminderUtcMs(std::wstring* errorOut = nullptr);
+  // Called whenever the set or order of pending reminders changes (upsert/remove/markFired/reload),
+  // so the UI can re-arm its single wakeup timer. May be called from inside repository writes.
+  static void setRemindersChangedHandler(std::function<void()> handler);
+  // Stops tracking the note as a pending reminder until it is next written or the
+  // store is reloaded (a reminder that can't be marked fired would stay due).
+  static void dropReminder(const std::wstring& id);
+
+  // Field-level updates: rewrite only the note's metadata record, never its content.
+  // updateSchedule moves the reminder and re-arms it (clears fired/dismissed state).
+  static bool updateSchedule(const std::wstring& id, int64_t scheduledAtUtcMs, std::wstring* errorOut = nullptr);
+  // 0 clears the corresponding flag.
+  static bool updateState(const std::wstring& id, int64_t firedAtUtcMs, int64_t dismissedAtUtcMs,
+                          std::wstring* errorOut = nullptr);
   static bool markFired(const std::wstring& id, int64_t firedAtUtcMs, std::wstring* errorOut = nullptr);
   static bool markDismissed(const std::wstring& id, int64_t dismissedAtUtcMs, std::wstring* errorOut = nullptr);
+
+  // Index is restored from a snapshot written at close() and verified against the
+  // store in the background. Called on that background thread when notes changed
+  // outside the app since the snapshot, and when the full-text index finished
+  // building; the next query returns the updated data.
+  static void setIndexChangedHandler(std::function<void()> handler);
+
+  // Rescans the store (picks up changes made outside the app).
+  static void reload();
 };
 
 
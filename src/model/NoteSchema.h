@@ -0,0 +1,124 @@
+#pragma once
+
+#include "model/Note.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+// The scalar metadata fields of Note / NoteSummary (everything but id, title and
+// content), described once. meta.txt (NoteMeta), the binary record (NoteBinary)
+// and JSON (NoteJson) all iterate this table, so they list the same fields in the
+// same order and cannot drift apart; forEach() expands at compile time into
+// straight-line code per field.
+//
+// Every field reads and writes as an int64_t. Accessors are generic lambdas, so
+// one descriptor serves both Note and NoteSummary.
+namespace NoteSchema {
+// Width in the binary record; text and JSON values are decimal either way.
+enum class Wire : uint8_t { I32, I64 };
+
+// A member stored as is (int, bool, enum or int64_t).
+template <Wire W, class Access>
+struct Scalar {
+  static constexpr Wire wire = W;
+  std::string_view key;
+  Access access;
+
+  template <class T>
+  int64_t get(const T& n) const {
+    return static_cast<int64_t>(access(n));
+  }
+  template <class T>
+  void set(T& n, int64_t v) const {
+    auto& m = access(n);
+    m = static_cast<std::remove_reference_t<decltype(m)>>(v);
+  }
+  template <class To, class From>
+  void copy(To& to, const From& from) const {
+    access(to) = access(from);
+  }
+};
+
+// A timestamp with a "happened" flag: stored as the time, 0 when the flag is off.
+template <class Flag, class Time>
+struct Stamp {
+  static constexpr Wire wire = Wire::I64;
+  std::string_view key;
+  Flag flag;
+  Time time;
+
+  template <class T>
+  int64_t get(const T& n) const {
+    return flag(n) ? time(n) : 0;
+  }
+  template <class T>
+  void set(T& n, int64_t v) const {
+    flag(n) = v != 0;
+    time(n) = v;
+  }
+  template <class To, class From>
+  void copy(To& to, const From& from) const {
+    flag(to) = flag(from);
+    time(to) = time(from);
+  }
+};
+
+template <Wire W, class Access>
+constexpr Scalar<W, Access> scalar(std::string_view key, Access access) {
+  return { key, access };
+}
+
+template <class Flag, class Time>
+constexpr Stamp<Flag, Time> stamp(std::string_view key, Flag flag, Time time) {
+  return { key, flag, time };
+}
+
+inline constexpr auto kScheduledAt =
+    scalar<Wire::I64>("scheduledAtUtcMs", [](auto& n) -> auto& { return n.scheduledAtUtcMs; });
+inline constexpr auto kImportance = scalar<Wire::I32>("importance", [](auto& n) -> auto& { return n.importance; });
+inline constexpr auto kContentMode = scalar<Wire::I32>("contentMode", [](auto& n) -> auto& { return n.contentMode; });
+inline constexpr auto kAutoHideEnabled =
+    scalar<Wire::I32>("autoHideEnabled", [](auto& n) -> auto& { return n.autoHideEnabled; });
+inline constexpr auto kAutoHideSeconds =
+    scalar<Wire::I32>("autoHideSeconds", [](auto& n) -> auto& { return n.autoHideSeconds; });
+inline constexpr auto kFiredAt = stamp("firedAtUtcMs", [](auto& n) -> auto& { return n.hasFired; },
+                                       [](auto& n) -> auto& { return n.firedAtUtcMs; });
+inline constexpr auto kDismissedAt = stamp("dismissedAtUtcMs", [](auto& n) -> auto& { return n.dismissed; },
+                                           [](auto& n) -> auto& { return n.dismissedAtUtcMs; });
+inline constexpr auto kCreatedAt = scalar<Wire::I64>("createdAtUtcMs", [](auto& n) -> auto& { return n.createdAtUtcMs; });
+inline constexpr auto kUpdatedAt = scalar<Wire::I64>("updatedAtUtcMs", [](auto& n) -> auto& { return n.updatedAtUtcMs; });
+
+// Serialization order of every format. Changing it changes the binary record:
+// bump the index snapshot version, and notes.log records need a migration.
+inline constexpr std::tuple kFields{
+  kScheduledAt, kImportance, kContentMode, kAutoHideEnabled, kAutoHideSeconds,
+  kFiredAt, kDismissedAt, kCreatedAt, kUpdatedAt,
+};
+
+inline constexpr size_t kFieldCount = std::tuple_size_v<std::remove_const_t<decltype(kFields)>>;
+
+// Calls fn(descriptor) for every field, in order.
+template <class Fn>
+constexpr void forEach(Fn&& fn) {
+  std::apply([&](const auto&... field) { (fn(field), ...); }, kFields);
+}
+
+// Calls fn(descriptor) for every field until it returns true; false if none did.
+template <class Fn>
+constexpr bool findIf(Fn&& fn) {
+  return std::apply([&](const auto&... field) { return (fn(field) || ...); }, kFields);
+}
+
+// Binary width of a descriptor type: if constexpr (wireOf<decltype(field)> == Wire::I64)
+template <class Field>
+inline constexpr Wire wireOf = std::remove_cvref_t<Field>::wire;
+
+// Copies every field from one note type to another (raw members, flags included).
+template <class To, class From>
+void copyFields(To& to, const From& from) {
+  forEach([&](const auto& field) { field.copy(to, from); });
+}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "model/Note.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One staged write of a batch (see NoteStore::apply).
+struct NoteChange {
+  enum class Kind { Write, WriteSummary, Remove };
+
+  Kind kind = Kind::Write;
+  Note note;           // Write
+  NoteSummary summary; // WriteSummary
+  std::wstring id;     // Remove
+};
+
+// Summary plus a cheap version stamp of its stored metadata (warm-start snapshot).
+struct StampedSummary {
+  NoteSummary summary;
+  int64_t stamp = 0;
+};
+
+// Persistence backend behind NoteRepository. The repository owns the resident
+// index; a store only knows how to enumerate, read and write notes.
+class NoteStore {
+public:
+  virtual ~NoteStore() = default;
+
+  // Metadata of every stored note (cold open / reload).
+  virtual bool loadAll(std::vector<NoteSummary>& out, std::wstring* errorOut) = 0;
+
+  virtual bool read(const std::wstring& id, Note& out, std::wstring* errorOut) = 0;
+  virtual bool write(const Note& note, std::wstring* errorOut) = 0;
+  // Rewrites metadata of an existing note (title, schedule, flags) without
+  // touching its stored content.
+  virtual bool writeSummary(const NoteSummary& summary, std::wstring* errorOut) = 0;
+  virtual bool remove(const std::wstring& id, std::wstring* errorOut) = 0;
+
+  // Warm start support. A store that opts in provides a per-note stamp that changes
+  // whenever the note's summary changes on disk (also out of band; content is not
+  // covered, the snapshot holds none), and a scan that re-reads only notes whose
+  // stamp differs from `known`. scan must be safe to run on a background thread
+  // while the UI thread writes through the same store.
+  virtual bool supportsSnapshot() const { return false; }
+  virtual int64_t stamp(const std::wstring& id) { (void)id; return 0; }
+  virtual bool scan(const std::unordered_map<std::wstring, StampedSummary>& known, std::vector<StampedSummary>& out,
+                    std::wstring* errorOut) {
+    (void)known;
+    (void)out;
+    (void)errorOut;
+    return false;
+  }
+
+  // Applies changes in order. Backends that can group writes override this to pay
+  // one durability barrier for the whole batch; the default applies them one by one.
+  virtual bool apply(const std::vector<NoteChange>& changes, std::wstring* errorOut) {
+    for (const auto& c : changes) {
+      bool ok = true;
+      switch (c.kind) {
+        case NoteChange::Kind::Write: ok = write(c.note, errorOut); break;
+        case NoteChange::Kind::WriteSummary: ok = writeSummary(c.summary, errorOut); break;
+        case NoteChange::Kind::Remove: ok = remove(c.id, errorOut); break;
+      }
+      if (!ok) return false;
+    }
+    return true;
+  }
+};
@@ -0,0 +1,93 @@
+#include "NoteTimeIndex.h"
+
+#include <cmath>
+#include <iterator>
+
+namespace {
+constexpr size_t kMinMergeThreshold = 64;
+
+bool containsSorted(const std::vector<NoteTimeIndex::Key>& v, const NoteTimeIndex::Key& k) {
+  return std::binary_search(v.begin(), v.end(), k);
+}
+
+bool eraseSorted(std::vector<NoteTimeIndex::Key>& v, const NoteTimeIndex::Key& k) {
+  auto it = std::lower_bound(v.begin(), v.end(), k);
+  if (it == v.end() || *it != k) return false;
+  v.erase(it);
+  return true;
+}
+
+void insertSorted(std::vector<NoteTimeIndex::Key>& v, NoteTimeIndex::Key k) {
+  auto it = std::lower_bound(v.begin(), v.end(), k);
+  if (it != v.end() && *it == k) return;
+  v.insert(it, std::move(k));
+}
+} // namespace
+
+void NoteTimeIndex::clear() {
+  m_base.clear();
+  m_delta.clear();
+  m_erased.clear();
+}
+
+void NoteTimeIndex::insert(int64_t atUtcMs, const std::wstring& id) {
+  Key k{ atUtcMs, id };
+  if (eraseSorted(m_erased, k)) {
+    return; // key is still physically present in m_base
+  }
+  if (containsSorted(m_base, k)) {
+    return;
+  }
+  insertSorted(m_delta, std::move(k));
+  maybeMerge();
+}
+
+void NoteTimeIndex::erase(int64_t atUtcMs, const std::wstring& id) {
+  Key k{ atUtcMs, id };
+  if (eraseSorted(m_delta, k)) {
+    return;
+  }
+  if (containsSorted(m_base, k)) {
+    insertSorted(m_erased, std::move(k));
+    maybeMerge();
+  }
+}
+
+std::optional<int64_t> NoteTimeIndex::firstUtcMs() const {
+  std::optional<int64_t> out;
+  forRange(INT64_MIN, INT64_MAX, [&](int64_t at, const std::wstring&) {
+    out = at;
+    return false;
+  });
+  return out;
+}
+
+void NoteTimeIndex::maybeMerge() {
+  // Keep the buffers around sqrt(n) so both mutations and scans stay cheap.
+  const size_t threshold = std::max(kMinMergeThreshold, static_cast<size_t>(std::sqrt(static_cast<double>(m_base.size()))));
+  if (m_delta.size() + m_erased.size() <= threshold) {
+    return;
+  }
+
+  std::vector<Key> merged;
+  merged.reserve(size());
+  auto e = m_erased.begin();
+  auto d = m_delta.begin();
+  for (auto& k : m_base) {
+    while (e != m_erased.end() && *e < k) ++e;
+    if (e != m_erased.end() && *e == k) {
+      ++e;
+      continue;
+    }
+    while (d != m_delta.end() && *d < k) {
+      merged.push_back(std::move(*d));
+      ++d;
+    }
+    merged.push_back(std::move(k));
+  }
+  merged.insert(merged.end(), std::make_move_iterator(d), std::make_move_iterator(m_delta.end()));
+
+  m_base = std::move(merged);
+  m_delta.clear();
+  m_erased.clear();
+}
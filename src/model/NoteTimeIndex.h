@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Ordered (scheduledAtUtcMs, id) keys: a sorted base vector plus a small sorted
+// delta buffer of recent inserts and a sorted list of erased base keys.
+// Range scans are O(log n + k); mutations are O(delta) with a periodic O(n) merge.
+class NoteTimeIndex {
+public:
+  using Key = std::pair<int64_t, std::wstring>;
+
+  void clear();
+
+  void insert(int64_t atUtcMs, const std::wstring& id);
+  void erase(int64_t atUtcMs, const std::wstring& id);
+
+  size_t size() const { return m_base.size() + m_delta.size() - m_erased.size(); }
+  bool empty() const { return size() == 0; }
+
+  std::optional<int64_t> firstUtcMs() const;
+
+  // Visits keys with fromUtcMs <= at < toUtcMs in ascending order.
+  // fn(int64_t atUtcMs, const std::wstring& id) returns false to stop early.
+  template <class Fn>
+  void forRange(int64_t fromUtcMs, int64_t toUtcMs, Fn&& fn) const {
+    if (fromUtcMs >= toUtcMs) return;
+
+    const auto lower = [](const Key& k, int64_t t) { return k.first < t; };
+    auto b = std::lower_bound(m_base.begin(), m_base.end(), fromUtcMs, lower);
+    auto d = std::lower_bound(m_delta.begin(), m_delta.end(), fromUtcMs, lower);
+    auto e = std::lower_bound(m_erased.begin(), m_erased.end(), fromUtcMs, lower);
+
+    while (true) {
+      // Skip erased base keys (both lists are sorted, so walk them together).
+      while (b != m_base.end()) {
+        while (e != m_erased.end() && *e < *b) ++e;
+        if (e == m_erased.end() || !(*e == *b)) break;
+        ++b;
+        ++e;
+      }
+
+      const bool haveB = b != m_base.end() && b->first < toUtcMs;
+      const bool haveD = d != m_delta.end() && d->first < toUtcMs;
+      if (!haveB && !haveD) return;
+
+      const Key* k = nullptr;
+      if (haveB && (!haveD || *b < *d)) {
+        k = &*b;
+        ++b;
+      } else {
+        k = &*d;
+        ++d;
+      }
+      if (!fn(k->first, k->second)) return;
+    }
+  }
+
+private:
+  void maybeMerge();
+
+  std::vector<Key> m_base;
+  std::vector<Key> m_delta;
+  std::vector<Key> m_erased; // subset of m_base
+};
@@ -0,0 +1,43 @@
+#include "NotificationQueue.h"
+
+#include <algorithm>
+
+NotificationQueue::NotificationQueue(int maxWindows) : m_maxWindows(std::max(1, maxWindows)) {}
+
+NotificationQueue::Dispatch NotificationQueue::push(std::vector<NoteSummary> due) {
+  Dispatch d;
+  if (due.empty()) {
+    return d;
+  }
+
+  std::sort(due.begin(), due.end(), [](const NoteSummary& a, const NoteSummary& b) {
+    if (a.importance != b.importance) return a.importance > b.importance;
+    if (a.scheduledAtUtcMs != b.scheduledAtUtcMs) return a.scheduledAtUtcMs < b.scheduledAtUtcMs;
+    return a.id < b.id;
+  });
+  d.soundImportance = due.front().importance;
+
+  // An open digest takes a slot; a new one needs a slot of its own when the
+  // burst doesn't fit.
+  const size_t freeSlots = static_cast<size_t>(std::max(0, m_maxWindows - m_popups - (m_digestOpen ? 1 : 0)));
+  size_t popups = due.size();
+  if (popups > freeSlots) {
+    popups = m_digestOpen || freeSlots == 0 ? freeSlots : freeSlots - 1;
+  }
+
+  d.popups.assign(std::make_move_iterator(due.begin()), std::make_move_iterator(due.begin() + popups));
+  d.digest.assign(std::make_move_iterator(due.begin() + popups), std::make_move_iterator(due.end()));
+  d.openDigest = !d.digest.empty() && !m_digestOpen;
+
+  m_popups += static_cast<int>(popups);
+  m_digestOpen = m_digestOpen || !d.digest.empty();
+  return d;
+}
+
+void NotificationQueue::popupClosed() {
+  m_popups = std::max(0, m_popups - 1);
+}
+
+void NotificationQueue::digestClosed() {
+  m_digestOpen = false;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "model/Note.h"
+
+#include <vector>
+
+// Decides how due reminders are shown. At most maxWindows notification windows
+// are on screen at once, the most important (then earliest) notes get their own
+// window, and whatever doesn't fit is coalesced into a single digest window
+// (merged into the open one, if any). A backlog of any size after sleep or
+// downtime is therefore dispatched in one pass with one sound, and nothing is
+// dropped: the digest is shown even when every slot is taken.
+//
+// Pure bookkeeping without Win32: the UI shows what push() returns and reports
+// windows closing.
+class NotificationQueue {
+public:
+  struct Dispatch {
+    std::vector<NoteSummary> popups; // one window each, in this order
+    std::vector<NoteSummary> digest; // lines for the digest window, in this order
+    bool openDigest = false;         // digest is non-empty and no digest window is open yet
+    int soundImportance = -1;        // one sound for the whole dispatch; -1 = silent
+  };
+
+  explicit NotificationQueue(int maxWindows = 3);
+
+  // Takes the reminders found due (in any order) and returns what to show.
+  Dispatch push(std::vector<NoteSummary> due);
+
+  void popupClosed();
+  void digestClosed();
+
+  int popupsOnScreen() const { return m_popups; }
+  bool digestOnScreen() const { return m_digestOpen; }
+
+private:
+  int m_maxWindows;
+  int m_popups = 0;
+  bool m_digestOpen = false;
+};
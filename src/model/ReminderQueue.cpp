@@ -0,0 +1,52 @@
+#include "ReminderQueue.h"
+
+void ReminderQueue::clear() {
+  m_order.clear();
+  m_dueById.clear();
+}
+
+bool ReminderQueue::track(const NoteSummary& note) {
+  if (!isPending(note)) {
+    return remove(note.id);
+  }
+
+  auto it = m_dueById.find(note.id);
+  if (it != m_dueById.end()) {
+    if (it->second == note.scheduledAtUtcMs) {
+      return false;
+    }
+    m_order.erase(it->second, note.id);
+    it->second = note.scheduledAtUtcMs;
+  } else {
+    m_dueById.emplace(note.id, note.scheduledAtUtcMs);
+  }
+  m_order.insert(note.scheduledAtUtcMs, note.id);
+  return true;
+}
+
+bool ReminderQueue::remove(const std::wstring& id) {
+  auto it = m_dueById.find(id);
+  if (it == m_dueById.end()) {
+    return false;
+  }
+  m_order.erase(it->second, id);
+  m_dueById.erase(it);
+  return true;
+}
+
+std::optional<int64_t> ReminderQueue::nextDueUtcMs() const {
+  return m_order.firstUtcMs();
+}
+
+std::vector<std::wstring> ReminderQueue::due(int64_t nowUtcMs, size_t limit) const {
+  std::vector<std::wstring> out;
+  if (limit == 0) {
+    return out;
+  }
+  const int64_t endUtcMs = (nowUtcMs == INT64_MAX) ? INT64_MAX : nowUtcMs + 1;
+  m_order.forRange(INT64_MIN, endUtcMs, [&](int64_t, const std::wstring& id) {
+    out.push_back(id);
+    return out.size() < limit;
+  });
+  return out;
+}
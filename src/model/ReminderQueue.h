@@ -0,0 +1,38 @@
+#pragma once
+
+#include "model/Note.h"
+#include "model/NoteTimeIndex.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Pending (not yet fired) reminders ordered by scheduledAtUtcMs.
+// The UI arms a single timer for nextDueUtcMs() instead of polling the store.
+class ReminderQueue {
+public:
+  void clear();
+
+  // Queues the note if it is still pending, otherwise drops it from the queue.
+  // Returns true if the queue changed.
+  bool track(const NoteSummary& note);
+  bool remove(const std::wstring& id);
+
+  std::optional<int64_t> nextDueUtcMs() const;
+
+  // Ids of notes with scheduledAtUtcMs <= nowUtcMs, earliest first.
+  std::vector<std::wstring> due(int64_t nowUtcMs, size_t limit) const;
+
+  size_t size() const { return m_dueById.size(); }
+
+  static bool isPending(const NoteSummary& note) {
+    return !note.hasFired && note.scheduledAtUtcMs != 0;
+  }
+
+private:
+  NoteTimeIndex m_order;
+  std::unordered_map<std::wstring, int64_t> m_dueById;
+};
@@ -0,0 +1,298 @@
+#include "SearchIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+namespace {
+constexpr uint32_t kTitleWeight = 3;
+constexpr size_t kMaxTermLength = 40; // longer runs are hashes, base64 and the like
+constexpr size_t kMinPrefixLength = 2;
+constexpr size_t kMaxPrefixTerms = 32; // most frequent completions of a prefix
+constexpr double kK1 = 1.2;
+constexpr double kB = 0.75;
+
+struct TermCount {
+  uint32_t term = 0;
+  uint32_t tf = 0;
+};
+
+constexpr wchar_t kSeparator = 0;
+constexpr wchar_t kIgnored = 1;
+
+// Lowercase form of a word character, kSeparator for anything that splits words,
+// kIgnored for marks inside words.
+wchar_t fold(wchar_t c) {
+  if ((c >= L'a' && c <= L'z') || (c >= L'0' && c <= L'9')) return c;
+  if (c >= L'A' && c <= L'Z') return static_cast<wchar_t>(c + 32);
+  if (c < 0xC0) return c == 0xAD ? kIgnored : kSeparator; // soft hyphen
+  if (c <= 0xFF) {
+    if (c == 0xD7 || c == 0xF7) return kSeparator; // × ÷
+    return c <= 0xDE ? static_cast<wchar_t>(c + 32) : c;
+  }
+  if (c == 0x0401 || c == 0x0451) return 0x0435; // Ё ё -> е
+  if (c >= 0x0410 && c <= 0x042F) return static_cast<wchar_t>(c + 32);
+  if (c >= 0x0400 && c <= 0x040F) return static_cast<wchar_t>(c + 80);
+  if (c >= 0x0430 && c <= 0x045F) return c;
+  if (c == 0x0301) return kIgnored; // combining acute (stress mark)
+  return kSeparator;
+}
+
+// Calls fn(std::wstring&) for every folded word of text.
+template <class Fn>
+void forEachWord(const std::wstring& text, Fn&& fn) {
+  std::wstring word;
+  bool tooLong = false;
+  auto flush = [&]() {
+    if (!word.empty() && !tooLong) fn(word);
+    word.clear();
+    tooLong = false;
+  };
+  for (const wchar_t c : text) {
+    const wchar_t f = fold(c);
+    if (f == kSeparator) {
+      flush();
+    } else if (f != kIgnored) {
+      if (word.size() < kMaxTermLength) word.push_back(f);
+      else tooLong = true;
+    }
+  }
+  flush();
+}
+
+bool isStopWord(std::wstring_view w) {
+  if (w.size() > 3) return false;
+  static constexpr std::wstring_view kWords[] = {
+    L"а", L"без", L"бы", L"в", L"во", L"да", L"для", L"до", L"же", L"за", L"и", L"из", L"или",
+    L"к", L"как", L"ко", L"ли", L"на", L"над", L"не", L"ни", L"но", L"о", L"об", L"от", L"по",
+    L"под", L"при", L"про", L"с", L"со", L"то", L"у", L"что", L"это",
+    L"a", L"an", L"and", L"at", L"for", L"in", L"is", L"of", L"on", L"or", L"the", L"to",
+  };
+  for (auto s : kWords) {
+    if (w == s) return true;
+  }
+  return false;
+}
+
+bool isCyrillic(wchar_t c) {
+  return c >= 0x0430 && c <= 0x045F;
+}
+
+// Light Russian stemmer: drops the longest common inflection ending that leaves at
+// least three letters. Not linguistically exact, but maps the usual case and
+// number forms of a word to one term, which is what matching needs.
+void stem(std::wstring& w) {
+  if (w.size() < 4 || !isCyrillic(w[0])) return;
+  static constexpr std::wstring_view kEndings[] = {
+    L"иями", L"ться",
+    L"ями", L"ами", L"ого", L"его", L"ому", L"ему", L"ыми", L"ими", L"ешь", L"ете", L"ишь", L"ите", L"ует", L"уют",
+    L"ой", L"ей", L"ий", L"ый", L"ая", L"яя", L"ое", L"ее", L"ие", L"ые", L"ом", L"ем", L"ах", L"ях", L"ов", L"ев",
+    L"ам", L"ям", L"ую", L"юю", L"ть", L"ет", L"ит", L"ут", L"ют", L"ат", L"ят", L"ся", L"ла", L"ло", L"ли", L"ым",
+    L"им", L"ых", L"их",
+    L"а", L"я", L"о", L"е", L"ы", L"и", L"у", L"ю", L"ь", L"й",
+  };
+  const std::wstring_view view(w);
+  for (auto e : kEndings) {
+    if (e.back() == w.back() && w.size() >= e.size() + 3 && view.substr(w.size() - e.size()) == e) {
+      w.resize(w.size() - e.size());
+      return;
+    }
+  }
+}
+} // namespace
+
+std::vector<std::wstring> SearchIndex::terms(const std::wstring& text) {
+  std::vector<std::wstring> out;
+  forEachWord(text, [&](std::wstring& w) {
+    if (isStopWord(w)) return;
+    stem(w);
+    out.push_back(w);
+  });
+  return out;
+}
+
+void SearchIndex::clear() {
+  m_termsSorted.clear();
+  m_termIds.clear();
+  m_postings.clear();
+  m_docs.clear();
+  m_freeDocs.clear();
+  m_slots.clear();
+  m_totalLength = 0;
+}
+
+uint32_t SearchIndex::termId(const std::wstring& term) {
+  auto it = m_termIds.find(term);
+  if (it != m_termIds.end()) return it->second;
+  const auto id = static_cast<uint32_t>(m_postings.size());
+  it = m_termIds.emplace(term, id).first;
+  m_termsSorted.emplace(it->first, id);
+  m_postings.emplace_back();
+  return id;
+}
+
+void SearchIndex::put(const std::wstring& id, const std::wstring& title, const std::wstring& text) {
+  erase(id);
+
+  // (term id, weight) per word, then summed per term.
+  std::vector<TermCount> counts;
+  uint32_t length = 0;
+  auto count = [&](const std::wstring& source, uint32_t weight) {
+    forEachWord(source, [&](std::wstring& w) {
+      if (isStopWord(w)) return;
+      stem(w);
+      counts.push_back(TermCount{ termId(w), weight });
+      length += weight;
+    });
+  };
+  count(title, kTitleWeight);
+  count(text, 1);
+  std::sort(counts.begin(), counts.end(), [](const TermCount& a, const TermCount& b) { return a.term < b.term; });
+  size_t distinct = 0;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    if (distinct > 0 && counts[distinct - 1].term == counts[i].term) {
+      counts[distinct - 1].tf += counts[i].tf;
+    } else {
+      counts[distinct++] = counts[i];
+    }
+  }
+  counts.resize(distinct);
+
+  uint32_t slot;
+  if (!m_freeDocs.empty()) {
+    slot = m_freeDocs.back();
+    m_freeDocs.pop_back();
+  } else {
+    slot = static_cast<uint32_t>(m_docs.size());
+    m_docs.emplace_back();
+  }
+  Doc& doc = m_docs[slot];
+  doc.id = id;
+  doc.length = length;
+  doc.terms.clear();
+  doc.terms.reserve(counts.size());
+  for (const auto& [t, tf] : counts) {
+    doc.terms.push_back(t);
+    auto& list = m_postings[t];
+    if (list.empty() || list.back().doc < slot) {
+      list.push_back(Posting{ slot, tf }); // new slots are the highest so far
+    } else {
+      auto pos = std::lower_bound(list.begin(), list.end(), slot,
+                                  [](const Posting& p, uint32_t d) { return p.doc < d; });
+      list.insert(pos, Posting{ slot, tf });
+    }
+  }
+  m_totalLength += length;
+  m_slots.emplace(id, slot);
+}
+
+void SearchIndex::erase(const std::wstring& id) {
+  auto it = m_slots.find(id);
+  if (it == m_slots.end()) return;
+  removeDoc(it->second);
+  m_slots.erase(it);
+}
+
+void SearchIndex::removeDoc(uint32_t slot) {
+  Doc& doc = m_docs[slot];
+  for (const uint32_t t : doc.terms) {
+    auto& list = m_postings[t];
+    auto pos = std::lower_bound(list.begin(), list.end(), slot,
+                                [](const Posting& p, uint32_t d) { return p.doc < d; });
+    if (pos != list.end() && pos->doc == slot) {
+      list.erase(pos);
+    }
+  }
+  m_totalLength -= doc.length;
+  doc = Doc{};
+  m_freeDocs.push_back(slot);
+}
+
+std::vector<SearchIndex::Hit> SearchIndex::search(const std::wstring& query, size_t limit) const {
+  if (limit == 0 || m_slots.empty()) return {};
+
+  // One group of term ids per query word: its stem, plus completions of the last word.
+  std::vector<std::wstring> words;
+  forEachWord(query, [&](std::wstring& w) { words.push_back(w); });
+  const bool prefixLast = !query.empty() && fold(query.back()) != kSeparator;
+
+  std::vector<std::vector<uint32_t>> groups;
+  for (size_t i = 0; i < words.size(); ++i) {
+    std::wstring w = words[i];
+    const bool prefix = prefixLast && i + 1 == words.size() && w.size() >= kMinPrefixLength;
+    if (isStopWord(w) && !prefix) continue;
+
+    std::vector<uint32_t> group;
+    if (prefix) {
+      for (auto it = m_termsSorted.lower_bound(w); it != m_termsSorted.end() && it->first.starts_with(w); ++it) {
+        if (!m_postings[it->second].empty()) group.push_back(it->second);
+      }
+      if (group.size() > kMaxPrefixTerms) {
+        std::nth_element(group.begin(), group.begin() + kMaxPrefixTerms, group.end(), [&](uint32_t a, uint32_t b) {
+          return m_postings[a].size() > m_postings[b].size();
+        });
+        group.resize(kMaxPrefixTerms);
+      }
+    }
+    stem(w);
+    auto exact = m_termIds.find(w);
+    if (exact != m_termIds.end() && !m_postings[exact->second].empty() &&
+        std::find(group.begin(), group.end(), exact->second) == group.end()) {
+      group.push_back(exact->second);
+    }
+    if (group.empty()) {
+      return {}; // a word nothing matches: no document has all of them
+    }
+    groups.push_back(std::move(group));
+  }
+  if (groups.empty()) return {};
+
+  // Rarest word first: later words only touch documents that matched so far.
+  auto df = [&](const std::vector<uint32_t>& g) {
+    size_t n = 0;
+    for (const uint32_t t : g) n += m_postings[t].size();
+    return n;
+  };
+  std::sort(groups.begin(), groups.end(), [&](const auto& a, const auto& b) { return df(a) < df(b); });
+
+  const double docCount = static_cast<double>(m_slots.size());
+  const double avgLength = std::max(1.0, static_cast<double>(m_totalLength) / docCount);
+  std::vector<float> scores(m_docs.size(), 0.0f);
+  std::vector<uint16_t> matched(m_docs.size(), 0); // groups matched so far
+  std::vector<uint32_t> candidates;
+
+  for (size_t g = 0; g < groups.size(); ++g) {
+    const auto round = static_cast<uint16_t>(g);
+    for (const uint32_t t : groups[g]) {
+      const auto& list = m_postings[t];
+      const double n = static_cast<double>(list.size());
+      const double idf = std::log(1.0 + (docCount - n + 0.5) / (n + 0.5));
+      for (const Posting& p : list) {
+        uint16_t& m = matched[p.doc];
+        if (m != round && m != round + 1) continue; // missed an earlier word
+        const double tf = p.tf;
+        const double norm = kK1 * (1.0 - kB + kB * m_docs[p.doc].length / avgLength);
+        scores[p.doc] += static_cast<float>(idf * tf * (kK1 + 1.0) / (tf + norm));
+        if (m == round) {
+          m = round + 1;
+          if (g == 0) candidates.push_back(p.doc);
+        }
+      }
+    }
+  }
+
+  const auto all = static_cast<uint16_t>(groups.size());
+  candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                  [&](uint32_t d) { return matched[d] != all; }),
+                   candidates.end());
+  auto better = [&](uint32_t a, uint32_t b) { return scores[a] != scores[b] ? scores[a] > scores[b] : a < b; };
+  const size_t n = std::min(limit, candidates.size());
+  std::partial_sort(candidates.begin(), candidates.begin() + n, candidates.end(), better);
+
+  std::vector<Hit> hits;
+  hits.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    hits.push_back(Hit{ m_docs[candidates[i]].id, scores[candidates[i]] });
+  }
+  return hits;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Full-text index over note titles and content text: an inverted index
+// (term -> postings sorted by document) ranked with BM25. Kept resident and
+// updated per note by NoteRepository, which also guards it (not thread-safe).
+//
+// Tokens are runs of letters and digits (Latin, Latin-1, Cyrillic), lowercased
+// with ё folded to е; stress marks and soft hyphens don't split words. Russian
+// words lose one inflection ending ("встреча", "встречи", "встречами" are one
+// term) and a short list of stop words is not indexed.
+class SearchIndex {
+public:
+  struct Hit {
+    std::wstring id;
+    double score = 0;
+  };
+
+  void clear();
+
+  // Inserts or replaces the document for id. Title words weigh more than body words.
+  void put(const std::wstring& id, const std::wstring& title, const std::wstring& text);
+  void erase(const std::wstring& id);
+  bool contains(const std::wstring& id) const { return m_slots.count(id) != 0; }
+  size_t size() const { return m_slots.size(); }
+
+  // Best matches first, at most limit. Every query word must match; the last one
+  // also matches as a prefix (search as you type) unless the query ends with a space.
+  std::vector<Hit> search(const std::wstring& query, size_t limit) const;
+
+  // Index terms of text, in order (with repeats).
+  static std::vector<std::wstring> terms(const std::wstring& text);
+
+private:
+  struct Posting {
+    uint32_t doc = 0;
+    uint32_t tf = 0; // title words count kTitleWeight times
+  };
+  struct Doc {
+    std::wstring id;
+    uint32_t length = 0;
+    std::vector<uint32_t> terms; // distinct term ids
+  };
+
+  uint32_t termId(const std::wstring& term);
+  void removeDoc(uint32_t doc);
+
+  std::unordered_map<std::wstring, uint32_t> m_termIds;
+  std::map<std::wstring_view, uint32_t> m_termsSorted; // keys of m_termIds, for prefix lookups
+  std::vector<std::vector<Posting>> m_postings;        // by term id
+  std::vector<Doc> m_docs;                                 // by slot; empty id = free
+  std::vector<uint32_t> m_freeDocs;
+  std::unordered_map<std::wstring, uint32_t> m_slots;      // note id -> slot
+  uint64_t m_totalLength = 0;
+};
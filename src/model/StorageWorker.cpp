@@ -0,0 +1,134 @@
+#include "StorageWorker.h"
+
+#include "core/FileIo.h"
+#include "core/Utf8.h"
+#include "model/NoteStore.h"
+
+#include <exception>
+#include <unordered_map>
+
+StorageWorker::StorageWorker(NoteStore& store, std::function<void()> onCompleted)
+    : m_store(store), m_onCompleted(std::move(onCompleted)) {
+  m_thread = std::thread([this]() { run(); });
+}
+
+StorageWorker::~StorageWorker() {
+  push(new Node{});
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+uint64_t StorageWorker::post(std::shared_ptr<const Note> note) {
+  Node* node = new Node{};
+  node->note = std::move(note);
+  node->seq = m_posted.fetch_add(1) + 1;
+  const uint64_t seq = node->seq;
+  push(node);
+  return seq;
+}
+
+void StorageWorker::push(Node* node) {
+  Node* head = m_head.load(std::memory_order_relaxed);
+  do {
+    node->next = head;
+  } while (!m_head.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+  m_head.notify_one();
+}
+
+void StorageWorker::drain() {
+  const uint64_t target = m_posted.load();
+  for (uint64_t written = m_written.load(); written < target; written = m_written.load()) {
+    m_written.wait(written);
+  }
+}
+
+std::vector<StorageWorker::Result> StorageWorker::takeResults() {
+  std::lock_guard<std::mutex> lock(m_resultsMutex);
+  std::vector<Result> out;
+  out.swap(m_results);
+  return out;
+}
+
+void StorageWorker::run() {
+  bool stop = false;
+  while (!stop) {
+    m_head.wait(nullptr, std::memory_order_acquire);
+    Node* list = m_head.exchange(nullptr, std::memory_order_acquire);
+
+    // The list is newest-first; restore posting order and pick out the stop request
+    // (saves queued before it are still written).
+    Node* ordered = nullptr;
+    while (list) {
+      Node* next = list->next;
+      if (!list->note) {
+        stop = true;
+        delete list;
+      } else {
+        list->next = ordered;
+        ordered = list;
+      }
+      list = next;
+    }
+    if (ordered) {
+      writeAll(ordered);
+    }
+  }
+}
+
+void StorageWorker::writeAll(Node* list) {
+  std::vector<Node*> nodes;
+  std::unordered_map<std::wstring, Node*> latest;
+  for (Node* n = list; n; n = n->next) {
+    nodes.push_back(n);
+    latest[n->note->id] = n;
+  }
+
+  struct Outcome {
+    bool ok = false;
+    std::wstring error;
+  };
+  std::unordered_map<std::wstring, Outcome> outcomes;
+  outcomes.reserve(latest.size());
+  {
+    FileIo::DeferredSync sync; // one group commit for the whole drain
+    for (Node* n : nodes) {
+      if (latest[n->note->id] != n) continue;
+      Outcome& o = outcomes[n->note->id];
+      try {
+        o.ok = m_store.write(*n->note, &o.error);
+      } catch (const std::exception& e) {
+        o.ok = false;
+        o.error = L"Ошибка записи заметки: " + Utf8::toWide(e.what());
+      }
+    }
+    std::wstring error;
+    if (!sync.commit(&error)) {
+      for (auto& [id, o] : outcomes) {
+        if (o.ok) {
+          o.ok = false;
+          o.error = error;
+        }
+      }
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_resultsMutex);
+    for (Node* n : nodes) {
+      const Outcome& o = outcomes[n->note->id];
+      m_results.push_back(Result{ n->note->id, n->seq, o.ok, o.error });
+    }
+  }
+
+  const uint64_t count = nodes.size();
+  for (Node* n : nodes) {
+    delete n;
+  }
+  m_written.fetch_add(count);
+  m_written.notify_all();
+
+  if (m_onCompleted) {
+    m_onCompleted();
+  }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "model/Note.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class NoteStore;
+
+// Background writer for full note saves (editor autosave).
+//
+// post() pushes an immutable note snapshot onto a lock-free intrusive list (any
+// thread, never blocks). The worker takes the whole list at once, keeps only the
+// newest snapshot per note id and writes those through the store; superseded saves
+// share the outcome of the write that replaced them. Results are collected for
+// takeResults() and announced through onCompleted (called on the worker thread).
+class StorageWorker {
+public:
+  struct Result {
+    std::wstring id;
+    uint64_t seq = 0;
+    bool ok = false;
+    std::wstring error;
+  };
+
+  StorageWorker(NoteStore& store, std::function<void()> onCompleted);
+  // Writes everything still queued, then stops the thread.
+  ~StorageWorker();
+
+  StorageWorker(const StorageWorker&) = delete;
+  StorageWorker& operator=(const StorageWorker&) = delete;
+
+  // Returns the save's sequence number (increasing per post).
+  uint64_t post(std::shared_ptr<const Note> note);
+  // Blocks until every save posted before the call has been written.
+  void drain();
+  std::vector<Result> takeResults();
+
+private:
+  struct Node {
+    std::shared_ptr<const Note> note; // null: stop request
+    uint64_t seq = 0;
+    Node* next = nullptr;
+  };
+
+  void push(Node* node);
+  void run();
+  void writeAll(Node* list); // list in posting order
+
+  NoteStore& m_store;
+  std::function<void()> m_onCompleted;
+
+  std::atomic<Node*> m_head{ nullptr };
+  std::atomic<uint64_t> m_posted{ 0 };
+  std::atomic<uint64_t> m_written{ 0 };
+
+  std::mutex m_resultsMutex;
+  std::vector<Result> m_results;
+
+  std::thread m_thread;
+};
@@ -1,147 +1,306 @@
 #include "AppSettings.h"
 
+#include "settings/SettingsStore.h"
+
+#ifdef _WIN32
 #include "settings/AutostartWin.h"
-#include "win/WinUtil.h"
+#include "settings/RegistrySettingsStore.h"
+#else
+#include "settings/FileSettingsStore.h"
+
+#include <cstdlib>
+#endif
 
-#include <windows.h>
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace {
-constexpr const wchar_t* kSettingsKeyPath = L"Software\\AlertCalendar";
+using Key = AppSettings::Key;
 
-DWORD readDwordValue(const wchar_t* name, DWORD def) {
-  HKEY hKey = nullptr;
-  if (RegOpenKeyExW(HKEY_CURRENT_USER, kSettingsKeyPath, 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
-    return def;
-  }
-  DWORD type = 0;
-  DWORD data = 0;
-  DWORD size = sizeof(DWORD);
-  const LONG r = RegQueryValueExW(hKey, name, nullptr, &type, reinterpret_cast<LPBYTE>(&data), &size);
-  RegCloseKey(hKey);
-  if (r != ERROR_SUCCESS || type != REG_DWORD) {
-    return def;
+struct KeySpec {
+  const wchar_t* name; // registry value / file key
+  bool isString;
+  uint32_t number;     // default of a number
+  const wchar_t* text; // default of a string
+};
+
+// Indexed by AppSettings::Key.
+constexpr std::array kKeys{
+  KeySpec{ L"MinimizeToTray", false, 1, nullptr },
+  KeySpec{ L"ZoomPercent", false, 100, nullptr },
+  KeySpec{ L"ThemeStyle", false, 0, nullptr },
+  KeySpec{ L"StorageBackend", false, 0, nullptr },
+  KeySpec{ L"StorageSyncMode", false, 1, nullptr },
+  KeySpec{ L"StorageSyncGroupMs", false, 1000, nullptr },
+  KeySpec{ L"SoundEnabled", false, 1, nullptr },
+  KeySpec{ L"SoundNormal", true, 0, L"SystemAsterisk" },
+  KeySpec{ L"SoundImportant", true, 0, L"SystemExclamation" },
+  KeySpec{ L"SoundUrgent", true, 0, L"SystemHand" },
+};
+static_assert(kKeys.size() == static_cast<size_t>(Key::SoundUrgent) + 1, "one KeySpec per AppSettings::Key");
+
+struct SettingsState {
+  std::mutex mutex;
+  std::unique_ptr<SettingsStore> store;
+  bool loaded = false;
+  std::array<SettingValue, kKeys.size()> values;
+
+  int nextSubscription = 1;
+  std::vector<std::pair<int, AppSettings::ChangeCallback>> subscribers;
+};
+
+SettingsState& state() {
+  static SettingsState s;
+  return s;
+}
+
+// Open AppSettings::Batch scopes on this thread and the keys they changed.
+thread_local int t_batchDepth = 0;
+thread_local std::vector<Key> t_batchKeys;
+
+std::unique_ptr<SettingsStore> defaultStore() {
+#ifdef _WIN32
+  return std::make_unique<RegistrySettingsStore>();
+#else
+  std::filesystem::path dir;
+  if (const char* xdg = std::getenv("XDG_CONFIG_HOME"); xdg && *xdg) {
+    dir = xdg;
+  } else if (const char* home = std::getenv("HOME"); home && *home) {
+    dir = std::filesystem::path(home) / ".config";
   }
-  return data;
+  return std::make_unique<FileSettingsStore>(dir / "AlertCalendar" / "settings.txt");
+#endif
 }
 
-void writeDwordValue(const wchar_t* name, DWORD value) {
-  HKEY hKey = nullptr;
-  if (RegCreateKeyExW(HKEY_CURRENT_USER, kSettingsKeyPath, 0, nullptr, 0, KEY_SET_VALUE, nullptr, &hKey, nullptr) !=
-      ERROR_SUCCESS) {
-    return;
+// Values missing from the store, or stored with another type, read as the default.
+void loadLocked(SettingsState& s) {
+  if (!s.store) s.store = defaultStore();
+  std::unordered_map<std::wstring, SettingValue> stored;
+  s.store->loadAll(stored, nullptr);
+  for (size_t i = 0; i < kKeys.size(); ++i) {
+    const KeySpec& spec = kKeys[i];
+    const auto it = stored.find(spec.name);
+    const bool usable = it != stored.end() && std::holds_alternative<std::wstring>(it->second) == spec.isString;
+    if (usable) {
+      s.values[i] = std::move(it->second);
+    } else if (spec.isString) {
+      s.values[i] = std::wstring(spec.text);
+    } else {
+      s.values[i] = spec.number;
+    }
   }
-  RegSetValueExW(hKey, name, 0, REG_DWORD, reinterpret_cast<const BYTE*>(&value), sizeof(DWORD));
-  RegCloseKey(hKey);
+  s.loaded = true;
+}
+
+SettingsState& loadedState(std::unique_lock<std::mutex>& lock) {
+  SettingsState& s = state();
+  lock = std::unique_lock<std::mutex>(s.mutex);
+  if (!s.loaded) loadLocked(s);
+  return s;
+}
+
+uint32_t number(Key key) {
+  std::unique_lock<std::mutex> lock;
+  return std::get<uint32_t>(loadedState(lock).values[static_cast<size_t>(key)]);
 }
 
-std::wstring readStringValue(const wchar_t* name, const std::wstring& def) {
-  HKEY hKey = nullptr;
-  if (RegOpenKeyExW(HKEY_CURRENT_USER, kSettingsKeyPath, 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
-    return def;
+std::wstring text(Key key) {
+  std::unique_lock<std::mutex> lock;
+  return std::get<std::wstring>(loadedState(lock).values[static_cast<size_t>(key)]);
+}
+
+// Runs the callbacks outside the lock, so they may read or change settings.
+void notify(const std::vector<Key>& keys) {
+  if (keys.empty()) return;
+  std::vector<AppSettings::ChangeCallback> callbacks;
+  {
+    SettingsState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    for (const auto& sub : s.subscribers) callbacks.push_back(sub.second);
+  }
+  for (const Key key : keys) {
+    for (const auto& fn : callbacks) fn(key);
   }
+}
 
-  DWORD type = 0;
-  DWORD size = 0;
-  LONG r = RegQueryValueExW(hKey, name, nullptr, &type, nullptr, &size);
-  if (r != ERROR_SUCCESS || (type != REG_SZ && type != REG_EXPAND_SZ) || size < sizeof(wchar_t)) {
-    RegCloseKey(hKey);
-    return def;
+void set(Key key, SettingValue value) {
+  std::vector<SettingChange> changes;
+  {
+    std::unique_lock<std::mutex> lock;
+    SettingsState& s = loadedState(lock);
+    SettingValue& current = s.values[static_cast<size_t>(key)];
+    if (current == value) return;
+    current = std::move(value);
+    if (t_batchDepth > 0) {
+      if (std::find(t_batchKeys.begin(), t_batchKeys.end(), key) == t_batchKeys.end()) t_batchKeys.push_back(key);
+      return;
+    }
+    changes.push_back({ kKeys[static_cast<size_t>(key)].name, current });
+    s.store->write(changes, nullptr);
   }
+  notify({ key });
+}
 
-  std::wstring out;
-  out.resize(size / sizeof(wchar_t));
-  r = RegQueryValueExW(hKey, name, nullptr, &type, reinterpret_cast<LPBYTE>(out.data()), &size);
-  RegCloseKey(hKey);
-  if (r != ERROR_SUCCESS) {
-    return def;
+// Writes the keys changed in the outermost batch and reports them.
+void commitBatch() {
+  std::vector<Key> keys;
+  keys.swap(t_batchKeys);
+  if (keys.empty()) return;
+  {
+    std::unique_lock<std::mutex> lock;
+    SettingsState& s = loadedState(lock);
+    std::vector<SettingChange> changes;
+    changes.reserve(keys.size());
+    for (const Key key : keys) {
+      changes.push_back({ kKeys[static_cast<size_t>(key)].name, s.values[static_cast<size_t>(key)] });
+    }
+    s.store->write(changes, nullptr);
   }
+  notify(keys);
+}
+} // namespace
+
+void AppSettings::useStore(std::unique_ptr<SettingsStore> store) {
+  SettingsState& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  s.store = std::move(store);
+  loadLocked(s);
+}
 
-  // Trim trailing nulls
-  while (!out.empty() && out.back() == L'\0') out.pop_back();
-  return out.empty() ? def : out;
+AppSettings::Batch::Batch() {
+  ++t_batchDepth;
 }
 
-void writeStringValue(const wchar_t* name, const std::wstring& value) {
-  HKEY hKey = nullptr;
-  if (RegCreateKeyExW(HKEY_CURRENT_USER, kSettingsKeyPath, 0, nullptr, 0, KEY_SET_VALUE, nullptr, &hKey, nullptr) !=
-      ERROR_SUCCESS) {
-    return;
+AppSettings::Batch::~Batch() {
+  if (--t_batchDepth == 0) {
+    commitBatch();
   }
-  const std::wstring v = value; // ensure null-terminated write
-  const DWORD size = static_cast<DWORD>((v.size() + 1) * sizeof(wchar_t));
-  RegSetValueExW(hKey, name, 0, REG_SZ, reinterpret_cast<const BYTE*>(v.c_str()), size);
-  RegCloseKey(hKey);
 }
-} // namespace
+
+int AppSettings::subscribe(ChangeCallback fn) {
+  SettingsState& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  const int id = s.nextSubscription++;
+  s.subscribers.emplace_back(id, std::move(fn));
+  return id;
+}
+
+void AppSettings::unsubscribe(int id) {
+  SettingsState& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  std::erase_if(s.subscribers, [id](const auto& sub) { return sub.first == id; });
+}
 
 bool AppSettings::minimizeToTray() {
-  return readDwordValue(L"MinimizeToTray", 1) != 0;
+  return number(Key::MinimizeToTray) != 0;
 }
 
 void AppSettings::setMinimizeToTray(bool enabled) {
-  writeDwordValue(L"MinimizeToTray", enabled ? 1 : 0);
+  set(Key::MinimizeToTray, uint32_t{ enabled ? 1u : 0u });
 }
 
 int AppSettings::uiZoomPercent() {
-  return static_cast<int>(readDwordValue(L"ZoomPercent", 100));
+  return static_cast<int>(number(Key::ZoomPercent));
 }
 
 void AppSettings::setUiZoomPercent(int percent) {
   if (percent < 50) percent = 50;
   if (percent > 250) percent = 250;
-  writeDwordValue(L"ZoomPercent", static_cast<DWORD>(percent));
+  set(Key::ZoomPercent, static_cast<uint32_t>(percent));
 }
 
 int AppSettings::uiThemeStyle() {
-  const DWORD v = readDwordValue(L"ThemeStyle", 0);
-  return static_cast<int>(v);
+  return static_cast<int>(number(Key::ThemeStyle));
 }
 
 void AppSettings::setUiThemeStyle(int style) {
   if (style < 0) style = 0;
   if (style > 1) style = 1;
-  writeDwordValue(L"ThemeStyle", static_cast<DWORD>(style));
+  set(Key::ThemeStyle, static_cast<uint32_t>(style));
 }
 
+// Autostart is the Run key entry itself, not a stored setting.
 bool AppSettings::autostartEnabled() {
+#ifdef _WIN32
   return AutostartWin::isAutostartEnabled();
+#else
+  return false;
+#endif
 }
 
 void AppSettings::setAutostartEnabled(bool enabled) {
+#ifdef _WIN32
   std::wstring err;
   AutostartWin::setAutostartEnabled(enabled, &err);
+#else
+  (void)enabled;
+#endif
+}
+
+int AppSettings::storageBackend() {
+  return number(Key::StorageBackend) == 1 ? 1 : 0;
+}
+
+void AppSettings::setStorageBackend(int backend) {
+  set(Key::StorageBackend, uint32_t{ backend == 1 ? 1u : 0u });
+}
+
+int AppSettings::storageSyncMode() {
+  const uint32_t v = number(Key::StorageSyncMode);
+  return v <= 2 ? static_cast<int>(v) : 1;
+}
+
+void AppSettings::setStorageSyncMode(int mode) {
+  if (mode < 0) mode = 0;
+  if (mode > 2) mode = 2;
+  set(Key::StorageSyncMode, static_cast<uint32_t>(mode));
+}
+
+int AppSettings::storageSyncGroupMs() {
+  const uint32_t v = number(Key::StorageSyncGroupMs);
+  if (v < 10) return 10;
+  if (v > 60000) return 60000;
+  return static_cast<int>(v);
+}
+
+void AppSettings::setStorageSyncGroupMs(int ms) {
+  if (ms < 10) ms = 10;
+  if (ms > 60000) ms = 60000;
+  set(Key::StorageSyncGroupMs, static_cast<uint32_t>(ms));
 }
 
 bool AppSettings::soundEnabled() {
-  return readDwordValue(L"SoundEnabled", 1) != 0;
+  return number(Key::SoundEnabled) != 0;
 }
 
 void AppSettings::setSoundEnabled(bool enabled) {
-  writeDwordValue(L"SoundEnabled", enabled ? 1 : 0);
+  set(Key::SoundEnabled, uint32_t{ enabled ? 1u : 0u });
 }
 
 std::wstring AppSettings::soundNormal() {
-  return readStringValue(L"SoundNormal", L"SystemAsterisk");
+  return text(Key::SoundNormal);
 }
 
 void AppSettings::setSoundNormal(const std::wstring& value) {
-  writeStringValue(L"SoundNormal", value);
+  set(Key::SoundNormal, value);
 }
 
 std::wstring AppSettings::soundImportant() {
-  return readStringValue(L"SoundImportant", L"SystemExclamation");
+  return text(Key::SoundImportant);
 }
 
 void AppSettings::setSoundImportant(const std::wstring& value) {
-  writeStringValue(L"SoundImportant", value);
+  set(Key::SoundImportant, value);
 }
 
 std::wstring AppSettings::soundUrgent() {
-  return readStringValue(L"SoundUrgent", L"SystemHand");
+  return text(Key::SoundUrgent);
 }
 
 void AppSettings::setSoundUrgent(const std::wstring& value) {
-  writeStringValue(L"SoundUrgent", value);
+  set(Key::SoundUrgent, value);
 }
-
-
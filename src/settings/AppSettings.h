@@ -1,9 +1,54 @@
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <string>
 
+class SettingsStore;
+
+// Application settings. Every stored value is read from the backend once (first
+// access) into an in-memory snapshot, so getters never touch the registry; setters
+// update the snapshot and write through. Safe to call from any thread; change
+// callbacks run on the thread that made the change.
 class AppSettings {
 public:
+  // Stored settings, for change callbacks.
+  enum class Key : int {
+    MinimizeToTray,
+    ZoomPercent,
+    ThemeStyle,
+    StorageBackend,
+    StorageSyncMode,
+    StorageSyncGroupMs,
+    SoundEnabled,
+    SoundNormal,
+    SoundImportant,
+    SoundUrgent,
+  };
+
+  // Replaces the backend and reloads the snapshot from it (headless tools and
+  // tests). Default: the registry (HKCU\Software\AlertCalendar) on Windows, a
+  // settings file elsewhere (see FileSettingsStore).
+  static void useStore(std::unique_ptr<SettingsStore> store);
+
+  // Within the scope, setters on this thread only update the snapshot; the changed
+  // values are written in one backend call (one registry key open) and their
+  // callbacks run once when the outermost scope ends.
+  class Batch {
+  public:
+    Batch();
+    ~Batch();
+
+    Batch(const Batch&) = delete;
+    Batch& operator=(const Batch&) = delete;
+  };
+
+  // fn(key) runs after a setting changed value (setting the same value again is not
+  // a change). Returns an id for unsubscribe().
+  using ChangeCallback = std::function<void(Key key)>;
+  static int subscribe(ChangeCallback fn);
+  static void unsubscribe(int id);
+
   static bool minimizeToTray();
   static void setMinimizeToTray(bool enabled);
 
@@ -17,11 +62,24 @@ public:
   static bool autostartEnabled();
   static void setAutostartEnabled(bool enabled);
 
+  // Note storage backend: 0 = directory per note, 1 = single log file (NoteStorageKind).
+  // Read once at startup.
+  static int storageBackend();
+  static void setStorageBackend(int backend);
+
+  // fsync policy for note files (FileIo::SyncMode): 0 = every write, 1 = grouped
+  // every StorageSyncGroupMs (default), 2 = off. Read once at startup.
+  static int storageSyncMode();
+  static void setStorageSyncMode(int mode);
+  static int storageSyncGroupMs();
+  static void setStorageSyncGroupMs(int ms);
+
   // Sounds
   static bool soundEnabled();
   static void setSoundEnabled(bool enabled);
 
   // Value is either a system alias (e.g. "SystemAsterisk") or a WAV file path, or empty = off.
+  // A level that was never set uses its default alias.
   static std::wstring soundNormal();
   static void setSoundNormal(const std::wstring& value);
   static std::wstring soundImportant();
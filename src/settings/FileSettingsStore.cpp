@@ -0,0 +1,124 @@
+#include "FileSettingsStore.h"
+
+#include "core/Utf8.h"
+
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string_view>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr std::string_view kNumberTag = "dword:";
+constexpr std::string_view kStringTag = "sz:";
+
+bool parseLine(std::string_view line, std::wstring& name, SettingValue& value) {
+  if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+  const size_t eq = line.find('=');
+  if (eq == 0 || eq == std::string_view::npos) return false;
+  const std::string_view rest = line.substr(eq + 1);
+
+  if (rest.substr(0, kNumberTag.size()) == kNumberTag) {
+    const std::string_view digits = rest.substr(kNumberTag.size());
+    uint32_t v = 0;
+    const auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), v);
+    if (ec != std::errc{} || ptr != digits.data() + digits.size()) return false;
+    value = v;
+  } else if (rest.substr(0, kStringTag.size()) == kStringTag) {
+    std::wstring s;
+    Utf8::toWide(rest.substr(kStringTag.size()), s);
+    value = std::move(s);
+  } else {
+    return false;
+  }
+  Utf8::toWide(line.substr(0, eq), name);
+  return true;
+}
+
+std::wstring errorText(const wchar_t* what, const fs::path& p) {
+  return std::wstring(what) + p.wstring();
+}
+} // namespace
+
+FileSettingsStore::FileSettingsStore(fs::path path) : m_path(std::move(path)) {}
+
+bool FileSettingsStore::loadAll(std::unordered_map<std::wstring, SettingValue>& out, std::wstring* errorOut) {
+  out.clear();
+  std::error_code ec;
+  if (!fs::exists(m_path, ec)) return true; // nothing saved yet
+
+  std::ifstream in(m_path, std::ios::binary);
+  if (!in) {
+    if (errorOut) *errorOut = errorText(L"Не удалось открыть файл настроек: ", m_path);
+    return false;
+  }
+  const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+  std::wstring name;
+  SettingValue value;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    size_t end = text.find('\n', pos);
+    if (end == std::string::npos) end = text.size();
+    if (parseLine(std::string_view(text).substr(pos, end - pos), name, value)) {
+      out[name] = std::move(value);
+    }
+    pos = end + 1;
+  }
+  return true;
+}
+
+bool FileSettingsStore::write(const std::vector<SettingChange>& changes, std::wstring* errorOut) {
+  if (changes.empty()) return true;
+
+  std::unordered_map<std::wstring, SettingValue> current;
+  if (!loadAll(current, errorOut)) return false;
+  std::map<std::wstring, SettingValue> merged(current.begin(), current.end());
+  for (const auto& c : changes) {
+    const bool badName = c.name.empty() || c.name.find_first_of(L"=\r\n") != std::wstring::npos;
+    const auto* s = std::get_if<std::wstring>(&c.value);
+    if (badName || (s && s->find_first_of(L"\r\n") != std::wstring::npos)) {
+      if (errorOut) *errorOut = L"Недопустимое значение настройки: " + c.name;
+      return false;
+    }
+    merged[c.name] = c.value;
+  }
+
+  std::string text;
+  for (const auto& [name, value] : merged) {
+    Utf8::appendUtf8(name, text);
+    text += '=';
+    if (const auto* n = std::get_if<uint32_t>(&value)) {
+      text += kNumberTag;
+      text += std::to_string(*n);
+    } else {
+      text += kStringTag;
+      Utf8::appendUtf8(std::get<std::wstring>(value), text);
+    }
+    text += '\n';
+  }
+
+  std::error_code ec;
+  if (m_path.has_parent_path()) fs::create_directories(m_path.parent_path(), ec);
+  fs::path tmp = m_path;
+  tmp += L".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out || !out.write(text.data(), static_cast<std::streamsize>(text.size())) || !out.flush()) {
+      if (errorOut) *errorOut = errorText(L"Не удалось записать файл настроек: ", tmp);
+      out.close();
+      fs::remove(tmp, ec);
+      return false;
+    }
+  }
+  fs::rename(tmp, m_path, ec);
+  if (ec) {
+    if (errorOut) *errorOut = errorText(L"Не удалось записать файл настроек: ", m_path);
+    fs::remove(tmp, ec);
+    return false;
+  }
+  return true;
+}
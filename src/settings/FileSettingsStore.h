@@ -0,0 +1,20 @@
+#pragma once
+
+#include "settings/SettingsStore.h"
+
+#include <filesystem>
+
+// Settings in a UTF-8 text file, for headless and non-Windows builds: one
+// "Name=dword:<decimal>" or "Name=sz:<text>" line per value, sorted by name.
+// Strings cannot contain line breaks; lines that don't parse are ignored.
+// Portable (standard library only); the file is replaced atomically on write.
+class FileSettingsStore final : public SettingsStore {
+public:
+  explicit FileSettingsStore(std::filesystem::path path);
+
+  bool loadAll(std::unordered_map<std::wstring, SettingValue>& out, std::wstring* errorOut) override;
+  bool write(const std::vector<SettingChange>& changes, std::wstring* errorOut) override;
+
+private:
+  std::filesystem::path m_path;
+};
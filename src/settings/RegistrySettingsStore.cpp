@@ -0,0 +1,87 @@
+#include "RegistrySettingsStore.h"
+
+#include <windows.h>
+
+#include <cstring>
+
+namespace {
+std::wstring errorText(const wchar_t* what, const std::wstring& keyPath, LONG code) {
+  return std::wstring(what) + L"HKCU\\" + keyPath + L" (код " + std::to_wstring(code) + L")";
+}
+} // namespace
+
+RegistrySettingsStore::RegistrySettingsStore(std::wstring keyPath) : m_keyPath(std::move(keyPath)) {}
+
+bool RegistrySettingsStore::loadAll(std::unordered_map<std::wstring, SettingValue>& out, std::wstring* errorOut) {
+  out.clear();
+  HKEY hKey = nullptr;
+  const LONG opened = RegOpenKeyExW(HKEY_CURRENT_USER, m_keyPath.c_str(), 0, KEY_QUERY_VALUE, &hKey);
+  if (opened == ERROR_FILE_NOT_FOUND) return true; // nothing saved yet
+  if (opened != ERROR_SUCCESS) {
+    if (errorOut) *errorOut = errorText(L"Не удалось открыть раздел реестра: ", m_keyPath, opened);
+    return false;
+  }
+
+  DWORD maxName = 0;
+  DWORD maxData = 0;
+  RegQueryInfoKeyW(hKey, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &maxName, &maxData, nullptr,
+                   nullptr);
+  std::wstring name(maxName + 1, L'\0');
+  std::wstring data(maxData / sizeof(wchar_t) + 1, L'\0');
+
+  for (DWORD i = 0;; ++i) {
+    DWORD nameLen = static_cast<DWORD>(name.size());
+    DWORD type = 0;
+    DWORD size = static_cast<DWORD>(data.size() * sizeof(wchar_t));
+    const LONG r = RegEnumValueW(hKey, i, name.data(), &nameLen, nullptr, &type, reinterpret_cast<LPBYTE>(data.data()),
+                                 &size);
+    if (r == ERROR_NO_MORE_ITEMS) break;
+    if (r != ERROR_SUCCESS) continue; // e.g. a value added since RegQueryInfoKeyW
+
+    std::wstring key(name.data(), nameLen);
+    if (type == REG_DWORD && size == sizeof(DWORD)) {
+      DWORD v = 0;
+      std::memcpy(&v, data.data(), sizeof v);
+      out[std::move(key)] = static_cast<uint32_t>(v);
+    } else if (type == REG_SZ || type == REG_EXPAND_SZ) {
+      std::wstring s(data.data(), size / sizeof(wchar_t));
+      // Trim trailing nulls
+      while (!s.empty() && s.back() == L'\0') s.pop_back();
+      out[std::move(key)] = std::move(s);
+    }
+  }
+  RegCloseKey(hKey);
+  return true;
+}
+
+bool RegistrySettingsStore::write(const std::vector<SettingChange>& changes, std::wstring* errorOut) {
+  if (changes.empty()) return true;
+  HKEY hKey = nullptr;
+  const LONG created =
+      RegCreateKeyExW(HKEY_CURRENT_USER, m_keyPath.c_str(), 0, nullptr, 0, KEY_SET_VALUE, nullptr, &hKey, nullptr);
+  if (created != ERROR_SUCCESS) {
+    if (errorOut) *errorOut = errorText(L"Не удалось открыть раздел реестра: ", m_keyPath, created);
+    return false;
+  }
+
+  LONG failed = ERROR_SUCCESS;
+  for (const auto& c : changes) {
+    LONG r = ERROR_SUCCESS;
+    if (const auto* n = std::get_if<uint32_t>(&c.value)) {
+      const DWORD v = *n;
+      r = RegSetValueExW(hKey, c.name.c_str(), 0, REG_DWORD, reinterpret_cast<const BYTE*>(&v), sizeof v);
+    } else {
+      const auto& s = std::get<std::wstring>(c.value);
+      const DWORD size = static_cast<DWORD>((s.size() + 1) * sizeof(wchar_t)); // with the terminating null
+      r = RegSetValueExW(hKey, c.name.c_str(), 0, REG_SZ, reinterpret_cast<const BYTE*>(s.c_str()), size);
+    }
+    if (r != ERROR_SUCCESS && failed == ERROR_SUCCESS) failed = r;
+  }
+  RegCloseKey(hKey);
+
+  if (failed != ERROR_SUCCESS) {
+    if (errorOut) *errorOut = errorText(L"Не удалось сохранить настройки в разделе реестра: ", m_keyPath, failed);
+    return false;
+  }
+  return true;
+}
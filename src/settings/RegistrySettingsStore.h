@@ -0,0 +1,16 @@
+#pragma once
+
+#include "settings/SettingsStore.h"
+
+// Values under HKEY_CURRENT_USER\<keyPath>: numbers as REG_DWORD, strings as REG_SZ
+// (REG_EXPAND_SZ read as is). Values of any other type are skipped.
+class RegistrySettingsStore final : public SettingsStore {
+public:
+  explicit RegistrySettingsStore(std::wstring keyPath = L"Software\\AlertCalendar");
+
+  bool loadAll(std::unordered_map<std::wstring, SettingValue>& out, std::wstring* errorOut) override;
+  bool write(const std::vector<SettingChange>& changes, std::wstring* errorOut) override;
+
+private:
+  std::wstring m_keyPath;
+};
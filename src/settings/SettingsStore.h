@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+// A stored setting: a 32-bit number (REG_DWORD) or a string (REG_SZ).
+using SettingValue = std::variant<uint32_t, std::wstring>;
+
+// One staged write of a batch (see SettingsStore::write).
+struct SettingChange {
+  std::wstring name;
+  SettingValue value;
+};
+
+// Persistence backend behind AppSettings. AppSettings reads everything once and
+// keeps it in memory; a store only loads and saves named values.
+class SettingsStore {
+public:
+  virtual ~SettingsStore() = default;
+
+  // Every stored value by name. A missing store is not an error (empty result).
+  virtual bool loadAll(std::unordered_map<std::wstring, SettingValue>& out, std::wstring* errorOut) = 0;
+
+  // Saves the values together (one key open, one file rewrite); other stored
+  // values are kept.
+  virtual bool write(const std::vector<SettingChange>& changes, std::wstring* errorOut) = 0;
+};
@@ -1,5 +1,7 @@
 #include "CalendarView.h"
 
+#include "core/TimeUtils.h"
+
 #include <algorithm>
 #include <windowsx.h>
 
@@ -53,11 +55,10 @@ std::wstring monthNameRu(int month) {
 
 CalendarView::CalendarView() {
   // init to current local date
-  SYSTEMTIME st{};
-  GetLocalTime(&st);
-  m_year = st.wYear;
-  m_month = st.wMonth;
-  m_selectedDay = st.wDay;
+  const Civil::Date today = TimeUtils::localDate(TimeUtils::unixMsNowUtc());
+  m_year = today.year;
+  m_month = today.month;
+  m_selectedDay = today.day;
   for (auto& d : m_dayMeta) d = CalendarDayMeta{};
 }
 
@@ -120,15 +121,13 @@ void CalendarView::setThemeStyle(UiThemeStyle style) {
 }
 
 void CalendarView::setMonth(int year, int month) {
-  if (month < 1) { month = 12; --year; }
-  if (month > 12) { month = 1; ++year; }
+  const Civil::Date first = Civil::addMonths({ year, 1, 1 }, month - 1); // normalizes month 0 / 13
 
-  if (m_year == year && m_month == month) return;
-  m_year = year;
-  m_month = month;
+  if (m_year == first.year && m_month == first.month) return;
+  m_year = first.year;
+  m_month = first.month;
 
-  const int dim = daysInMonth(m_year, m_month);
-  m_selectedDay = std::clamp(m_selectedDay, 1, dim);
+  m_selectedDay = std::clamp(m_selectedDay, 1, Civil::daysInMonth(m_year, m_month));
 
   sendMonthChanged();
   invalidate();
@@ -137,17 +136,23 @@ void CalendarView::setMonth(int year, int month) {
 void CalendarView::nextMonth() { setMonth(m_year, m_month + 1); }
 void CalendarView::prevMonth() { setMonth(m_year, m_month - 1); }
 
-SYSTEMTIME CalendarView::selectedDateLocal() const {
-  SYSTEMTIME st{};
-  st.wYear = static_cast<WORD>(m_year);
-  st.wMonth = static_cast<WORD>(m_month);
-  st.wDay = static_cast<WORD>(m_selectedDay);
-  return st;
+Civil::Date CalendarView::selectedDate() const {
+  return { m_year, m_month, m_selectedDay };
 }
 
 void CalendarView::setDayMeta(const std::array<CalendarDayMeta, 32>& meta) {
+  // Repaint only the cells whose badge/preview changed (typically the one being edited).
+  if (!m_hwnd) {
+    m_dayMeta = meta;
+    return;
+  }
+  const int dim = Civil::daysInMonth(m_year, m_month);
+  for (int day = 1; day <= dim; ++day) {
+    if (m_dayMeta[day] == meta[day]) continue;
+    const RECT cell = dayCellRect(day);
+    InvalidateRect(m_hwnd, &cell, FALSE);
+  }
   m_dayMeta = meta;
-  invalidate();
 }
 
 LRESULT CALLBACK CalendarView::wndProcThunk(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
@@ -220,10 +225,10 @@ void CalendarView::onLButtonDown(int x, int y) {
   const int row = (m_layout.cellH > 0) ? (gy / m_layout.cellH) : 0;
   if (col < 0 || col > 6 || row < 0 || row > 5) return;
 
-  const int first = firstWeekdayMonday0(m_year, m_month);
+  const int first = Civil::firstWeekdayMonday0(m_year, m_month);
   const int idx = row * 7 + col;
   const int day = idx - first + 1;
-  const int dim = daysInMonth(m_year, m_month);
+  const int dim = Civil::daysInMonth(m_year, m_month);
   if (day < 1 || day > dim) return;
 
   if (m_selectedDay != day) {
@@ -290,23 +295,20 @@ void CalendarView::invalidate() {
   InvalidateRect(m_hwnd, nullptr, FALSE);
 }
 
-int CalendarView::daysInMonth(int y, int m) const {
-  static const int days[] = { 0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
-  if (m < 1 || m > 12) return 30;
-  int d = days[m];
-  const bool leap = (y % 4 == 0) && ((y % 100 != 0) || (y % 400 == 0));
-  if (m == 2 && leap) d = 29;
-  return d;
-}
-
-int CalendarView::firstWeekdayMonday0(int y, int m) const {
-  // Sakamoto algorithm: returns 0=Sunday..6=Saturday for Gregorian dates
-  static const int t[] = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
-  int yy = y;
-  if (m < 3) yy -= 1;
-  const int sun0 = (yy + yy / 4 - yy / 100 + yy / 400 + t[m - 1] + 1) % 7;
-  // make Monday=0: Mon(1)->0, Tue(2)->1, ..., Sun(0)->6
-  return (sun0 + 6) % 7;
+RECT CalendarView::dayCellRect(int day) const {
+  const int idx = Civil::firstWeekdayMonday0(m_year, m_month) + day - 1;
+  const int row = idx / 7;
+  const int col = idx % 7;
+
+  RECT cell{};
+  cell.left = m_layout.grid.left + col * m_layout.cellW;
+  cell.top = m_layout.grid.top + row * m_layout.cellH;
+  cell.right = (col == 6) ? m_layout.grid.right : (cell.left + m_layout.cellW);
+  cell.bottom = (row == 5) ? m_layout.grid.bottom : (cell.top + m_layout.cellH);
+  // include the grid lines drawn on the right/bottom edges
+  cell.right += 1;
+  cell.bottom += 1;
+  return cell;
 }
 
 std::wstring CalendarView::monthTitle() const {
@@ -370,12 +372,11 @@ void CalendarView::onPaint() {
   }
 
   // Grid cells
-  const int first = firstWeekdayMonday0(m_year, m_month);
-  const int dim = daysInMonth(m_year, m_month);
+  const int first = Civil::firstWeekdayMonday0(m_year, m_month);
+  const int dim = Civil::daysInMonth(m_year, m_month);
 
-  SYSTEMTIME now{};
-  GetLocalTime(&now);
-  const bool isThisMonthNow = (now.wYear == m_year && now.wMonth == m_month);
+  const Civil::Date now = TimeUtils::localDate(TimeUtils::unixMsNowUtc());
+  const bool isThisMonthNow = (now.year == m_year && now.month == m_month);
 
   // Grid background
   fillRectColor(mem, m_layout.grid, m_theme.panelBg);
@@ -414,7 +415,7 @@ void CalendarView::onPaint() {
     cell.bottom = (row == 5) ? m_layout.grid.bottom : (cell.top + m_layout.cellH);
 
     const bool selected = (day == m_selectedDay);
-    const bool today = isThisMonthNow && (day == now.wDay);
+    const bool today = isThisMonthNow && (day == now.day);
     const bool weekend = (col >= 5);
 
     // Selection background with rounded corners
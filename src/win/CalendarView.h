@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/Civil.h"
 #include "model/CalendarDayMeta.h"
 #include "win/UiTheme.h"
 
@@ -31,7 +32,7 @@ public:
   void nextMonth();
   void prevMonth();
 
-  SYSTEMTIME selectedDateLocal() const;
+  Civil::Date selectedDate() const; // local calendar date
 
   // Day metadata (1..31), used for drawing markers + preview.
   void setDayMeta(const std::array<CalendarDayMeta, 32>& meta);
@@ -48,13 +49,12 @@ private:
   void recalcLayout();
   void ensureFonts();
   void invalidate();
+  RECT dayCellRect(int day) const; // grid cell of a day in the displayed month
 
   void sendSelectionChanged();
   void sendMonthChanged();
 
   // Helpers
-  int daysInMonth(int y, int m) const;
-  int firstWeekdayMonday0(int y, int m) const; // 0..6 where 0=Mon
   std::wstring monthTitle() const;
 
   struct Layout {
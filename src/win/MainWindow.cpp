@@ -5,12 +5,12 @@
 #include "settings/AppSettings.h"
 #include "win/WinUtil.h"
 #include "win/NotificationWindow.h"
+#include "win/ReminderSounds.h"
 #include "win/CalendarView.h"
 #include "win/RichEditUtil.h"
 #include "win/ImageRtf.h"
 #include "win/MarkupConvert.h"
 #include "win/UiTheme.h"
-#include "app/AppPaths.h"
 
 #include <commctrl.h>
 #include <richedit.h>
@@ -21,6 +21,7 @@
 #include <shobjidl.h>
 #include <filesystem>
 #include <iterator>
+#include <limits>
 #include <array>
 #include <dwmapi.h>
 #include <mmsystem.h>
@@ -34,7 +35,14 @@ constexpr int IDC_BTN_ADD = 1003;
 constexpr int IDC_BTN_REFRESH = 1004;
 constexpr int IDC_LBL_ZOOM = 1005;
 constexpr int IDC_SLIDER_ZOOM = 1006;
+constexpr int IDC_EDIT_SEARCH = 1007;
 constexpr UINT_PTR TIMER_REMINDERS = 1;
+// Upper bound for a single reminder sleep: SetTimer counts ticks, not wall-clock time,
+// so re-check periodically in case the system clock drifted or was adjusted silently.
+constexpr int64_t REMINDER_MAX_SLEEP_MS = 60 * 60 * 1000;
+// Retry delay for a reminder that is still due after it was processed (e.g. the store
+// keeps failing), so it doesn't spin the UI thread. Upcoming reminders are not delayed.
+constexpr int64_t REMINDER_MIN_SLEEP_MS = 1000;
 
 // Editor controls
 constexpr int IDC_EDIT_TITLE = 1101;
@@ -61,6 +69,9 @@ constexpr int IDC_BTN_TEST_SOUND = 1125;
 constexpr int IDC_BTN_PREVIEW_POPUP = 1126;
 
 constexpr UINT WM_APP_TRAY = WM_APP + 1;
+constexpr UINT WM_APP_REMINDERS_CHANGED = WM_APP + 2;
+constexpr UINT WM_APP_INDEX_CHANGED = WM_APP + 3;
+constexpr UINT WM_APP_WRITES_COMPLETED = WM_APP + 4;
 
 constexpr int ID_TRAY_OPEN = 40001;
 constexpr int ID_TRAY_ADD_TEST = 40002;
@@ -72,6 +83,9 @@ constexpr int ID_TRAY_THEME_MINIMAL = 40007;
 
 constexpr UINT_PTR TIMER_AUTOSAVE = 2;
 constexpr int AUTOSAVE_DELAY_MS = 800;
+constexpr UINT_PTR TIMER_SEARCH = 3;
+constexpr int SEARCH_DELAY_MS = 250;
+constexpr int SEARCH_RESULTS_LIMIT = 200;
 
 void listViewInitColumns(HWND list) {
   ListView_SetExtendedListViewStyle(list, LVS_EX_FULLROWSELECT | LVS_EX_DOUBLEBUFFER);
@@ -95,6 +109,29 @@ void listViewInitColumns(HWND list) {
   ListView_InsertColumn(list, 2, &col);
 }
 
+// Time picker value for a local date and time of day.
+SYSTEMTIME pickerTime(const Civil::Date& date, int hour, int minute) {
+  SYSTEMTIME st{};
+  st.wYear = static_cast<WORD>(date.year);
+  st.wMonth = static_cast<WORD>(date.month);
+  st.wDay = static_cast<WORD>(date.day);
+  st.wDayOfWeek = static_cast<WORD>(Civil::weekday(Civil::toDays(date)));
+  st.wHour = static_cast<WORD>(hour);
+  st.wMinute = static_cast<WORD>(minute);
+  return st;
+}
+
+// dd.MM.yy HH:MM (search results span many days)
+std::wstring formatDateHHMM(const SYSTEMTIME& stLocal) {
+  wchar_t buf[32]{};
+  swprintf_s(buf, L"%02u.%02u.%02u ", stLocal.wDay, stLocal.wMonth, stLocal.wYear % 100);
+  return buf + WinUtil::formatHHMM(stLocal);
+}
+
+bool isBlank(const std::wstring& s) {
+  return s.find_first_not_of(L" \t") == std::wstring::npos;
+}
+
 std::wstring importanceToText(int importance) {
   switch (importance) {
     case 2: return L"Срочно";
@@ -302,6 +339,11 @@ LRESULT MainWindow::wndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
       // CalendarView sends WM_COMMAND with IDC_CALENDAR on selection/month change
       if (LOWORD(wParam) == IDC_CALENDAR) {
         flushAutosave();
+        if (GetWindowTextLengthW(m_editSearch) > 0) {
+          // Picking a day leaves the search results.
+          setControlText(m_editSearch, L"");
+          cancelSearchTimer();
+        }
         refreshNotesForSelectedDate();
         return 0;
       }
@@ -316,6 +358,13 @@ LRESULT MainWindow::wndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             return 0;
           }
           break;
+        case IDC_EDIT_SEARCH:
+          if (HIWORD(wParam) == EN_CHANGE) {
+            cancelSearchTimer();
+            m_searchTimerId = SetTimer(m_hwnd, TIMER_SEARCH, SEARCH_DELAY_MS, nullptr);
+            return 0;
+          }
+          break;
         case IDC_COMBO_IMPORTANCE:
           if (HIWORD(wParam) == CBN_SELCHANGE) {
             markEditorDirty();
@@ -327,7 +376,6 @@ LRESULT MainWindow::wndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
           if (HIWORD(wParam) == BN_CLICKED) {
             const bool enabled = (SendMessageW(m_chkSound, BM_GETCHECK, 0, 0) == BST_CHECKED);
             AppSettings::setSoundEnabled(enabled);
-            refreshSoundUi();
             return 0;
           }
           break;
@@ -375,7 +423,37 @@ LRESULT MainWindow::wndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         // Keep preview in sync (without requiring manual save).
         updateNotificationPreview();
       }
+      if (wParam == TIMER_SEARCH) {
+        // one-shot debounce: search once typing pauses
+        cancelSearchTimer();
+        flushAutosave();
+        refreshNotesForSelectedDate();
+      }
+      return 0;
+    case WM_APP_REMINDERS_CHANGED:
+      armReminderTimer();
+      return 0;
+    case WM_APP_INDEX_CHANGED:
+      // Background reconcile of the startup snapshot found out-of-band changes,
+      // or the full-text index finished building.
+      refreshNotesForSelectedDate();
       return 0;
+    case WM_APP_WRITES_COMPLETED:
+      NoteRepository::dispatchCompletedWrites();
+      return 0;
+    case WM_TIMECHANGE:
+      // Wall clock moved: pending reminders may be due now or much later.
+      // A time zone change also moves notes between local days.
+      TimeUtils::resetLocalZone();
+      NoteRepository::invalidateMonthMeta();
+      refreshNotesForSelectedDate();
+      checkReminders();
+      return 0;
+    case WM_POWERBROADCAST:
+      if (wParam == PBT_APMRESUMEAUTOMATIC) {
+        checkReminders();
+      }
+      return TRUE;
     case WM_APP_TRAY:
       // callback from tray icon
       if (lParam == WM_LBUTTONDBLCLK) {
@@ -452,6 +530,14 @@ void MainWindow::onCreate() {
     m_hwnd, reinterpret_cast<HMENU>(static_cast<INT_PTR>(IDC_BTN_REFRESH)), m_hInstance, nullptr
   );
 
+  m_editSearch = CreateWindowExW(
+    WS_EX_CLIENTEDGE, L"EDIT", L"",
+    WS_CHILD | WS_VISIBLE | ES_AUTOHSCROLL,
+    320, 14, 260, 28,
+    m_hwnd, reinterpret_cast<HMENU>(static_cast<INT_PTR>(IDC_EDIT_SEARCH)), m_hInstance, nullptr
+  );
+  SendMessageW(m_editSearch, EM_SETCUEBANNER, TRUE, reinterpret_cast<LPARAM>(L"Поиск по заметкам"));
+
   // Premium calendar view (custom drawn)
   m_calendarView = std::make_unique<CalendarView>();
   m_calendarView->create(m_hInstance, m_hwnd, IDC_CALENDAR);
@@ -815,6 +901,7 @@ void MainWindow::onCreate() {
   // Apply fonts
   SendMessageW(m_btnAdd, WM_SETFONT, reinterpret_cast<WPARAM>(m_font), TRUE);
   SendMessageW(m_btnRefresh, WM_SETFONT, reinterpret_cast<WPARAM>(m_font), TRUE);
+  SendMessageW(m_editSearch, WM_SETFONT, reinterpret_cast<WPARAM>(m_font), TRUE);
   SendMessageW(m_lblZoom, WM_SETFONT, reinterpret_cast<WPARAM>(m_font), TRUE);
   SendMessageW(m_list, WM_SETFONT, reinterpret_cast<WPARAM>(m_font), TRUE);
   SendMessageW(m_lblTitle, WM_SETFONT, reinterpret_cast<WPARAM>(m_font), TRUE);
@@ -867,7 +954,34 @@ void MainWindow::onCreate() {
 
   initTray();
 
-  m_timerId = SetTimer(m_hwnd, TIMER_REMINDERS, 1000, nullptr);
+  // Reminders are event-driven: the repository reports queue changes and we keep
+  // a single timer armed for the next due note (no polling).
+  {
+    const HWND hwnd = m_hwnd;
+    NoteRepository::setRemindersChangedHandler([hwnd]() {
+      PostMessageW(hwnd, WM_APP_REMINDERS_CHANGED, 0, 0);
+    });
+    NoteRepository::setIndexChangedHandler([hwnd]() {
+      PostMessageW(hwnd, WM_APP_INDEX_CHANGED, 0, 0);
+    });
+    NoteRepository::setWritesCompletedHandler([hwnd]() {
+      PostMessageW(hwnd, WM_APP_WRITES_COMPLETED, 0, 0);
+    });
+  }
+
+  // Sound controls follow the settings, whoever changed them.
+  m_settingsSubscription = AppSettings::subscribe([this](AppSettings::Key key) {
+    switch (key) {
+      case AppSettings::Key::SoundEnabled:
+      case AppSettings::Key::SoundNormal:
+      case AppSettings::Key::SoundImportant:
+      case AppSettings::Key::SoundUrgent:
+        refreshSoundUi();
+        break;
+      default:
+        break;
+    }
+  });
 
   // Auto-scale UI to current DPI on first run (keeps manual zoom if user changed it).
   {
@@ -888,9 +1002,15 @@ void MainWindow::onCreate() {
   clearEditor();
   updateAutoHideEnabled();
   refreshNotesForSelectedDate();
+  armReminderTimer();
 }
 
 void MainWindow::onDestroy() {
+  NoteRepository::setRemindersChangedHandler(nullptr);
+  NoteRepository::setIndexChangedHandler(nullptr);
+  NoteRepository::setWritesCompletedHandler(nullptr);
+  AppSettings::unsubscribe(m_settingsSubscription);
+  m_settingsSubscription = 0;
   if (m_timerId) {
     KillTimer(m_hwnd, m_timerId);
     m_timerId = 0;
@@ -899,6 +1019,7 @@ void MainWindow::onDestroy() {
     KillTimer(m_hwnd, TIMER_AUTOSAVE);
     m_autosaveTimerId = 0;
   }
+  cancelSearchTimer();
 
   removeTray();
   if (m_trayMenu) {
@@ -966,6 +1087,12 @@ void MainWindow::onSize(int width, int height) {
   MoveWindow(m_lblZoom, labelX, btnY + sx(6), labelW, sx(24), TRUE);
   MoveWindow(m_sliderZoom, sliderX, btnY, sliderW, btnH, TRUE);
 
+  // Search box between the buttons and the zoom controls
+  x += sx(110) + gap;
+  const int searchH = sx(28);
+  const int searchW = std::max(sx(120), std::min(sx(320), labelX - gap - x));
+  MoveWindow(m_editSearch, x, btnY + (btnH - searchH) / 2, searchW, searchH, TRUE);
+
   const int usableH = height - top - margin;
   const int usableW = width - margin * 2;
   
@@ -1154,6 +1281,7 @@ void MainWindow::onSize(int width, int height) {
   const int pad = sx(10);
   const LPARAM lr = MAKELONG(pad, pad);
   SendMessageW(m_editTitle, EM_SETMARGINS, EC_LEFTMARGIN | EC_RIGHTMARGIN, lr);
+  SendMessageW(m_editSearch, EM_SETMARGINS, EC_LEFTMARGIN | EC_RIGHTMARGIN, lr);
   SendMessageW(m_editAutoHideSeconds, EM_SETMARGINS, EC_LEFTMARGIN | EC_RIGHTMARGIN, lr);
   SendMessageW(m_editorRich, EM_SETMARGINS, EC_LEFTMARGIN | EC_RIGHTMARGIN, lr);
   SendMessageW(m_previewRich, EM_SETMARGINS, EC_LEFTMARGIN | EC_RIGHTMARGIN, lr);
@@ -1166,6 +1294,8 @@ void MainWindow::onCommand(int id) {
       return;
     case IDC_BTN_REFRESH:
       flushAutosave();
+      // Manual refresh also picks up notes changed outside the app.
+      NoteRepository::reload();
       refreshNotesForSelectedDate();
       return;
     case IDC_BTN_SAVE:
@@ -1289,26 +1419,30 @@ void MainWindow::onHScroll(HWND src) {
   onSize(rc.right - rc.left, rc.bottom - rc.top);
 }
 
-SYSTEMTIME MainWindow::selectedDateLocal() const {
+Civil::Date MainWindow::selectedDate() const {
   if (m_calendarView) {
-    return m_calendarView->selectedDateLocal();
+    return m_calendarView->selectedDate();
   }
-  SYSTEMTIME st{};
-  GetLocalTime(&st);
-  return st;
+  return TimeUtils::localDate(TimeUtils::unixMsNowUtc());
 }
 
 void MainWindow::refreshNotesForSelectedDate() {
   m_refreshingList = true;
-  const SYSTEMTIME day = selectedDateLocal();
+  const Civil::Date day = selectedDate();
+
+  // A non-empty search box replaces the day's notes with search results.
+  const std::wstring query = getControlText(m_editSearch);
+  const bool searching = !isBlank(query);
 
   std::wstring err;
-  const auto notes = NoteRepository::listForDate(day, &err);
+  const auto notes = searching ? NoteRepository::search(query, SEARCH_RESULTS_LIMIT, &err)
+                               : NoteRepository::listForDate(day, &err);
   if (!err.empty()) {
     MessageBoxW(m_hwnd, err.c_str(), L"Ошибка чтения заметок", MB_ICONERROR);
   }
 
   ListView_DeleteAllItems(m_list);
+  ListView_SetColumnWidth(m_list, 0, searching ? 120 : 80);
   m_listNoteIds.clear();
 
   const std::wstring keepId = (m_currentNote ? m_currentNote->id : L"");
@@ -1318,7 +1452,7 @@ void MainWindow::refreshNotesForSelectedDate() {
     m_listNoteIds.push_back(n.id);
 
     SYSTEMTIME stLocal = TimeUtils::unixMsToSystemTimeLocal(n.scheduledAtUtcMs);
-    const std::wstring t = WinUtil::formatHHMM(stLocal);
+    const std::wstring t = searching ? formatDateHHMM(stLocal) : WinUtil::formatHHMM(stLocal);
     const std::wstring imp = importanceToText(n.importance);
 
     LVITEMW item{};
@@ -1387,11 +1521,7 @@ void MainWindow::clearEditor() {
   updateAutoHideEnabled();
 
   // reset time picker to today 09:00 on selected date
-  SYSTEMTIME day = selectedDateLocal();
-  day.wHour = 9;
-  day.wMinute = 0;
-  day.wSecond = 0;
-  day.wMilliseconds = 0;
+  SYSTEMTIME day = pickerTime(selectedDate(), 9, 0);
   SendMessageW(m_timePicker, DTM_SETSYSTEMTIME, GDT_VALID, reinterpret_cast<LPARAM>(&day));
 
   // Clear content (single editor)
@@ -1439,15 +1569,9 @@ void MainWindow::addNewNote() {
   n.contentMode = NoteContentMode::VisualRtf;
   n.contentRtf = L"{\\rtf1\\ansi\\deff0\\fs24 }";
 
-  SYSTEMTIME st = selectedDateLocal();
   // Default time: current local time (rounded to minutes)
-  SYSTEMTIME now{};
-  GetLocalTime(&now);
-  st.wHour = now.wHour;
-  st.wMinute = now.wMinute;
-  st.wSecond = 0;
-  st.wMilliseconds = 0;
-  n.scheduledAtUtcMs = TimeUtils::localSystemTimeToUnixMsUtc(st);
+  const int64_t nowMinute = TimeUtils::localTimeOfDayMs(TimeUtils::unixMsNowUtc()) / 60'000 * 60'000;
+  n.scheduledAtUtcMs = TimeUtils::localDateTimeToUnixMsUtc(selectedDate(), nowMinute);
 
   n.autoHideEnabled = false;
   n.autoHideSeconds = 5;
@@ -1483,19 +1607,10 @@ void MainWindow::saveEditorToNote(bool refreshAfter) {
   // schedule time (take selected date + picker time)
   SYSTEMTIME t{};
   const LRESULT gdt = SendMessageW(m_timePicker, DTM_GETSYSTEMTIME, 0, reinterpret_cast<LPARAM>(&t));
-  SYSTEMTIME day = selectedDateLocal();
-  if (gdt != GDT_VALID) {
-    day.wHour = 9;
-    day.wMinute = 0;
-    day.wSecond = 0;
-    day.wMilliseconds = 0;
-    n.scheduledAtUtcMs = TimeUtils::localSystemTimeToUnixMsUtc(day);
-  } else {
-    t.wYear = day.wYear;
-    t.wMonth = day.wMonth;
-    t.wDay = day.wDay;
-    n.scheduledAtUtcMs = TimeUtils::localSystemTimeToUnixMsUtc(t);
-  }
+  const int64_t timeOfDayMs = gdt == GDT_VALID
+      ? ((t.wHour * 60 + t.wMinute) * 60 + t.wSecond) * 1000 + t.wMilliseconds
+      : 9 * 3'600'000;
+  n.scheduledAtUtcMs = TimeUtils::localDateTimeToUnixMsUtc(selectedDate(), timeOfDayMs);
 
   // Single WYSIWYG editor: always store RTF.
   n.contentMode = NoteContentMode::VisualRtf;
@@ -1506,8 +1621,16 @@ void MainWindow::saveEditorToNote(bool refreshAfter) {
     refreshAfter = true;
   }
 
+  // Files are written on the storage thread; the index (list, calendar) is updated now.
   std::wstring err;
-  if (!NoteRepository::upsert(n, &err)) {
+  const bool queued = NoteRepository::upsertAsync(n, [this, id = n.id](bool ok, const std::wstring& error) {
+    if (ok) return;
+    if (m_currentNote && m_currentNote->id == id) {
+      m_editorDirty = true; // retried by the next save
+    }
+    MessageBoxW(m_hwnd, error.c_str(), L"Ошибка сохранения", MB_ICONERROR);
+  }, &err);
+  if (!queued) {
     MessageBoxW(m_hwnd, err.c_str(), L"Ошибка сохранения", MB_ICONERROR);
     return;
   }
@@ -1659,18 +1782,8 @@ void MainWindow::refreshSoundUi() {
   const bool enabled = AppSettings::soundEnabled();
   SendMessageW(m_chkSound, BM_SETCHECK, enabled ? BST_CHECKED : BST_UNCHECKED, 0);
 
-  auto isFileValue = [](const std::wstring& v) -> bool {
-    if (v.empty()) return false;
-    if (v.find(L"\\") != std::wstring::npos || v.find(L"/") != std::wstring::npos) return true;
-    if (v.size() >= 4) {
-      const std::wstring ext = v.substr(v.size() - 4);
-      if (ext == L".wav" || ext == L".WAV") return true;
-    }
-    return false;
-  };
-
   auto fileLabel = [&](const std::wstring& path) -> std::wstring {
-    if (!isFileValue(path)) return L"WAV...";
+    if (!ReminderSounds::isFileValue(path)) return L"WAV...";
     try {
       const std::filesystem::path p(path);
       return L"WAV: " + p.filename().wstring();
@@ -1754,8 +1867,11 @@ void MainWindow::onSoundComboChanged(int controlId) {
     }
   }
 
-  setter(newVal);
-  refreshSoundUi();
+  if (newVal == current) {
+    refreshSoundUi(); // restore the combo (e.g. the file dialog was cancelled)
+  } else {
+    setter(newVal);
+  }
 }
 
 void MainWindow::playSoundForImportance(int importance, bool showErrors) {
@@ -1778,19 +1894,7 @@ void MainWindow::playSoundForImportance(int importance, bool showErrors) {
     return;
   }
 
-  auto isFileValue = [](const std::wstring& v) -> bool {
-    if (v.empty()) return false;
-    if (v.find(L"\\") != std::wstring::npos || v.find(L"/") != std::wstring::npos) return true;
-    if (v.size() >= 4) {
-      const std::wstring ext = v.substr(v.size() - 4);
-      if (ext == L".wav" || ext == L".WAV") return true;
-    }
-    return false;
-  };
-
-  DWORD flags = SND_ASYNC | SND_NODEFAULT;
-  flags |= isFileValue(sound) ? SND_FILENAME : SND_ALIAS;
-  if (!PlaySoundW(sound.c_str(), nullptr, flags)) {
+  if (!ReminderSounds::play(importance)) {
     if (showErrors) {
       MessageBoxW(m_hwnd, L"Не удалось воспроизвести выбранный звук.", L"AlertCalendar", MB_ICONWARNING);
     } else {
@@ -1820,7 +1924,7 @@ void MainWindow::showNotificationPreviewPopup() {
 }
 
 void MainWindow::insertImageIntoRich() {
-  // Ensure we have a note id to place media under
+  // Pictures are saved with a note; create one if nothing is open.
   if (!m_currentNote || m_currentNote->id.empty()) {
     addNewNote();
   }
@@ -1829,18 +1933,8 @@ void MainWindow::insertImageIntoRich() {
   const std::wstring src = openImageFileDialog();
   if (src.empty()) return;
 
-  // Copy to note media folder (storage)
-  try {
-    namespace fs = std::filesystem;
-    const fs::path srcPath(src);
-    std::wstring ext = srcPath.extension().wstring();
-    if (ext.empty()) ext = L".png";
-    const fs::path dstDir = AppPaths::noteMediaDir(m_currentNote->id);
-    const fs::path dst = dstDir / (WinUtil::guidString() + ext);
-    fs::copy_file(srcPath, dst, fs::copy_options::overwrite_existing);
-  } catch (...) {
-    // non-fatal (RTF will still embed bytes)
-  }
+  // The picture is embedded into the RTF here; on save the repository moves its
+  // bytes to the shared media blob store (deduplicated), so no copy is kept.
 
   // Compute max width based on current editor client width
   RECT rc{};
@@ -1878,6 +1972,13 @@ void MainWindow::scheduleAutosave() {
   m_autosaveTimerId = SetTimer(m_hwnd, TIMER_AUTOSAVE, AUTOSAVE_DELAY_MS, nullptr);
 }
 
+void MainWindow::cancelSearchTimer() {
+  if (m_searchTimerId) {
+    KillTimer(m_hwnd, TIMER_SEARCH);
+    m_searchTimerId = 0;
+  }
+}
+
 void MainWindow::flushAutosave() {
   if (m_autosaveTimerId) {
     KillTimer(m_hwnd, TIMER_AUTOSAVE);
@@ -1915,49 +2016,76 @@ void MainWindow::addTestNote() {
 void MainWindow::checkReminders() {
   const int64_t now = TimeUtils::unixMsNowUtc();
   std::wstring err;
-  const auto due = NoteRepository::listDue(now, 20, &err);
-  if (!err.empty()) {
+  // No limit: after sleep or downtime the whole backlog is dispatched at once.
+  auto due = NoteRepository::listDue(now, std::numeric_limits<int>::max(), &err);
+  if (!err.empty() || due.empty()) {
+    armReminderTimer();
     return;
   }
 
-  if (!due.empty() && AppSettings::soundEnabled()) {
-    int maxImp = 0;
-    for (const auto& n : due) {
-      maxImp = std::max(maxImp, n.importance);
-    }
-
-    std::wstring sound;
-    if (maxImp >= 2) sound = AppSettings::soundUrgent();
-    else if (maxImp == 1) sound = AppSettings::soundImportant();
-    else sound = AppSettings::soundNormal();
-
-    auto isFileValue = [](const std::wstring& v) -> bool {
-      if (v.empty()) return false;
-      if (v.find(L"\\") != std::wstring::npos || v.find(L"/") != std::wstring::npos) return true;
-      if (v.size() >= 4) {
-        const std::wstring ext = v.substr(v.size() - 4);
-        if (ext == L".wav" || ext == L".WAV") return true;
-      }
-      return false;
-    };
-
-    if (!sound.empty()) {
-      DWORD flags = SND_ASYNC | SND_NODEFAULT;
-      flags |= isFileValue(sound) ? SND_FILENAME : SND_ALIAS;
-      if (!PlaySoundW(sound.c_str(), nullptr, flags)) {
-        const UINT beep = (maxImp >= 2) ? MB_ICONHAND : ((maxImp == 1) ? MB_ICONEXCLAMATION : MB_OK);
-        MessageBeep(beep);
+  // Mark the whole burst as fired first (one write) to avoid repeated popups if user keeps them open.
+  NoteRepository::Batch fired;
+  for (const auto& summary : due) {
+    fired.markFired(summary.id, now);
+  }
+  if (!fired.commit(nullptr)) {
+    // The batch is all-or-nothing: mark the notes one by one, and stop tracking
+    // those that can't be written, or they'd be due again on every check.
+    for (const auto& summary : due) {
+      if (!NoteRepository::markFired(summary.id, now, nullptr)) {
+        NoteRepository::dropReminder(summary.id);
       }
     }
   }
 
-  for (const auto& n : due) {
-    // Mark as fired first to avoid repeated popups if user keeps it open.
-    NoteRepository::markFired(n.id, now, nullptr);
+  const NotificationQueue::Dispatch d = m_notifications.push(std::move(due));
+  if (d.soundImportance >= 0) {
+    playSoundForImportance(d.soundImportance, false);
+  }
 
-    auto* w = new NotificationWindow(m_hInstance, n);
+  // Content is loaded on demand, only for notes that get a window of their own.
+  int stack = m_notifications.popupsOnScreen() - static_cast<int>(d.popups.size());
+  for (const auto& summary : d.popups) {
+    auto n = NoteRepository::getById(summary.id, nullptr);
+    if (!n) {
+      m_notifications.popupClosed();
+      continue;
+    }
+    auto* w = new NotificationWindow(m_hInstance, std::move(*n));
+    w->setStackIndex(stack++);
+    w->setOnClosed([this] { m_notifications.popupClosed(); });
     w->show();
   }
+
+  if (d.openDigest) {
+    m_digestWindow = new NotificationWindow(m_hInstance, d.digest);
+    m_digestWindow->setStackIndex(stack);
+    m_digestWindow->setOnClosed([this] {
+      m_notifications.digestClosed();
+      m_digestWindow = nullptr;
+    });
+    m_digestWindow->show();
+  } else if (!d.digest.empty() && m_digestWindow) {
+    m_digestWindow->addToDigest(d.digest);
+  }
+
+  armReminderTimer();
+}
+
+void MainWindow::armReminderTimer() {
+  const auto next = NoteRepository::nextReminderUtcMs();
+  if (!next) {
+    if (m_timerId) {
+      KillTimer(m_hwnd, TIMER_REMINDERS);
+      m_timerId = 0;
+    }
+    return;
+  }
+
+  const int64_t until = *next - TimeUtils::unixMsNowUtc();
+  const int64_t delay = until <= 0 ? REMINDER_MIN_SLEEP_MS : std::min(until, REMINDER_MAX_SLEEP_MS);
+  // Re-using the same id replaces the pending timer.
+  m_timerId = SetTimer(m_hwnd, TIMER_REMINDERS, static_cast<UINT>(delay), nullptr);
 }
 
 void MainWindow::applyUiZoom() {
@@ -1998,6 +2126,7 @@ void MainWindow::applyUiZoom() {
   // Apply fonts to all controls
   SendMessageW(m_btnAdd, WM_SETFONT, reinterpret_cast<WPARAM>(m_fontOwned), TRUE);
   SendMessageW(m_btnRefresh, WM_SETFONT, reinterpret_cast<WPARAM>(m_fontOwned), TRUE);
+  SendMessageW(m_editSearch, WM_SETFONT, reinterpret_cast<WPARAM>(m_fontOwned), TRUE);
   SendMessageW(m_lblZoom, WM_SETFONT, reinterpret_cast<WPARAM>(m_fontOwned), TRUE);
   SendMessageW(m_sliderZoom, WM_SETFONT, reinterpret_cast<WPARAM>(m_fontOwned), TRUE);
   if (m_calendarView) {
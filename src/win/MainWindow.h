@@ -8,10 +8,13 @@
 #include <string>
 #include <vector>
 
+#include "core/Civil.h"
 #include "win/UiTheme.h"
 
 class CalendarView;
+class NotificationWindow;
 #include "model/Note.h"
+#include "model/NotificationQueue.h"
 
 class MainWindow {
 public:
@@ -39,6 +42,7 @@ private:
   void addTestNote();
   void addNewNote();
   void checkReminders();
+  void armReminderTimer();
   void applyUiZoom();
   void applyUiTheme();
   void recreateBrushes();
@@ -59,8 +63,9 @@ private:
   void markEditorDirty();
   void scheduleAutosave();
   void flushAutosave();
+  void cancelSearchTimer();
 
-  SYSTEMTIME selectedDateLocal() const;
+  Civil::Date selectedDate() const; // local calendar date
 
   void initTray();
   void removeTray();
@@ -74,6 +79,8 @@ private:
   HWND m_list{};
   HWND m_btnAdd{};
   HWND m_btnRefresh{};
+  HWND m_editSearch{};
+  UINT_PTR m_searchTimerId{};
   HWND m_lblZoom{};
   HWND m_sliderZoom{};
   HWND m_lblTitle{};
@@ -134,6 +141,10 @@ private:
   HFONT m_fontOwned{};
   HFONT m_fontBold{};
   UINT_PTR m_timerId{};
+  // Reminder windows on screen; the digest, if open, takes the overflow.
+  NotificationQueue m_notifications;
+  NotificationWindow* m_digestWindow{};
+  int m_settingsSubscription{};
 
   // Theme
   UiTheme m_theme;
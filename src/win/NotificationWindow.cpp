@@ -37,11 +37,48 @@ void setDarkTitleBar(HWND hwnd) {
   fn(hwnd, 20, &on, sizeof(on));
   FreeLibrary(dwm);
 }
+
+// dd.MM HH:MM [важно] title
+std::wstring digestLine(const NoteSummary& n) {
+  const SYSTEMTIME st = TimeUtils::unixMsToSystemTimeLocal(n.scheduledAtUtcMs);
+  wchar_t buf[32]{};
+  swprintf_s(buf, L"%02u.%02u ", st.wDay, st.wMonth);
+  std::wstring line = buf + WinUtil::formatHHMM(st) + L"  ";
+  if (n.importance >= 2) line += L"[срочно] ";
+  else if (n.importance == 1) line += L"[важно] ";
+  line += n.title.empty() ? L"(без названия)" : n.title;
+  return line;
+}
 } // namespace
 
 NotificationWindow::NotificationWindow(HINSTANCE hInstance, Note note, bool previewOnly)
   : m_hInstance(hInstance), m_note(std::move(note)), m_previewOnly(previewOnly) {}
 
+NotificationWindow::NotificationWindow(HINSTANCE hInstance, std::vector<NoteSummary> digest)
+  : m_hInstance(hInstance), m_isDigest(true), m_digest(std::move(digest)) {
+  // The window chrome follows the most important note; no auto-hide for a digest.
+  for (const auto& n : m_digest) {
+    m_note.importance = std::max(m_note.importance, n.importance);
+  }
+  m_note.autoHideEnabled = false;
+}
+
+NotificationWindow::~NotificationWindow() {
+  if (m_onClosed) {
+    m_onClosed();
+  }
+}
+
+void NotificationWindow::addToDigest(const std::vector<NoteSummary>& notes) {
+  m_digest.insert(m_digest.end(), notes.begin(), notes.end());
+  for (const auto& n : notes) {
+    m_note.importance = std::max(m_note.importance, n.importance);
+  }
+  if (m_hwnd) {
+    updateDigestUi();
+  }
+}
+
 void NotificationWindow::show() {
   const wchar_t* kClassName = L"AlertCalendarNotificationWindow";
 
@@ -64,7 +101,8 @@ void NotificationWindow::show() {
 
   // Construct title based on importance (avoid emoji to prevent missing glyph artifacts)
   std::wstring title = L"Напоминание";
-  if (m_note.importance >= 2) title = L"Срочное напоминание!";
+  if (m_isDigest) title = L"Пропущенные напоминания";
+  else if (m_note.importance >= 2) title = L"Срочное напоминание!";
   else if (m_note.importance == 1) title = L"Важное напоминание";
 
   // Modeless: object lifetime controlled via WM_NCDESTROY (delete this)
@@ -259,7 +297,9 @@ void NotificationWindow::onCreate() {
   SendMessageW(m_rich, EM_SETCHARFORMAT, SCF_ALL, reinterpret_cast<LPARAM>(&cf));
 
   // Show content
-  if (m_note.contentMode == NoteContentMode::VisualRtf && !m_note.contentRtf.empty()) {
+  if (m_isDigest) {
+    updateDigestUi();
+  } else if (m_note.contentMode == NoteContentMode::VisualRtf && !m_note.contentRtf.empty()) {
     RichEditUtil::setRtf(m_rich, m_note.contentRtf);
   } else if (m_note.contentMode == NoteContentMode::Markdown && !m_note.contentMarkdown.empty()) {
     RichEditUtil::setRtf(m_rich, MarkupConvert::markdownToRtf(m_note.contentMarkdown));
@@ -344,6 +384,29 @@ void NotificationWindow::updateCountdownUi() {
   SendMessageW(m_progress, PBM_SETPOS, pos, 0);
 }
 
+void NotificationWindow::updateDigestUi() {
+  std::wstring text;
+  for (const auto& n : m_digest) {
+    if (!text.empty()) text += L"\r\n";
+    text += digestLine(n);
+  }
+  SetWindowTextW(m_rich, text.c_str());
+
+  CHARFORMAT2W cf{};
+  cf.cbSize = sizeof(cf);
+  cf.dwMask = CFM_COLOR;
+  cf.crTextColor = m_theme.editorText;
+  SendMessageW(m_rich, EM_SETCHARFORMAT, SCF_ALL, reinterpret_cast<LPARAM>(&cf));
+
+  const std::wstring title = L"Пропущено напоминаний: " + std::to_wstring(m_digest.size());
+  SetWindowTextW(m_lblTitle, title.c_str());
+
+  m_importanceColor = m_theme.badgeNormal;
+  if (m_note.importance >= 2) m_importanceColor = m_theme.badgeUrgent;
+  else if (m_note.importance == 1) m_importanceColor = m_theme.badgeImportant;
+  InvalidateRect(m_hwnd, nullptr, TRUE);
+}
+
 void NotificationWindow::showSnoozeMenu() {
   HMENU menu = CreatePopupMenu();
   if (!menu) return;
@@ -384,17 +447,21 @@ void NotificationWindow::snoozeMinutes(int minutes) {
   }
 
   std::wstring err;
-  auto opt = NoteRepository::getById(m_note.id, &err);
-  Note n = opt ? *opt : m_note;
-
   const int64_t now = TimeUtils::unixMsNowUtc();
-  n.scheduledAtUtcMs = now + static_cast<int64_t>(minutes) * 60'000;
-  n.hasFired = false;
-  n.firedAtUtcMs = 0;
-  n.dismissed = false;
-  n.dismissedAtUtcMs = 0;
-
-  if (!NoteRepository::upsert(std::move(n), &err)) {
+  const int64_t until = now + static_cast<int64_t>(minutes) * 60'000;
+  // Metadata-only: moves the reminder and clears fired/dismissed, content isn't re-read or rewritten.
+  bool ok = false;
+  if (m_isDigest) {
+    NoteRepository::Batch batch;
+    batch.setSkipMissing(true); // notes deleted since the digest opened
+    for (const auto& n : m_digest) {
+      batch.updateSchedule(n.id, until);
+    }
+    ok = batch.commit(&err);
+  } else {
+    ok = NoteRepository::updateSchedule(m_note.id, until, &err);
+  }
+  if (!ok) {
     // If snooze failed, don't close: user can try again / close normally.
     if (!err.empty()) {
       MessageBoxW(m_hwnd, err.c_str(), L"Не удалось отложить", MB_ICONERROR);
@@ -406,9 +473,29 @@ void NotificationWindow::snoozeMinutes(int minutes) {
 }
 
 void NotificationWindow::closeSelf() {
+  // No auto-hide ticks (and re-entry) while an error box is up.
+  if (m_timerId) {
+    KillTimer(m_hwnd, m_timerId);
+    m_timerId = 0;
+  }
+
   // Mark dismissed (skip in preview mode)
-  if (!m_previewOnly) {
-    NoteRepository::markDismissed(m_note.id, TimeUtils::unixMsNowUtc(), nullptr);
+  std::wstring err;
+  const int64_t now = TimeUtils::unixMsNowUtc();
+  bool ok = true;
+  if (m_isDigest) {
+    NoteRepository::Batch batch;
+    batch.setSkipMissing(true);
+    for (const auto& n : m_digest) {
+      batch.markDismissed(n.id, now);
+    }
+    ok = batch.commit(&err);
+  } else if (!m_previewOnly) {
+    ok = NoteRepository::markDismissed(m_note.id, now, &err);
+  }
+  if (!ok && !err.empty()) {
+    // The reminder has fired either way; the window still closes.
+    MessageBoxW(m_hwnd, err.c_str(), L"Не удалось закрыть напоминание", MB_ICONERROR);
   }
   DestroyWindow(m_hwnd);
 }
@@ -455,11 +542,11 @@ void NotificationWindow::positionBottomRight() {
   const int zoom = AppSettings::uiZoomPercent();
   auto sx = [&](int px) { return MulDiv(px, zoom, 100); };
 
-  // Centered notification (as requested). Size scales with UI zoom.
+  // Centered notification (as requested), cascaded when several are open. Size scales with UI zoom.
   const int w = sx(560);
   const int h = sx(380);
-  const int cx = rc.left + ((rc.right - rc.left) - w) / 2;
-  const int cy = rc.top + ((rc.bottom - rc.top) - h) / 2;
+  const int cx = rc.left + ((rc.right - rc.left) - w) / 2 + sx(28) * m_stackIndex;
+  const int cy = rc.top + ((rc.bottom - rc.top) - h) / 2 + sx(28) * m_stackIndex;
 
   SetWindowPos(m_hwnd, HWND_TOPMOST, cx, cy, w, h, SWP_NOACTIVATE | SWP_SHOWWINDOW);
 }
@@ -3,12 +3,25 @@
 #include "model/Note.h"
 #include "win/UiTheme.h"
 
+#include <functional>
+#include <vector>
 #include <windows.h>
 
 class NotificationWindow {
 public:
   NotificationWindow(HINSTANCE hInstance, Note note, bool previewOnly = false);
+  // Digest of reminders that didn't get a window of their own (see
+  // NotificationQueue): one line per note; closing or snoozing applies to all.
+  NotificationWindow(HINSTANCE hInstance, std::vector<NoteSummary> digest);
+  ~NotificationWindow();
+
   void show();
+  void addToDigest(const std::vector<NoteSummary>& notes);
+
+  // Called once the window is gone (closed, snoozed, auto-hidden or failed to open).
+  void setOnClosed(std::function<void()> onClosed) { m_onClosed = std::move(onClosed); }
+  // Windows shown together are cascaded by this many steps from the center.
+  void setStackIndex(int index) { m_stackIndex = index; }
 
 private:
   static LRESULT CALLBACK wndProcThunk(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -23,6 +36,7 @@ private:
   void layout(int width, int height);
 
   void updateCountdownUi();
+  void updateDigestUi();
   void positionBottomRight();
 
   HINSTANCE m_hInstance{};
@@ -47,6 +61,11 @@ private:
   HBRUSH m_bgBrush{};
   COLORREF m_importanceColor{};
   bool m_previewOnly = false;
+
+  bool m_isDigest = false;
+  std::vector<NoteSummary> m_digest;
+  std::function<void()> m_onClosed;
+  int m_stackIndex = 0;
 };
 
 
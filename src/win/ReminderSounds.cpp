@@ -0,0 +1,237 @@
+#include "ReminderSounds.h"
+
+#include "core/AudioMixer.h"
+#include "core/MappedFile.h"
+#include "core/Wav.h"
+#include "settings/AppSettings.h"
+
+#include <windows.h>
+#include <mmsystem.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr int kLevels = 3; // importance 0..2
+
+// waveOut buffers of 20 ms: about 80 ms queued ahead.
+constexpr int kBuffers = 4;
+constexpr size_t kBufferFrames = Wav::kSampleRate / 50;
+
+struct Level {
+  std::wstring value; // settings value; empty = off
+  std::shared_ptr<const Wav::Clip> clip; // null: play value with PlaySoundW
+};
+
+struct SoundState {
+  std::mutex mutex;
+  std::array<Level, kLevels> levels;
+  int subscription = 0;
+
+  AudioMixer mixer;
+  std::thread output;
+  bool outputRunning = false; // output thread is (still) feeding the device
+  std::atomic<bool> stop{ false };
+};
+
+SoundState& state() {
+  static SoundState s;
+  return s;
+}
+
+std::wstring settingFor(int level) {
+  if (level >= 2) return AppSettings::soundUrgent();
+  if (level == 1) return AppSettings::soundImportant();
+  return AppSettings::soundNormal();
+}
+
+// The WAV the current sound scheme plays for a system alias ("SystemAsterisk" is
+// the event of the same name, "SystemDefault" the ".Default" event).
+std::wstring aliasFile(const std::wstring& alias) {
+  const std::wstring event = alias == L"SystemDefault" ? L".Default" : alias;
+  const std::wstring key = L"AppEvents\\Schemes\\Apps\\.Default\\" + event + L"\\.Current";
+  wchar_t buf[MAX_PATH * 2];
+  DWORD size = sizeof(buf);
+  // REG_EXPAND_SZ values (%SystemRoot%\media\...) come back expanded.
+  if (RegGetValueW(HKEY_CURRENT_USER, key.c_str(), nullptr, RRF_RT_REG_SZ, nullptr, buf, &size) != ERROR_SUCCESS) {
+    return {};
+  }
+  std::wstring path = buf;
+  if (!path.empty() && path.find(L'\\') == std::wstring::npos) {
+    // Bare file names are looked up in %WINDIR%\Media, like PlaySound does.
+    wchar_t windir[MAX_PATH];
+    const UINT n = GetWindowsDirectoryW(windir, MAX_PATH);
+    if (n > 0 && n < MAX_PATH) path = std::wstring(windir) + L"\\Media\\" + path;
+  }
+  return path;
+}
+
+std::shared_ptr<const Wav::Clip> loadClip(const std::wstring& value) {
+  if (value.empty()) return nullptr;
+  const std::wstring path = ReminderSounds::isFileValue(value) ? value : aliasFile(value);
+  MappedFile file;
+  if (path.empty() || !file.open(path)) return nullptr;
+  auto clip = std::make_shared<Wav::Clip>();
+  if (!Wav::decode(std::string_view(file.data(), file.size()), *clip) || clip->samples.empty()) {
+    return nullptr;
+  }
+  return clip;
+}
+
+// Decodes outside the lock: a WAV on a slow or roaming profile may take a while.
+void reload(int level) {
+  Level fresh;
+  fresh.value = settingFor(level);
+  fresh.clip = loadClip(fresh.value);
+  SoundState& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  s.levels[level] = std::move(fresh);
+}
+
+// Keeps the device fed while the mixer has voices, then closes it.
+void outputLoop(HWAVEOUT device, HANDLE bufferDone) {
+  SoundState& s = state();
+  std::array<std::vector<int16_t>, kBuffers> data;
+  std::array<WAVEHDR, kBuffers> headers{};
+  std::array<bool, kBuffers> queued{};
+  for (int i = 0; i < kBuffers; ++i) {
+    data[i].resize(kBufferFrames * Wav::kChannels);
+    headers[i].lpData = reinterpret_cast<LPSTR>(data[i].data());
+    headers[i].dwBufferLength = static_cast<DWORD>(data[i].size() * sizeof(int16_t));
+    waveOutPrepareHeader(device, &headers[i], sizeof(WAVEHDR));
+  }
+
+  int pending = 0;
+  for (;;) {
+    for (int i = 0; i < kBuffers; ++i) {
+      if (queued[i]) {
+        if (!(headers[i].dwFlags & WHDR_DONE)) continue;
+        queued[i] = false;
+        --pending;
+      }
+      if (s.stop || !s.mixer.active()) continue;
+      s.mixer.render(data[i].data(), kBufferFrames);
+      if (waveOutWrite(device, &headers[i], sizeof(WAVEHDR)) == MMSYSERR_NOERROR) {
+        queued[i] = true;
+        ++pending;
+      } else {
+        s.mixer.stopAll();
+      }
+    }
+
+    if (pending == 0) {
+      // play() adds voices under the same lock, so none can slip in unheard.
+      std::lock_guard<std::mutex> lock(s.mutex);
+      if (s.stop || !s.mixer.active()) {
+        s.outputRunning = false;
+        break;
+      }
+      continue;
+    }
+    WaitForSingleObject(bufferDone, 100);
+  }
+
+  waveOutReset(device);
+  for (auto& h : headers) {
+    waveOutUnprepareHeader(device, &h, sizeof(WAVEHDR));
+  }
+  waveOutClose(device);
+  CloseHandle(bufferDone);
+}
+
+// Opens the device here rather than on the output thread, so a failure reaches
+// the caller.
+bool startOutputLocked(SoundState& s) {
+  if (s.outputRunning) return true;
+  if (s.output.joinable()) {
+    s.output.join(); // the previous stream finished and only cleans up
+  }
+
+  WAVEFORMATEX fmt{};
+  fmt.wFormatTag = WAVE_FORMAT_PCM;
+  fmt.nChannels = Wav::kChannels;
+  fmt.nSamplesPerSec = Wav::kSampleRate;
+  fmt.wBitsPerSample = 16;
+  fmt.nBlockAlign = static_cast<WORD>(fmt.nChannels * fmt.wBitsPerSample / 8);
+  fmt.nAvgBytesPerSec = fmt.nSamplesPerSec * fmt.nBlockAlign;
+
+  HANDLE bufferDone = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+  HWAVEOUT device = nullptr;
+  if (!bufferDone || waveOutOpen(&device, WAVE_MAPPER, &fmt, reinterpret_cast<DWORD_PTR>(bufferDone), 0,
+                                 CALLBACK_EVENT) != MMSYSERR_NOERROR) {
+    if (bufferDone) CloseHandle(bufferDone);
+    s.mixer.stopAll();
+    return false;
+  }
+
+  s.outputRunning = true;
+  s.output = std::thread(outputLoop, device, bufferDone);
+  return true;
+}
+} // namespace
+
+void ReminderSounds::init() {
+  for (int level = 0; level < kLevels; ++level) {
+    reload(level);
+  }
+  SoundState& s = state();
+  s.stop = false;
+  s.subscription = AppSettings::subscribe([](AppSettings::Key key) {
+    switch (key) {
+      case AppSettings::Key::SoundNormal: reload(0); break;
+      case AppSettings::Key::SoundImportant: reload(1); break;
+      case AppSettings::Key::SoundUrgent: reload(2); break;
+      default: break;
+    }
+  });
+}
+
+void ReminderSounds::shutdown() {
+  SoundState& s = state();
+  AppSettings::unsubscribe(s.subscription);
+  s.subscription = 0;
+
+  std::thread output;
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.stop = true;
+    s.mixer.stopAll();
+    output = std::move(s.output);
+  }
+  if (output.joinable()) output.join();
+}
+
+bool ReminderSounds::play(int importance) {
+  SoundState& s = state();
+  std::unique_lock<std::mutex> lock(s.mutex);
+  const Level& level = s.levels[std::clamp(importance, 0, kLevels - 1)];
+  if (level.value.empty()) return false;
+
+  if (!level.clip) {
+    const std::wstring value = level.value;
+    lock.unlock();
+    DWORD flags = SND_ASYNC | SND_NODEFAULT;
+    flags |= isFileValue(value) ? SND_FILENAME : SND_ALIAS;
+    return PlaySoundW(value.c_str(), nullptr, flags) != FALSE;
+  }
+
+  if (s.stop) return false;
+  s.mixer.play(level.clip);
+  return startOutputLocked(s);
+}
+
+bool ReminderSounds::isFileValue(const std::wstring& value) {
+  if (value.empty()) return false;
+  if (value.find(L"\\") != std::wstring::npos || value.find(L"/") != std::wstring::npos) return true;
+  if (value.size() >= 4) {
+    const std::wstring ext = value.substr(value.size() - 4);
+    if (ext == L".wav" || ext == L".WAV") return true;
+  }
+  return false;
+}
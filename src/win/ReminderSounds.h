@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+// Reminder sounds of the three importance levels (AppSettings::sound*). WAV files,
+// and system aliases resolved to the WAV of the current sound scheme, are decoded
+// into memory when settings load or change, so firing a reminder never touches
+// the disk; overlapping reminders are mixed (AudioMixer) and played through one
+// waveOut stream that is open only while something plays. A value that can't be
+// decoded (compressed WAV, alias without a file) is played with PlaySoundW as before.
+class ReminderSounds {
+public:
+  // Loads the three levels and follows setting changes (call once at startup).
+  static void init();
+  // Stops playback and the output thread.
+  static void shutdown();
+
+  // Plays the sound of the importance level (0..2) asynchronously. False if the
+  // level is off or the sound could not be played.
+  static bool play(int importance);
+
+  // Whether a settings value names a file rather than a system alias.
+  static bool isFileValue(const std::wstring& value);
+};
@@ -1,5 +1,7 @@
 #include "WinUtil.h"
 
+#include "core/Utf8.h"
+
 #include <objbase.h>
 #include <shlwapi.h>
 
@@ -83,30 +85,14 @@ std::wstring WinUtil::lastErrorMessage(DWORD error) {
 }
 
 std::string WinUtil::toUtf8(const std::wstring& ws) {
-  if (ws.empty()) {
-    return {};
-  }
-  const int needed = WideCharToMultiByte(CP_UTF8, 0, ws.c_str(), static_cast<int>(ws.size()), nullptr, 0, nullptr, nullptr);
-  if (needed <= 0) {
-    return {};
-  }
   std::string out;
-  out.resize(needed);
-  WideCharToMultiByte(CP_UTF8, 0, ws.c_str(), static_cast<int>(ws.size()), out.data(), needed, nullptr, nullptr);
+  Utf8::toUtf8(ws, out);
   return out;
 }
 
 std::wstring WinUtil::fromUtf8(const std::string& s) {
-  if (s.empty()) {
-    return {};
-  }
-  const int needed = MultiByteToWideChar(CP_UTF8, 0, s.data(), static_cast<int>(s.size()), nullptr, 0);
-  if (needed <= 0) {
-    return {};
-  }
   std::wstring out;
-  out.resize(needed);
-  MultiByteToWideChar(CP_UTF8, 0, s.data(), static_cast<int>(s.size()), out.data(), needed);
+  Utf8::toWide(s, out);
   return out;
 }
 
@@ -0,0 +1,304 @@
+// Unit tests of the portable reminder audio code: Wav::decode and AudioMixer.
+//
+//   AudioTests
+//
+// Prints every failed check and exits non-zero if there was one (run by ctest).
+
+#include "core/AudioMixer.h"
+#include "core/Wav.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+int g_failures = 0;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      ++g_failures; \
+    } \
+  } while (0)
+
+constexpr uint16_t kPcm = 1;
+constexpr uint16_t kFloat = 3;
+constexpr uint16_t kExtensible = 0xFFFE;
+
+void putU16(std::string& s, uint32_t v) {
+  s.push_back(static_cast<char>(v & 0xFF));
+  s.push_back(static_cast<char>((v >> 8) & 0xFF));
+}
+
+void putU32(std::string& s, uint32_t v) {
+  putU16(s, v & 0xFFFF);
+  putU16(s, v >> 16);
+}
+
+void putChunk(std::string& s, const char* id, const std::string& body, uint32_t claimedSize) {
+  s.append(id, 4);
+  putU32(s, claimedSize);
+  s += body;
+  if (body.size() & 1) s.push_back('\0');
+}
+
+std::string fmtChunk(uint16_t tag, uint16_t channels, uint32_t rate, uint16_t bits) {
+  const uint16_t blockAlign = static_cast<uint16_t>(channels * bits / 8);
+  std::string f;
+  putU16(f, tag);
+  putU16(f, channels);
+  putU32(f, rate);
+  putU32(f, rate * blockAlign);
+  putU16(f, blockAlign);
+  putU16(f, bits);
+  if (tag == kExtensible) {
+    putU16(f, 22);   // cbSize
+    putU16(f, bits); // valid bits
+    putU32(f, 3);    // channel mask
+    putU16(f, kPcm); // SubFormat GUID: KSDATAFORMAT_SUBTYPE_PCM
+    f += std::string("\x00\x00\x00\x00\x10\x00\x80\x00\x00\xAA\x00\x38\x9B\x71", 14);
+  }
+  return f;
+}
+
+struct WavSpec {
+  uint16_t tag = kPcm;
+  uint16_t channels = 2;
+  uint32_t rate = Wav::kSampleRate;
+  uint16_t bits = 16;
+  std::string data;
+  std::string before;   // chunks between the RIFF header and "fmt "
+  int64_t dataClaim = -1; // data chunk size field; -1: the real size
+};
+
+std::string makeWav(const WavSpec& w) {
+  std::string body = "WAVE";
+  body += w.before;
+  putChunk(body, "fmt ", fmtChunk(w.tag, w.channels, w.rate, w.bits),
+           static_cast<uint32_t>(fmtChunk(w.tag, w.channels, w.rate, w.bits).size()));
+  body.append("data", 4);
+  putU32(body, static_cast<uint32_t>(w.dataClaim < 0 ? static_cast<int64_t>(w.data.size()) : w.dataClaim));
+  body += w.data;
+  std::string file = "RIFF";
+  putU32(file, static_cast<uint32_t>(body.size()));
+  return file + body;
+}
+
+std::string pcm16(std::initializer_list<int> samples) {
+  std::string s;
+  for (const int v : samples) putU16(s, static_cast<uint16_t>(static_cast<int16_t>(v)));
+  return s;
+}
+
+std::vector<int16_t> decoded(const WavSpec& w) {
+  Wav::Clip clip;
+  std::wstring error;
+  const bool ok = Wav::decode(makeWav(w), clip, &error);
+  CHECK(ok);
+  CHECK(error.empty());
+  return clip.samples;
+}
+
+std::shared_ptr<const Wav::Clip> constantClip(int16_t value, size_t frames) {
+  auto clip = std::make_shared<Wav::Clip>();
+  clip->samples.assign(frames * Wav::kChannels, value);
+  return clip;
+}
+
+// ---- Wav ----
+
+void testChunkWalk() {
+  // An odd-sized chunk before "fmt " is padded to an even size.
+  WavSpec w;
+  std::string list;
+  putChunk(list, "LIST", "abc", 3);
+  w.before = list;
+  w.data = pcm16({ 100, -100, 200, -200 });
+  CHECK((decoded(w) == std::vector<int16_t>{ 100, -100, 200, -200 }));
+
+  // A data chunk claiming more bytes than the file has: the frames present are kept.
+  WavSpec t;
+  t.data = pcm16({ 1, 2, 3, 4, 5 }); // 2.5 frames
+  t.dataClaim = 4000;
+  CHECK((decoded(t) == std::vector<int16_t>{ 1, 2, 3, 4 }));
+
+  Wav::Clip clip;
+  std::wstring error;
+  CHECK(!Wav::decode(std::string_view("RIFF\0\0\0\0AVI ", 12), clip, &error));
+  CHECK(!error.empty());
+
+  WavSpec adpcm;
+  adpcm.tag = 2;
+  adpcm.bits = 4;
+  adpcm.data = std::string(64, '\0');
+  error.clear();
+  CHECK(!Wav::decode(makeWav(adpcm), clip, &error));
+  CHECK(!error.empty());
+
+  // No data chunk at all.
+  std::string noData = "RIFF";
+  std::string body = "WAVE";
+  putChunk(body, "fmt ", fmtChunk(kPcm, 2, Wav::kSampleRate, 16), 16);
+  putU32(noData, static_cast<uint32_t>(body.size()));
+  CHECK(!Wav::decode(noData + body, clip, nullptr));
+}
+
+void testSampleFormats() {
+  WavSpec u8;
+  u8.channels = 1;
+  u8.bits = 8;
+  u8.data = std::string("\x80\xFF\x00\xC0", 4);
+  // Mono is played on both channels.
+  CHECK((decoded(u8) == std::vector<int16_t>{ 0, 0, 32512, 32512, -32768, -32768, 16384, 16384 }));
+
+  WavSpec s24;
+  s24.channels = 1;
+  s24.bits = 24;
+  s24.data = std::string("\xFF\xFF\x7F" "\x00\x00\x80" "\x00\x01\x00" "\x00\x00\x40", 12);
+  CHECK((decoded(s24) == std::vector<int16_t>{ 32767, 32767, -32768, -32768, 1, 1, 16384, 16384 }));
+
+  WavSpec f32;
+  f32.tag = kFloat;
+  f32.bits = 32;
+  for (const float v : { 0.5f, -1.0f, 1.5f, -0.25f }) {
+    char b[4];
+    std::memcpy(b, &v, 4);
+    f32.data.append(b, 4);
+  }
+  CHECK((decoded(f32) == std::vector<int16_t>{ 16384, -32768, 32767, -8192 }));
+
+  WavSpec f64;
+  f64.tag = kFloat;
+  f64.channels = 1;
+  f64.bits = 64;
+  const double half = -0.5;
+  f64.data.append(reinterpret_cast<const char*>(&half), 8);
+  CHECK((decoded(f64) == std::vector<int16_t>{ -16384, -16384 }));
+
+  // WAVE_FORMAT_EXTENSIBLE with a PCM SubFormat.
+  WavSpec ext;
+  ext.tag = kExtensible;
+  ext.data = pcm16({ 7, -7 });
+  CHECK((decoded(ext) == std::vector<int16_t>{ 7, -7 }));
+
+  // Channels past the first two are dropped.
+  WavSpec quad;
+  quad.channels = 4;
+  quad.data = pcm16({ 1, 2, 3, 4, 5, 6, 7, 8 });
+  CHECK((decoded(quad) == std::vector<int16_t>{ 1, 2, 5, 6 }));
+}
+
+void testPcm16RoundTrip() {
+  WavSpec w;
+  std::vector<int16_t> expected;
+  for (int v = -32768; v <= 32767; ++v) {
+    putU16(w.data, static_cast<uint16_t>(static_cast<int16_t>(v)));
+    expected.push_back(static_cast<int16_t>(v));
+  }
+  CHECK(decoded(w) == expected);
+}
+
+void testResampling() {
+  WavSpec w;
+  w.rate = 44100;
+  w.data = std::string(44100 * 4, '\0');
+  CHECK(decoded(w).size() == 48000u * Wav::kChannels);
+
+  w.data = std::string(441 * 4, '\0');
+  CHECK(decoded(w).size() == 480u * Wav::kChannels);
+
+  // A constant signal stays constant through interpolation.
+  w.data.clear();
+  for (int i = 0; i < 441; ++i) w.data += pcm16({ 1000, -1000 });
+  const auto out = decoded(w);
+  bool constant = true;
+  for (size_t i = 0; i < out.size(); i += 2) constant = constant && out[i] == 1000 && out[i + 1] == -1000;
+  CHECK(constant);
+}
+
+// ---- AudioMixer ----
+
+void testMixerSaturation() {
+  AudioMixer mixer;
+  mixer.play(constantClip(30000, 4));
+  mixer.play(constantClip(30000, 4));
+  int16_t out[2 * Wav::kChannels];
+  mixer.render(out, 2);
+  for (const int16_t v : out) CHECK(v == 32767);
+
+  mixer.stopAll();
+  mixer.play(constantClip(-30000, 4));
+  mixer.play(constantClip(-30000, 4));
+  mixer.play(constantClip(100, 4));
+  mixer.render(out, 2);
+  for (const int16_t v : out) CHECK(v == -32768 + 100);
+
+  // Long enough for the vector path and its scalar tail.
+  AudioMixer wide;
+  wide.play(constantClip(20000, 37));
+  wide.play(constantClip(20000, 37));
+  std::vector<int16_t> buf(37 * Wav::kChannels);
+  wide.render(buf.data(), 37);
+  bool saturated = true;
+  for (const int16_t v : buf) saturated = saturated && v == 32767;
+  CHECK(saturated);
+}
+
+void testMixerEviction() {
+  AudioMixer mixer;
+  // Voice i plays 2^i, so the mix tells which voices are left.
+  for (size_t i = 0; i <= AudioMixer::kMaxVoices; ++i) {
+    mixer.play(constantClip(static_cast<int16_t>(1 << i), 4));
+  }
+  int16_t out[Wav::kChannels];
+  mixer.render(out, 1);
+  const int all = (1 << (AudioMixer::kMaxVoices + 1)) - 1;
+  CHECK(out[0] == all - 1); // the oldest voice was cut off
+  CHECK(out[1] == all - 1);
+}
+
+void testMixerFinishedVoices() {
+  AudioMixer mixer;
+  CHECK(!mixer.active());
+  mixer.play(nullptr);
+  mixer.play(std::make_shared<Wav::Clip>());
+  CHECK(!mixer.active());
+
+  mixer.play(constantClip(10, 3));
+  mixer.play(constantClip(1, 1));
+  int16_t out[2 * Wav::kChannels];
+  mixer.render(out, 2);
+  CHECK(out[0] == 11 && out[1] == 11 && out[2] == 10 && out[3] == 10);
+  CHECK(mixer.active()); // the longer clip has a frame left
+
+  mixer.render(out, 2);
+  CHECK(out[0] == 10 && out[1] == 10 && out[2] == 0 && out[3] == 0); // silence past the end
+  CHECK(!mixer.active());
+
+  // A clip can be played again once finished, and by several voices at once.
+  auto clip = constantClip(5, 1);
+  mixer.play(clip);
+  mixer.play(clip);
+  mixer.render(out, 1);
+  CHECK(out[0] == 10);
+  CHECK(!mixer.active());
+}
+} // namespace
+
+int main() {
+  testChunkWalk();
+  testSampleFormats();
+  testPcm16RoundTrip();
+  testResampling();
+  testMixerSaturation();
+  testMixerEviction();
+  testMixerFinishedVoices();
+  if (g_failures == 0) std::printf("all checks passed\n");
+  return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+// Unit tests of NotificationQueue: which due reminders get a window of their own
+// and which go to the digest.
+//
+//   NotificationQueueTests
+//
+// Prints every failed check and exits non-zero if there was one (run by ctest).
+
+#include "model/NotificationQueue.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+int g_failures = 0;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      ++g_failures; \
+    } \
+  } while (0)
+
+NoteSummary due(const wchar_t* id, int importance, int64_t scheduledAtUtcMs) {
+  NoteSummary n;
+  n.id = id;
+  n.importance = importance;
+  n.scheduledAtUtcMs = scheduledAtUtcMs;
+  return n;
+}
+
+std::vector<std::wstring> ids(const std::vector<NoteSummary>& notes) {
+  std::vector<std::wstring> out;
+  for (const auto& n : notes) out.push_back(n.id);
+  return out;
+}
+
+void testBacklogInOnePass() {
+  NotificationQueue q;
+  std::vector<NoteSummary> backlog;
+  for (int i = 0; i < 10000; ++i) {
+    backlog.push_back(due((L"n" + std::to_wstring(i)).c_str(), i == 7777 ? 2 : 0, i));
+  }
+  const auto d = q.push(std::move(backlog));
+  // Two windows plus one digest window for the rest: nothing is dropped.
+  CHECK(d.popups.size() == 2);
+  CHECK(d.digest.size() == 9998);
+  CHECK(d.openDigest);
+  CHECK(d.soundImportance == 2);
+  CHECK(d.popups[0].id == L"n7777");
+  CHECK(d.popups[1].id == L"n0");
+  CHECK(q.popupsOnScreen() == 2);
+  CHECK(q.digestOnScreen());
+
+  // Everything later joins the open digest instead of opening another one.
+  const auto more = q.push({ due(L"late", 0, 1) });
+  CHECK(more.popups.empty());
+  CHECK(ids(more.digest) == std::vector<std::wstring>{ L"late" });
+  CHECK(!more.openDigest);
+}
+
+void testWindowCap() {
+  NotificationQueue q;
+  auto d = q.push({ due(L"a", 0, 1), due(L"b", 0, 2), due(L"c", 0, 3) });
+  CHECK(d.popups.size() == 3); // exactly the cap: no digest needed
+  CHECK(d.digest.empty());
+  CHECK(!d.openDigest);
+  CHECK(q.popupsOnScreen() == 3);
+
+  // Screen full: the digest opens anyway, as the only extra window.
+  d = q.push({ due(L"d", 2, 4) });
+  CHECK(d.popups.empty());
+  CHECK(ids(d.digest) == std::vector<std::wstring>{ L"d" });
+  CHECK(d.openDigest);
+
+  // One slot left with a burst of two: the slot goes to the digest.
+  NotificationQueue one;
+  one.push({ due(L"a", 0, 1), due(L"b", 0, 2) });
+  d = one.push({ due(L"c", 0, 3), due(L"d", 0, 4) });
+  CHECK(d.popups.empty());
+  CHECK(d.digest.size() == 2);
+  CHECK(d.openDigest);
+  CHECK(one.popupsOnScreen() == 2);
+
+  // A cap of one window leaves room for the digest only.
+  NotificationQueue single(1);
+  d = single.push({ due(L"a", 0, 1), due(L"b", 0, 2) });
+  CHECK(d.popups.empty());
+  CHECK(d.digest.size() == 2);
+  CHECK(d.openDigest);
+}
+
+void testOrdering() {
+  NotificationQueue q(10);
+  const auto d = q.push({ due(L"b", 0, 5), due(L"a", 0, 5), due(L"late", 1, 9), due(L"early", 1, 1),
+                          due(L"urgent", 2, 100), due(L"c", 0, 3) });
+  // Importance first, then the scheduled time, then the id.
+  CHECK((ids(d.popups) == std::vector<std::wstring>{ L"urgent", L"early", L"late", L"c", L"a", L"b" }));
+  CHECK(d.soundImportance == 2);
+
+  // The digest keeps the same order.
+  NotificationQueue full(1);
+  const auto digest = full.push({ due(L"x", 0, 2), due(L"y", 1, 3), due(L"z", 0, 1) });
+  CHECK((ids(digest.digest) == std::vector<std::wstring>{ L"y", L"z", L"x" }));
+  CHECK(digest.soundImportance == 1);
+
+  CHECK(q.push({}).soundImportance == -1);
+}
+
+void testRequeueAndDismiss() {
+  NotificationQueue q;
+  q.push({ due(L"a", 0, 1), due(L"b", 0, 2), due(L"c", 0, 3), due(L"d", 0, 4), due(L"e", 0, 5) });
+  CHECK(q.popupsOnScreen() == 2);
+  CHECK(q.digestOnScreen());
+
+  // Dismissing a window frees its slot for the next reminder.
+  q.popupClosed();
+  auto d = q.push({ due(L"a", 0, 1) }); // a snoozed reminder due again
+  CHECK(ids(d.popups) == std::vector<std::wstring>{ L"a" });
+  CHECK(d.digest.empty());
+  CHECK(q.popupsOnScreen() == 2);
+
+  // Once the digest is dismissed, the next overflow opens a new one.
+  q.digestClosed();
+  CHECK(!q.digestOnScreen());
+  d = q.push({ due(L"f", 0, 6), due(L"g", 0, 7) });
+  CHECK(d.popups.empty()); // the only free slot goes to the digest
+  CHECK(d.digest.size() == 2);
+  CHECK(d.openDigest);
+
+  // Snoozing everything back from the digest: each reminder comes back once due.
+  q.digestClosed();
+  q.popupClosed();
+  q.popupClosed();
+  CHECK(q.popupsOnScreen() == 0);
+  d = q.push({ due(L"f", 0, 6), due(L"g", 0, 7) });
+  CHECK((ids(d.popups) == std::vector<std::wstring>{ L"f", L"g" }));
+  CHECK(!d.openDigest);
+
+  // Extra close notifications never drive the count negative.
+  q.popupClosed();
+  q.popupClosed();
+  q.popupClosed();
+  CHECK(q.popupsOnScreen() == 0);
+}
+} // namespace
+
+int main() {
+  testBacklogInOnePass();
+  testWindowCap();
+  testOrdering();
+  testRequeueAndDismiss();
+  if (g_failures == 0) std::printf("all checks passed\n");
+  return g_failures == 0 ? 0 : 1;
+}